@@ -2,6 +2,8 @@ QT       += core gui
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
+QT += network concurrent
+
 CONFIG += c++11
 
 equals(QT_MAJOR_VERSION, 5): lessThan(QT_MINOR_VERSION, 14): QMAKE_CXXFLAGS += -Wno-deprecated-copy
@@ -11,25 +13,76 @@ equals(QT_MAJOR_VERSION, 5): lessThan(QT_MINOR_VERSION, 14): QMAKE_CXXFLAGS += -
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    backgroundtask.cpp \
+    capturediff.cpp \
     datainputwindow.cpp \
     descobj.cpp \
+    diffwindow.cpp \
+    dwordtokenizer.cpp \
+    fieldexpr.cpp \
+    fieldformatter.cpp \
+    filefollower.cpp \
+    grouprowindex.cpp \
+    ingestserver.cpp \
+    ipxactimporter.cpp \
+    layoutdecoder.cpp \
     main.cpp \
     mainwindow.cpp \
+    registermap.cpp \
+    registertrace.cpp \
+    registertracewindow.cpp \
+    resultexporter.cpp \
+    resultmodel.cpp \
+    resultstore.cpp \
+    sessionfile.cpp \
+    signaturesearch.cpp \
+    signaturesearchwindow.cpp \
     structviewwindow.cpp \
     tableview.cpp \
+    templateeditmodel.cpp \
     templateeditwindow.cpp \
+    templatelibrary.cpp \
     templatemanagewindow.cpp \
-    texteditor.cpp
+    texteditor.cpp \
+    timeindex.cpp \
+    uniquegroups.cpp \
+    uniquegroupswindow.cpp
 
 HEADERS += \
+    backgroundtask.h \
+    capturediff.h \
     datainputwindow.h \
     descobj.h \
+    diffwindow.h \
+    dwordtokenizer.h \
+    fieldexpr.h \
+    fieldformatter.h \
+    filefollower.h \
+    grouprowindex.h \
+    ingestserver.h \
+    ipxactimporter.h \
+    layoutdecoder.h \
     mainwindow.h \
+    registermap.h \
+    registertrace.h \
+    registertracewindow.h \
+    resultexporter.h \
+    resultmodel.h \
+    resultstore.h \
+    sessionfile.h \
+    signaturesearch.h \
+    signaturesearchwindow.h \
+    spscring.h \
     structviewwindow.h \
     tableview.h \
+    templateeditmodel.h \
     templateeditwindow.h \
+    templatelibrary.h \
     templatemanagewindow.h \
-    texteditor.h
+    texteditor.h \
+    timeindex.h \
+    uniquegroups.h \
+    uniquegroupswindow.h
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
@@ -0,0 +1,50 @@
+#include <QEventLoop>
+#include <QFutureWatcher>
+#include <QProgressDialog>
+#include <QTimer>
+#include <QtConcurrent>
+#include "backgroundtask.h"
+
+bool BackgroundTask::run(QWidget *parent, const QString &label, const std::function<void()> &work,
+                         const std::function<int()> &progress, const std::function<void()> &cancel,
+                         int minimumDuration)
+{
+    QFutureWatcher<void> watcher;
+    watcher.setFuture(QtConcurrent::run(work));
+
+    // QProgressDialog 构造后会自行计时弹出，先等待 minimumDuration 再创建，期间完成的任务不显示进度框
+    if (minimumDuration > 0) {
+        QEventLoop loop;
+        QTimer::singleShot(minimumDuration, &loop, &QEventLoop::quit);
+        QObject::connect(&watcher, &QFutureWatcher<void>::finished, &loop, &QEventLoop::quit);
+        if (!watcher.isFinished())
+            loop.exec(QEventLoop::ExcludeUserInputEvents);
+    }
+    if (watcher.isFinished())
+        return true;
+
+    QProgressDialog dialog(label, cancel ? QObject::tr("Cancel") : QString(), 0, progress ? 1000 : 0, parent);
+    dialog.setWindowModality(Qt::WindowModal);
+    dialog.setMinimumDuration(0);
+    dialog.setAutoReset(false);
+
+    bool cancelled = false;
+    QTimer progressTimer;
+    if (progress)
+        QObject::connect(&progressTimer, &QTimer::timeout, &dialog, [&]() { dialog.setValue(qBound(0, progress(), 1000)); });
+    QObject::connect(&dialog, &QProgressDialog::canceled, &dialog, [&]() {
+        if (!cancel)
+            return;
+        cancelled = true;
+        cancel();
+    });
+    QObject::connect(&watcher, &QFutureWatcher<void>::finished, &dialog, &QProgressDialog::reset);
+    if (progress)
+        progressTimer.start(100);
+    // 等待期间 finished 信号已处理过，再检查一次避免 exec() 不返回
+    if (!watcher.isFinished())
+        dialog.exec();
+    // 取消时进度框先关闭，等待后台线程结束
+    watcher.waitForFinished();
+    return !cancelled;
+}
@@ -0,0 +1,23 @@
+#ifndef BACKGROUNDTASK_H
+#define BACKGROUNDTASK_H
+
+#include <functional>
+#include <QString>
+
+class QWidget;
+
+// 在线程池中执行耗时操作，期间显示模态进度框，阻止界面修改操作用到的数据
+// progress 返回 [0, 1000] 的进度，为空时进度框显示忙碌状态；
+// cancel 在用户取消时调用，为空时进度框没有取消按钮。
+// 取消后进度框先关闭，仍会等待 work 返回，work 应尽快检查取消标志。
+// minimumDuration 毫秒内完成的操作不显示进度框，等待期间不处理用户输入。
+class BackgroundTask
+{
+public:
+    // 用户取消时返回 false
+    static bool run(QWidget *parent, const QString &label, const std::function<void()> &work,
+                    const std::function<int()> &progress = nullptr, const std::function<void()> &cancel = nullptr,
+                    int minimumDuration = 500);
+};
+
+#endif // BACKGROUNDTASK_H
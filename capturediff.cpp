@@ -0,0 +1,359 @@
+#include <algorithm>
+#include <QHash>
+#include <QtConcurrent>
+#include "capturediff.h"
+
+// 每个并行任务处理的组数
+static const int kTaskGroups = 64 * 1024;
+// 锚点之间的区间不超过该单元数时使用 LCS 动态规划对齐
+static const qint64 kLcsCells = 1024 * 1024;
+
+static quint64 hashGroup(const uint32_t *dwords, int count)
+{
+    quint64 h = 0x9e3779b97f4a7c15ULL ^ static_cast<quint64>(count);
+    for (int i = 0; i < count; i++) {
+        h ^= dwords[i];
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 32;
+    }
+    return h;
+}
+
+QVector<quint64> CaptureDiff::hashGroups(const ResultStore &store)
+{
+    return hashGroups(store, store.firstGroup(), store.endGroup());
+}
+
+QVector<quint64> CaptureDiff::hashGroups(const ResultStore &store, qint64 begin, qint64 end)
+{
+    struct Task { qint64 begin; qint64 end; };
+
+    qint64 first = qMax(begin, store.firstGroup());
+    qint64 count = qMax<qint64>(0, qMin(end, store.endGroup()) - first);
+    if (count > kMaxGroups) {
+        qWarning("%s[%d]: Too many groups: %lld", __func__, __LINE__, count);
+        return QVector<quint64>();
+    }
+    QVector<quint64> hashes(static_cast<int>(count));
+    quint64 *out = hashes.data();
+
+    QVector<Task> tasks;
+    for (qint64 g = 0; g < count; g += kTaskGroups)
+        tasks.push_back({g, qMin(g + kTaskGroups, count)});
+
+    QtConcurrent::blockingMap(tasks, [&store, first, out](const Task &task) {
+        QVector<uint32_t> dwords(store.dwordsPerGroup());
+        for (qint64 g = task.begin; g < task.end; g++) {
+            store.readGroup(first + g, dwords.data());
+            out[g] = hashGroup(dwords.constData(), dwords.size());
+        }
+    });
+    return hashes;
+}
+
+bool CaptureDiff::sameGroup(const ResultStore &a, qint64 groupA, const ResultStore &b, qint64 groupB,
+                            uint32_t *bufA, uint32_t *bufB)
+{
+    if ((a.dwordsPerGroup() != b.dwordsPerGroup()) || !a.readGroup(groupA, bufA) || !b.readGroup(groupB, bufB))
+        return false;
+    return std::equal(bufA, bufA + a.dwordsPerGroup(), bufB);
+}
+
+namespace {
+
+// 在哈希序列上对齐，结果按顺序写入 CaptureDiffResult
+class Aligner
+{
+public:
+    Aligner(const ResultStore &a, const ResultStore &b, const QVector<quint64> &ha, const QVector<quint64> &hb,
+            qint64 firstA, qint64 firstB, CaptureDiffResult &result)
+        : a(a), b(b), ha(ha), hb(hb), firstA(firstA), firstB(firstB), result(result)
+        , bufA(a.dwordsPerGroup()), bufB(b.dwordsPerGroup()) {}
+
+    void run();
+
+private:
+    // equal > 0 表示输出 equal 个相同组的指令，否则表示待对齐的区间
+    struct Range { int a0; int a1; int b0; int b1; int equal; };
+
+    void emitEqual(int count);
+    void deleteA(int i) { gapA.push_back(i); }
+    void insertB(int j) { gapB.push_back(j); }
+    void flushGap();
+    bool splitByAnchors(const Range &r, QVector<Range> &stack);
+    void alignLeaf(const Range &r);
+    // 哈希相同时再比较原始 DWORD，避免哈希冲突的组被当作相同
+    bool same(int i, int j)
+    {
+        return (ha.at(i) == hb.at(j)) && CaptureDiff::sameGroup(a, firstA + i, b, firstB + j, bufA.data(), bufB.data());
+    }
+
+    const ResultStore &a;
+    const ResultStore &b;
+    const QVector<quint64> &ha;
+    const QVector<quint64> &hb;
+    qint64 firstA;
+    qint64 firstB;
+    CaptureDiffResult &result;
+    QVector<int> gapA;
+    QVector<int> gapB;
+    QVector<uint32_t> bufA;
+    QVector<uint32_t> bufB;
+};
+
+void Aligner::emitEqual(int count)
+{
+    flushGap();
+    result.equalGroups += count;
+}
+
+void Aligner::flushGap()
+{
+    // 两次相同组之间缺失的组按顺序两两配对为修改，多出的只存在于一侧
+    int paired = qMin(gapA.size(), gapB.size());
+    for (int k = 0; k < paired; k++)
+        result.pairs.push_back({firstA + gapA.at(k), firstB + gapB.at(k)});
+    for (int k = paired; k < gapA.size(); k++)
+        result.pairs.push_back({firstA + gapA.at(k), -1});
+    for (int k = paired; k < gapB.size(); k++)
+        result.pairs.push_back({-1, firstB + gapB.at(k)});
+    result.changedGroups += paired;
+    result.onlyInA += gapA.size() - paired;
+    result.onlyInB += gapB.size() - paired;
+    gapA.clear();
+    gapB.clear();
+}
+
+void Aligner::run()
+{
+    QVector<Range> stack;
+    stack.push_back({0, ha.size(), 0, hb.size(), 0});
+
+    while (!stack.isEmpty()) {
+        Range r = stack.takeLast();
+        if (r.equal > 0) {
+            emitEqual(r.equal);
+            continue;
+        }
+
+        // 去掉相同的开头
+        int prefix = 0;
+        while ((r.a0 < r.a1) && (r.b0 < r.b1) && same(r.a0, r.b0)) {
+            r.a0++;
+            r.b0++;
+            prefix++;
+        }
+        if (prefix > 0)
+            emitEqual(prefix);
+
+        // 相同的结尾放到中间部分之后输出
+        int suffix = 0;
+        while ((r.a0 < r.a1) && (r.b0 < r.b1) && same(r.a1 - 1, r.b1 - 1)) {
+            r.a1--;
+            r.b1--;
+            suffix++;
+        }
+        if (suffix > 0)
+            stack.push_back({0, 0, 0, 0, suffix});
+
+        if ((r.a0 == r.a1) || (r.b0 == r.b1)) {
+            for (int i = r.a0; i < r.a1; i++)
+                deleteA(i);
+            for (int j = r.b0; j < r.b1; j++)
+                insertB(j);
+            continue;
+        }
+
+        if (!splitByAnchors(r, stack))
+            alignLeaf(r);
+    }
+    flushGap();
+}
+
+bool Aligner::splitByAnchors(const Range &r, QVector<Range> &stack)
+{
+    // 统计区间内的哈希，值为位置，重复出现记为 -1
+    QHash<quint64, int> inA;
+    QHash<quint64, int> inB;
+    inA.reserve(r.a1 - r.a0);
+    inB.reserve(r.b1 - r.b0);
+    for (int i = r.a0; i < r.a1; i++) {
+        auto it = inA.find(ha.at(i));
+        if (it == inA.end())
+            inA.insert(ha.at(i), i);
+        else
+            it.value() = -1;
+    }
+    for (int j = r.b0; j < r.b1; j++) {
+        auto it = inB.find(hb.at(j));
+        if (it == inB.end())
+            inB.insert(hb.at(j), j);
+        else
+            it.value() = -1;
+    }
+
+    // 两侧都只出现一次且内容相同的组，按 A 中位置排列
+    QVector<int> candA;
+    QVector<int> candB;
+    for (int i = r.a0; i < r.a1; i++) {
+        if (inA.value(ha.at(i)) != i)
+            continue;
+        int j = inB.value(ha.at(i), -1);
+        if ((j >= 0) && same(i, j)) {
+            candA.push_back(i);
+            candB.push_back(j);
+        }
+    }
+    if (candA.isEmpty())
+        return false;
+
+    // B 中位置的最长递增子序列即为锚点
+    QVector<int> tails;
+    QVector<int> prev(candA.size(), -1);
+    for (int k = 0; k < candA.size(); k++) {
+        auto it = std::lower_bound(tails.begin(), tails.end(), candB.at(k), [&candB](int idx, int value) {
+            return candB.at(idx) < value;
+        });
+        int pos = static_cast<int>(it - tails.begin());
+        if (pos > 0)
+            prev[k] = tails.at(pos - 1);
+        if (it == tails.end())
+            tails.push_back(k);
+        else
+            *it = k;
+    }
+    QVector<int> anchors;
+    for (int k = tails.last(); k >= 0; k = prev.at(k))
+        anchors.push_front(k);
+
+    // 逆序入栈，出栈时按顺序处理：区间、锚点、区间、锚点 ... 区间
+    int nextA = r.a1;
+    int nextB = r.b1;
+    for (int n = anchors.size() - 1; n >= 0; n--) {
+        int ai = candA.at(anchors.at(n));
+        int bj = candB.at(anchors.at(n));
+        stack.push_back({ai + 1, nextA, bj + 1, nextB, 0});
+        stack.push_back({0, 0, 0, 0, 1});
+        nextA = ai;
+        nextB = bj;
+    }
+    stack.push_back({r.a0, nextA, r.b0, nextB, 0});
+    return true;
+}
+
+void Aligner::alignLeaf(const Range &r)
+{
+    int n = r.a1 - r.a0;
+    int m = r.b1 - r.b0;
+
+    if (static_cast<qint64>(n + 1) * (m + 1) > kLcsCells) {
+        // 区间太大，按位置配对
+        for (int i = r.a0; i < r.a1; i++)
+            deleteA(i);
+        for (int j = r.b0; j < r.b1; j++)
+            insertB(j);
+        return;
+    }
+
+    // lcs[i][j] 为 A[i..] 与 B[j..] 的最长公共子序列长度，eq 记录两组是否相同，回溯时不再读取
+    int width = m + 1;
+    QVector<int> lcs((n + 1) * width, 0);
+    QVector<bool> eq(n * width, false);
+    for (int i = n - 1; i >= 0; i--) {
+        for (int j = m - 1; j >= 0; j--) {
+            eq[i * width + j] = same(r.a0 + i, r.b0 + j);
+            if (eq.at(i * width + j))
+                lcs[i * width + j] = lcs.at((i + 1) * width + j + 1) + 1;
+            else
+                lcs[i * width + j] = qMax(lcs.at((i + 1) * width + j), lcs.at(i * width + j + 1));
+        }
+    }
+
+    int i = 0;
+    int j = 0;
+    while ((i < n) && (j < m)) {
+        if (eq.at(i * width + j)) {
+            emitEqual(1);
+            i++;
+            j++;
+        } else if (lcs.at((i + 1) * width + j) >= lcs.at(i * width + j + 1)) {
+            deleteA(r.a0 + i++);
+        } else {
+            insertB(r.b0 + j++);
+        }
+    }
+    while (i < n)
+        deleteA(r.a0 + i++);
+    while (j < m)
+        insertB(r.b0 + j++);
+}
+
+} // namespace
+
+void CaptureDiff::compareFields(const ResultStore &a, const ResultStore &b, const DescLayout &layout,
+                                CaptureDiffResult &result)
+{
+    struct Task { int begin; int end; QVector<DiffRow> rows; };
+
+    QVector<Task> tasks;
+    for (int p = 0; p < result.pairs.size(); p += kTaskGroups)
+        tasks.push_back({p, qMin(p + kTaskGroups, result.pairs.size()), QVector<DiffRow>()});
+
+    const QVector<DiffPair> &pairs = result.pairs;
+    QtConcurrent::blockingMap(tasks, [&a, &b, &layout, &pairs](Task &task) {
+        QVector<uint32_t> dwA(a.dwordsPerGroup());
+        QVector<uint32_t> dwB(b.dwordsPerGroup());
+        for (int p = task.begin; p < task.end; p++) {
+            const DiffPair &pair = pairs.at(p);
+            if ((pair.groupA < 0) || (pair.groupB < 0)) {
+                task.rows.push_back({p, -1});
+                continue;
+            }
+            a.readGroup(pair.groupA, dwA.data());
+            b.readGroup(pair.groupB, dwB.data());
+            // 派生字段由位字段计算，只比较位字段
+            for (int f = 0; f < layout.rawFieldCount(); f++) {
+                const DescFieldSpec &spec = layout.fields.at(f);
+                if (DescObj::extractSubfield(dwA.at(spec.dwIdx) ^ dwB.at(spec.dwIdx), spec.lsb, spec.msb))
+                    task.rows.push_back({p, f});
+            }
+        }
+    });
+
+    for (const Task &task : tasks) {
+        int room = kMaxRows - result.rows.size();
+        if (task.rows.size() > room) {
+            qWarning("%s[%d]: Too many different rows, truncated at %d", __func__, __LINE__, kMaxRows);
+            result.rows += task.rows.mid(0, room);
+            result.rowsTruncated = true;
+            break;
+        }
+        result.rows += task.rows;
+    }
+}
+
+CaptureDiffResult CaptureDiff::compare(const ResultStore &a, const ResultStore &b, const DescLayout &layout)
+{
+    return compare(a, a.firstGroup(), a.endGroup(), b, b.firstGroup(), b.endGroup(), layout);
+}
+
+CaptureDiffResult CaptureDiff::compare(const ResultStore &a, qint64 beginA, qint64 endA,
+                                       const ResultStore &b, qint64 beginB, qint64 endB, const DescLayout &layout)
+{
+    CaptureDiffResult result;
+    qint64 countA = qMin(endA, a.endGroup()) - qMax(beginA, a.firstGroup());
+    qint64 countB = qMin(endB, b.endGroup()) - qMax(beginB, b.firstGroup());
+    if ((countA > kMaxGroups) || (countB > kMaxGroups)) {
+        result.tooLarge = true;
+        return result;
+    }
+
+    QVector<quint64> ha = hashGroups(a, beginA, endA);
+    QVector<quint64> hb = hashGroups(b, beginB, endB);
+
+    Aligner aligner(a, b, ha, hb, qMax(beginA, a.firstGroup()), qMax(beginB, b.firstGroup()), result);
+    aligner.run();
+
+    compareFields(a, b, layout, result);
+    return result;
+}
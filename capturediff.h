@@ -0,0 +1,69 @@
+#ifndef CAPTUREDIFF_H
+#define CAPTUREDIFF_H
+
+#include <climits>
+#include <QVector>
+#include "descobj.h"
+#include "resultstore.h"
+
+// 对齐后的一对组，某一侧缺失时组号为 -1
+struct DiffPair
+{
+    qint64 groupA;
+    qint64 groupB;
+};
+
+// 差异报告中的一行：field 为 -1 表示整组只存在于一侧
+struct DiffRow
+{
+    int pair;
+    int field;
+};
+
+struct CaptureDiffResult
+{
+    // 只保存不相同的对齐项，按出现顺序排列
+    QVector<DiffPair> pairs;
+    QVector<DiffRow> rows;
+    qint64 equalGroups = 0;
+    qint64 changedGroups = 0;
+    qint64 onlyInA = 0;
+    qint64 onlyInB = 0;
+    // 某一侧的组数超过 CaptureDiff::kMaxGroups，没有比较
+    bool tooLarge = false;
+    // 差异行超过 QVector 的容量，只保留了前面的部分
+    bool rowsTruncated = false;
+};
+
+// 两份抓取数据的整体比较
+// 每组原始 DWORD 先计算哈希（多线程），再在哈希序列上对齐：
+// 去掉相同的首尾后，以两侧都只出现一次的哈希为锚点求最长递增子序列（patience diff），
+// 锚点之间较小的区间用 LCS 动态规划对齐，较大的区间按位置配对。
+// 哈希相同的组再比较原始 DWORD，确认相同后才视为相同组。
+// 对齐后缺失一侧的连续组与另一侧配对为"修改"，再逐字段比较（多线程）。
+class CaptureDiff
+{
+public:
+    // 每侧最多比较的组数：对齐结果最多有两侧组数之和个 DiffPair，需在 QVector 的 2 GB 限制内，对齐时用 int 下标
+    static const qint64 kMaxGroups = (INT_MAX - 64) / (2 * sizeof(DiffPair));
+    // 差异行的上限
+    static const int kMaxRows = (INT_MAX - 64) / sizeof(DiffRow);
+
+    // 组数超过 kMaxGroups 时返回空
+    static QVector<quint64> hashGroups(const ResultStore &store);
+    // 只计算绝对组号 [begin, end) 的哈希
+    static QVector<quint64> hashGroups(const ResultStore &store, qint64 begin, qint64 end);
+    // 两组原始 DWORD 是否完全相同，bufA 和 bufB 分别至少能容纳各自的 dwordsPerGroup() 个元素
+    static bool sameGroup(const ResultStore &a, qint64 groupA, const ResultStore &b, qint64 groupB,
+                          uint32_t *bufA, uint32_t *bufB);
+    static CaptureDiffResult compare(const ResultStore &a, const ResultStore &b, const DescLayout &layout);
+    // 只比较 a 中 [beginA, endA) 与 b 中 [beginB, endB) 的组，任一侧超过 kMaxGroups 时只设置 tooLarge
+    static CaptureDiffResult compare(const ResultStore &a, qint64 beginA, qint64 endA,
+                                     const ResultStore &b, qint64 beginB, qint64 endB, const DescLayout &layout);
+
+private:
+    static void compareFields(const ResultStore &a, const ResultStore &b, const DescLayout &layout,
+                              CaptureDiffResult &result);
+};
+
+#endif // CAPTUREDIFF_H
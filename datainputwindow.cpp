@@ -1,16 +1,46 @@
 #include <QDebug>
 #include <QMessageBox>
+#include <QFileDialog>
+#include <QFileInfo>
 #include <QStandardItemModel>
+#include "dwordtokenizer.h"
 #include "datainputwindow.h"
 
+// 超过该行数时先显示抽样预览，再分批完成全部解析
+static const int kPreviewLines = 200000;
+// 预览最多抽取的组数
+static const int kPreviewGroups = 4096;
+// 每批解析的行数
+static const int kParseBatchLines = 65536;
+// 分词器格式每批解析的字节数
+static const int kParseBatchBytes = 4 * 1024 * 1024;
+// 自动识别格式时取样的字符数
+static const int kDetectChars = 64 * 1024;
+
+static qint64 lineTimestamp(const QString &line)
+{
+    QByteArray bytes = line.toLatin1();
+    qint64 t;
+    return DwordTokenizer::parseTimestamp(bytes.constData(), bytes.constData() + bytes.size(), &t)
+            ? t : TimeIndex::kNoTime;
+}
+
 DataInputWin::DataInputWin(QWidget *parent)
     : QDockWidget(parent)
     , ui(new Ui::DataInputWin)
     , curDesc()
+    , pendingOffset(0)
+    , pendingTokenized(false)
+    , pendingTimestamps(false)
     , isParsering(false)
     , multiGroup(false)
 {
     ui->setupUi(this);
+    parseTimer.setInterval(0);
+    connect(&parseTimer, &QTimer::timeout, this, &DataInputWin::parseTimer_timeout_handler);
+    connect(ui->openButton, &QPushButton::clicked, this, &DataInputWin::openButton_clicked_handler);
+    connect(ui->followButton, &QPushButton::toggled, this, &DataInputWin::followButton_toggled_handler);
+    connect(ui->listenButton, &QPushButton::toggled, this, &DataInputWin::listenButton_toggled_handler);
     connect(ui->submitButton, &QPushButton::clicked, this, &DataInputWin::submitButton_clicked_handler);
     connect(ui->clearButton, &QPushButton::clicked, this, [this]() {
         qDebug() << "{DataInputWin} clear text";
@@ -50,10 +80,79 @@ void DataInputWin::submitButton_clicked_handler()
 
     isParsering = true;
 
-    bool ok;
-    QStringList lines = ui->inputWidget->stripLines(&ok);
-    if (!ok || lines.isEmpty()) {
-        qWarning("%s[%d]: Invalid input", __func__, __LINE__);
+    QString inputText = ui->inputWidget->toPlainText();
+
+    // 其它 dump 格式不按行对应 DWORD，交给分词器解析
+    DwordTokenizer::Format format = inputFormat();
+    if (format == DwordTokenizer::Auto) {
+        QByteArray sample = inputText.left(kDetectChars).toLatin1();
+        format = DwordTokenizer::detect(sample.constData(), sample.size());
+    }
+    if (format != DwordTokenizer::LastDword) {
+        submitTokenized(inputText, format);
+        return;
+    }
+
+    int lineCnt = inputText.count('\n') + 1;
+    if (!multiGroup || (lineCnt < kPreviewLines)) {
+        // 数据量小，直接全部解析
+        bool ok;
+        QStringList lines = ui->inputWidget->stripLines(&ok);
+        if (!ok || lines.isEmpty()) {
+            qWarning("%s[%d]: Invalid input", __func__, __LINE__);
+            isParsering = false;
+            return;
+        }
+
+        // 清空显示
+        emit requestToClear();
+
+        int minDescSize = curDesc.size();
+        int linesSize = lines.size();
+        if (linesSize < minDescSize) {
+            QMessageBox::warning(this, tr("Error"), tr("Not enough lines applied to the selected template"));
+            isParsering = false;
+            return;
+        }
+
+        // 单组模式只取第一组
+        int dwordCnt = multiGroup ? linesSize : minDescSize;
+        QVector<uint32_t> dwords;
+        dwords.reserve(dwordCnt);
+        for (int i = 0; i < dwordCnt; i++) {
+            dwords.push_back(lines.at(i).toUInt(nullptr, 16));
+        }
+
+        // stripLines 与原始的非空行一一对应，时间戳从原始行中提取，每组只记录第一个
+        TimeMarks marks;
+        if (timestampsEnabled()) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+            QStringList rawLines = inputText.split('\n', Qt::SkipEmptyParts);
+#else
+            QStringList rawLines = inputText.split('\n', QString::SkipEmptyParts);
+#endif
+            for (int i = 0; i < dwordCnt; i++)
+                TimeIndex::addMark(marks, i, lineTimestamp(rawLines.at(i)), minDescSize);
+        }
+
+        // 交给主窗口按需解析显示
+        emit dwordsSubmitted(curDesc.compile(), dwords, marks);
+
+        // emit submitClicked(lines);
+
+        isParsering = false;
+        return;
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    pendingLines = inputText.split('\n', Qt::SkipEmptyParts);
+#else
+    pendingLines = inputText.split('\n', QString::SkipEmptyParts);
+#endif
+    pendingLayout = curDesc.compile();
+    if (pendingLines.size() < pendingLayout.dwCount) {
+        QMessageBox::warning(this, tr("Error"), tr("Not enough lines applied to the selected template"));
+        pendingLines.clear();
         isParsering = false;
         return;
     }
@@ -61,55 +160,312 @@ void DataInputWin::submitButton_clicked_handler()
     // 清空显示
     emit requestToClear();
 
-    int minDescSize = curDesc.size();
-    int linesSize = lines.size();
-    if (linesSize < minDescSize) {
-        QMessageBox::warning(this, tr("Error"), tr("Not enough lines applied to the selected template"));
+    if (!submitPreview()) {
+        pendingLines.clear();
         isParsering = false;
         return;
     }
 
-    DescFieldList fields;
-
-    auto it = lines.constBegin();
-    while (it != lines.constEnd()) {
-        fields.clear();
-        int curDescSize = curDesc.size();
-        int dwIdx = 0;
-        // 将来单个描述符行数可能根据数据内容变化
-        // 即解析到某一行, curDescSize 可能调整
-        while ((dwIdx < curDescSize) && (it != lines.constEnd())) {
-            const DescDWordObj &dwordObj = curDesc.at(dwIdx);
-            uint32_t dwordValue = it->toUInt(nullptr, 16);
-            for (int j = 0; j < dwordObj.size(); j++) {
-                DescFieldItem field = {};
-                const DescFieldObj &fieldObj = dwordObj.at(j);
-
-                int lsb = fieldObj["LSB"].toInt();
-                int msb = fieldObj["MSB"].toInt();
-                QString fieldName(fieldObj["field"].toString());
-                uint32_t fieldValue = DescObj::extractSubfield(dwordValue, lsb, msb);
-                field.name = fieldName;
-                field.lsb = lsb;
-                field.msb = msb;
-                field.dwIdx = dwIdx;
-                field.value = fieldValue;
-
-                // qDebug() << fieldName << ":" << fieldValue;
-                fields.push_back(std::move(field));
-            }
-            dwIdx++;
-            it++;
+    // 剩余工作交给定时器分批完成，界面保持响应
+    pendingDwords.clear();
+    pendingDwords.reserve(pendingLines.size());
+    pendingMarks.clear();
+    pendingTimestamps = timestampsEnabled();
+    parseTimer.start();
+}
+
+void DataInputWin::submitTokenized(const QString &text, DwordTokenizer::Format format)
+{
+    int lineCnt = text.count('\n') + 1;
+    if (multiGroup && (lineCnt >= kPreviewLines)) {
+        pendingBytes = text.toLatin1();
+        pendingOffset = 0;
+        pendingTokenizer.setFormat(format);
+        pendingTokenizer.setTimeGroups(curDesc.size());
+        pendingLayout = curDesc.compile();
+        if (!submitTokenizedPreview()) {
+            QMessageBox::warning(this, tr("Error"), tr("Not enough data applied to the selected template"));
+            pendingBytes.clear();
+            isParsering = false;
+            return;
         }
 
-        // 发送一组数据给主窗口显示
-        emit appendOneGroup(std::move(fields));
+        // 剩余工作交给定时器分批完成，界面保持响应
+        pendingDwords.clear();
+        pendingMarks.clear();
+        pendingTimestamps = timestampsEnabled();
+        pendingTokenized = true;
+        parseTimer.start();
+        return;
+    }
+
+    // 数据量小，直接全部解析
+    isParsering = false;
+    QByteArray bytes = text.toLatin1();
+    DwordTokenizer tokenizer;
+    tokenizer.setFormat(format);
+    tokenizer.setTimeGroups(curDesc.size());
+    QVector<uint32_t> dwords;
+    TimeMarks marks;
+    tokenizer.feed(bytes.constData(), bytes.size(), dwords, true, timestampsEnabled() ? &marks : nullptr);
+    if (tokenizer.skippedLines() > 0)
+        qWarning("%s[%d]: %lld lines skipped", __func__, __LINE__, tokenizer.skippedLines());
+
+    int minDescSize = curDesc.size();
+    if (dwords.size() < minDescSize) {
+        QMessageBox::warning(this, tr("Error"), tr("Not enough data applied to the selected template"));
+        return;
+    }
+
+    // 单组模式只取第一组
+    if (!multiGroup) {
+        dwords.resize(minDescSize);
+        marks.resize(qMin(marks.size(), 1));
+    }
+
+    emit requestToClear();
+    emit dwordsSubmitted(curDesc.compile(), dwords, marks);
+}
 
-        if (!multiGroup)
+double DataInputWin::tokenizeGroup(int pos, QVector<uint32_t> &out) const
+{
+    // 从行首开始，每次解析的范围加倍，直到得到一组
+    int dwPerGroup = pendingLayout.dwCount;
+    if (pos > 0) {
+        pos = pendingBytes.indexOf('\n', pos - 1);
+        if (pos < 0)
+            return 0;
+        pos++;
+    }
+    DwordTokenizer tokenizer;
+    tokenizer.setFormat(pendingTokenizer.format());
+    QVector<uint32_t> dwords;
+    int window = 4096;
+    int consumed = 0;
+    while (true) {
+        int size = qMin(window, pendingBytes.size() - pos);
+        bool last = (size == pendingBytes.size() - pos);
+        dwords.clear();
+        tokenizer.reset();
+        consumed = tokenizer.feed(pendingBytes.constData() + pos, size, dwords, last);
+        if ((dwords.size() >= dwPerGroup) || last)
             break;
+        window *= 2;
+    }
+    if ((dwords.size() < dwPerGroup) || (dwPerGroup <= 0))
+        return 0;
+    out += dwords.mid(0, dwPerGroup);
+    return double(consumed) / dwords.size();
+}
+
+bool DataInputWin::submitTokenizedPreview()
+{
+    // 各行的 DWORD 个数相近，按第一组估算每组的字节数，在整个输入中等距抽取
+    int dwPerGroup = pendingLayout.dwCount;
+    QVector<uint32_t> dwords;
+    double bytesPerDword = tokenizeGroup(0, dwords);
+    if (bytesPerDword <= 0)
+        return false;
+    qint64 totalGroups = qMax<qint64>(1, static_cast<qint64>(pendingBytes.size() / bytesPerDword / dwPerGroup));
+    int stride = static_cast<int>(qMax<qint64>(1, totalGroups / kPreviewGroups));
+    for (qint64 group = stride; group < totalGroups; group += stride) {
+        qint64 pos = static_cast<qint64>(group * dwPerGroup * bytesPerDword);
+        if ((pos >= pendingBytes.size()) || (tokenizeGroup(static_cast<int>(pos), dwords) <= 0))
+            break;
+    }
+
+    emit requestToClear();
+    emit previewSubmitted(pendingLayout, dwords, stride);
+    return true;
+}
+
+void DataInputWin::parseTokenizedBatch()
+{
+    int size = pendingBytes.size();
+    int end = qMin(pendingOffset + kParseBatchBytes, size);
+    bool last = (end >= size);
+    int consumed = pendingTokenizer.feed(pendingBytes.constData() + pendingOffset, end - pendingOffset, pendingDwords,
+                                         last, pendingTimestamps ? &pendingMarks : nullptr);
+    // 单行超过一批时把剩余部分一次解析完
+    if ((consumed == 0) && !last) {
+        end = size;
+        last = true;
+        consumed = pendingTokenizer.feed(pendingBytes.constData() + pendingOffset, end - pendingOffset, pendingDwords,
+                                         true, pendingTimestamps ? &pendingMarks : nullptr);
+    }
+    pendingOffset += consumed;
+    emit parseProgress(last ? size : pendingOffset, size);
+    if (!last)
+        return;
+
+    if (pendingTokenizer.skippedLines() > 0)
+        qWarning("%s[%d]: %lld lines skipped", __func__, __LINE__, pendingTokenizer.skippedLines());
+    finishParsing();
+}
+
+bool DataInputWin::submitPreview()
+{
+    int dwPerGroup = pendingLayout.dwCount;
+    int totalGroups = pendingLines.size() / dwPerGroup;
+    int stride = qMax(1, totalGroups / kPreviewGroups);
+
+    // 每隔 stride 组抽取一组
+    QVector<uint32_t> dwords;
+    dwords.reserve((totalGroups / stride + 1) * dwPerGroup);
+    for (int group = 0; group < totalGroups; group += stride) {
+        int base = group * dwPerGroup;
+        for (int i = 0; i < dwPerGroup; i++) {
+            uint32_t dword;
+            const QString &line = pendingLines.at(base + i);
+            if (!ui->inputWidget->parseDword(line, &dword)) {
+                QString message = QString(tr("No valid hexadecimal DWORD found in line: %1")).arg(line.trimmed());
+                QMessageBox::warning(this, tr("Error"), message);
+                return false;
+            }
+            dwords.push_back(dword);
+        }
+    }
+
+    emit previewSubmitted(pendingLayout, dwords, stride);
+    return true;
+}
+
+void DataInputWin::parseTimer_timeout_handler()
+{
+    if (pendingTokenized) {
+        parseTokenizedBatch();
+        return;
+    }
+
+    int start = pendingDwords.size();
+    int end = qMin(start + kParseBatchLines, pendingLines.size());
+
+    for (int i = start; i < end; i++) {
+        uint32_t dword;
+        const QString &line = pendingLines.at(i);
+        if (!ui->inputWidget->parseDword(line, &dword)) {
+            parseTimer.stop();
+            QString message = QString(tr("No valid hexadecimal DWORD found in line: %1")).arg(line.trimmed());
+            QMessageBox::warning(this, tr("Error"), message);
+            pendingLines.clear();
+            pendingDwords.clear();
+            pendingMarks.clear();
+            isParsering = false;
+            return;
+        }
+        if (pendingTimestamps)
+            TimeIndex::addMark(pendingMarks, pendingDwords.size(), lineTimestamp(line), pendingLayout.dwCount);
+        pendingDwords.push_back(dword);
     }
 
-    // emit submitClicked(lines);
+    emit parseProgress(end, pendingLines.size());
+
+    if (end >= pendingLines.size())
+        finishParsing();
+}
+
+void DataInputWin::finishParsing()
+{
+    parseTimer.stop();
+    pendingLines.clear();
+    pendingBytes.clear();
+    pendingOffset = 0;
+    pendingTokenized = false;
+
+    QVector<uint32_t> dwords;
+    TimeMarks marks;
+    dwords.swap(pendingDwords);
+    marks.swap(pendingMarks);
+    emit dwordsSubmitted(pendingLayout, dwords, marks);
 
     isParsering = false;
 }
+
+void DataInputWin::openButton_clicked_handler()
+{
+    if (isParsering) {
+        QMessageBox::warning(this, tr("Error"), tr("Parsing process in progress!"));
+        return;
+    }
+
+    // 二进制 dump 文件，按小端序 DWORD 直接映射，不经过文本框
+    QString path = QFileDialog::getOpenFileName(this, tr("Open Binary Dump"), QString(),
+                                                tr("Binary dump (*.bin *.dump *.raw);;Session (*.sps);;All files (*)"));
+    if (path.isEmpty())
+        return;
+
+    // 会话文件自带模板
+    if (QFileInfo(path).suffix().toLower() == "sps") {
+        emit sessionOpenRequested(path);
+        return;
+    }
+
+    if (curDesc.empty()) {
+        QMessageBox::warning(this, tr("Error"), tr("No valid template selected"));
+        return;
+    }
+
+    emit requestToClear();
+    emit dumpFileOpened(curDesc.compile(), path);
+}
+
+void DataInputWin::followButton_toggled_handler(bool checked)
+{
+    if (!checked) {
+        emit followStopped();
+        return;
+    }
+
+    if (curDesc.empty() || isParsering) {
+        QMessageBox::warning(this, tr("Error"), curDesc.empty() ? tr("No valid template selected")
+                                                                : tr("Parsing process in progress!"));
+        setFollowing(false);
+        return;
+    }
+
+    QString path = QFileDialog::getOpenFileName(this, tr("Follow Capture File"), QString(),
+                                                tr("Log files (*.log *.txt);;All files (*)"));
+    if (path.isEmpty()) {
+        setFollowing(false);
+        return;
+    }
+
+    // 跟踪模式总是连续多组解析
+    ui->multiCheckBox->setChecked(true);
+    emit requestToClear();
+    emit followFileRequested(curDesc.compile(), path);
+}
+
+void DataInputWin::setFollowing(bool following)
+{
+    // 只同步按钮状态，不再触发信号
+    QSignalBlocker blocker(ui->followButton);
+    ui->followButton->setChecked(following);
+    ui->submitButton->setEnabled(!following);
+    ui->openButton->setEnabled(!following);
+    ui->listenButton->setEnabled(!following);
+}
+
+void DataInputWin::listenButton_toggled_handler(bool checked)
+{
+    if (checked) {
+        // 接收数据流总是连续多组解析
+        ui->multiCheckBox->setChecked(true);
+    }
+    emit listenToggled(checked);
+}
+
+void DataInputWin::setMultiGroup(bool multi)
+{
+    // 经由复选框发出 multiGroupChecked 信号，保持状态一致
+    ui->multiCheckBox->setChecked(multi);
+}
+
+void DataInputWin::setListening(bool listening)
+{
+    QSignalBlocker blocker(ui->listenButton);
+    ui->listenButton->setChecked(listening);
+    ui->submitButton->setEnabled(!listening);
+    ui->openButton->setEnabled(!listening);
+    ui->followButton->setEnabled(!listening);
+}
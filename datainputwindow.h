@@ -5,9 +5,12 @@
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QCheckBox>
+#include <QComboBox>
 #include <QMenu>
+#include <QTimer>
 #include "descobj.h"
 #include "texteditor.h"
+#include "dwordtokenizer.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -18,9 +21,14 @@ public:
     QVBoxLayout *contentLayout;
     DataInputEdit *inputWidget;
     QHBoxLayout *btnLaylout;
+    QPushButton *openButton;
+    QPushButton *followButton;
+    QPushButton *listenButton;
     QPushButton *submitButton;
     QPushButton *clearButton;
+    QComboBox *formatCombo;
     QCheckBox *multiCheckBox;
+    QCheckBox *timeCheckBox;
     QMenu *contextMenu;
 
     void setupUi(QDockWidget *dockWin)
@@ -49,10 +57,42 @@ public:
 
         btnLaylout->addStretch();
 
+        formatCombo = new QComboBox(dockWin);
+        formatCombo->setFixedSize(90, 23);
+        formatCombo->setToolTip(QObject::tr("Input line format"));
+        formatCombo->addItem(QObject::tr("Auto"), DwordTokenizer::Auto);
+        formatCombo->addItem(QObject::tr("0x DWORD"), DwordTokenizer::LastDword);
+        formatCombo->addItem(QObject::tr("DWORDs"), DwordTokenizer::Dwords);
+        formatCombo->addItem(QObject::tr("QWORDs"), DwordTokenizer::Qwords);
+        formatCombo->addItem(QObject::tr("hexdump -C"), DwordTokenizer::HexdumpC);
+        formatCombo->addItem(QObject::tr("xxd"), DwordTokenizer::Xxd);
+        btnLaylout->addWidget(formatCombo);
+
         multiCheckBox = new QCheckBox(QObject::tr("Multi"), dockWin);
         multiCheckBox->setFixedSize(70,23);
         btnLaylout->addWidget(multiCheckBox);
 
+        timeCheckBox = new QCheckBox(QObject::tr("Time"), dockWin);
+        timeCheckBox->setFixedSize(70,23);
+        timeCheckBox->setToolTip(QObject::tr("Index groups by the \"[ seconds.micros]\" timestamp at the start of each line"));
+        btnLaylout->addWidget(timeCheckBox);
+
+        openButton = new QPushButton(QObject::tr("Open..."), dockWin);
+        openButton->setFixedSize(70, 23);
+        btnLaylout->addWidget(openButton);
+
+        followButton = new QPushButton(QObject::tr("Follow..."), dockWin);
+        followButton->setFixedSize(70, 23);
+        followButton->setCheckable(true);
+        followButton->setToolTip(QObject::tr("Follow a growing capture file"));
+        btnLaylout->addWidget(followButton);
+
+        listenButton = new QPushButton(QObject::tr("Listen"), dockWin);
+        listenButton->setFixedSize(70, 23);
+        listenButton->setCheckable(true);
+        listenButton->setToolTip(QObject::tr("Receive descriptor streams from capture tools"));
+        btnLaylout->addWidget(listenButton);
+
         submitButton = new QPushButton(QObject::tr("Submit"), dockWin);
         submitButton->setFixedSize(70, 23);
         btnLaylout->addWidget(submitButton);
@@ -82,17 +122,60 @@ signals:
     void submitClicked(QStringList &lines);
     void multiGroupChecked(bool checked);
     void requestToClear();
-    void appendOneGroup(DescFieldList fields);
+    // times 为空或与 dwords 等长，是每个 DWORD 所在行的时间戳
+    void dwordsSubmitted(const DescLayout &layout, const QVector<uint32_t> &dwords, const TimeMarks &marks);
+    void previewSubmitted(const DescLayout &layout, const QVector<uint32_t> &dwords, int stride);
+    // 分词器格式按字节计算进度
+    void parseProgress(int parsedLines, int totalLines);
+    void dumpFileOpened(const DescLayout &layout, const QString &path);
+    void sessionOpenRequested(const QString &path);
+    void followFileRequested(const DescLayout &layout, const QString &path);
+    void followStopped();
+    void listenToggled(bool listening);
 
 public slots:
     void tempMgmt_tempSelected_handler(const DescObj &desc);
+    void setFollowing(bool following);
+    void setListening(bool listening);
+    void setMultiGroup(bool multi);
+    const DescObj &currentDesc() const { return curDesc; }
+    bool timestampsEnabled() const { return ui->timeCheckBox->isChecked(); }
+    DwordTokenizer::Format inputFormat() const
+    {
+        return static_cast<DwordTokenizer::Format>(ui->formatCombo->currentData().toInt());
+    }
 
 private slots:
     void submitButton_clicked_handler();
+    void openButton_clicked_handler();
+    void followButton_toggled_handler(bool checked);
+    void listenButton_toggled_handler(bool checked);
+    void parseTimer_timeout_handler();
 
 private:
+    bool submitPreview();
+    // 非默认格式的文本由分词器解析，与默认格式一样大量输入时先显示抽样预览再分批解析
+    void submitTokenized(const QString &text, DwordTokenizer::Format format);
+    bool submitTokenizedPreview();
+    // 从 pos 之后的第一个完整行开始解析出一组，追加到 out，返回平均每个 DWORD 的字节数，失败时返回 0
+    double tokenizeGroup(int pos, QVector<uint32_t> &out) const;
+    void parseTokenizedBatch();
+    void finishParsing();
+
     Ui::DataInputWin *ui;
     DescObj curDesc;
+    // 大量输入时分批解析，先显示抽样预览
+    QTimer parseTimer;
+    QStringList pendingLines;
+    // 分词器格式的待解析文本和已解析的字节数
+    QByteArray pendingBytes;
+    int pendingOffset;
+    DwordTokenizer pendingTokenizer;
+    bool pendingTokenized;
+    QVector<uint32_t> pendingDwords;
+    TimeMarks pendingMarks;
+    bool pendingTimestamps;
+    DescLayout pendingLayout;
     bool isParsering;
     bool multiGroup;
 };
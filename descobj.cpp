@@ -1,4 +1,8 @@
+#include <QHash>
+#include <QObject>
 #include "descobj.h"
+#include "fieldexpr.h"
+#include "fieldformatter.h"
 
 bool DescFieldObj::checkFormat() const
 {
@@ -46,9 +50,34 @@ QJsonArray DescDWordObj::toJsonArray() const
     return arr;
 }
 
+QJsonObject DescInclude::toJsonObject() const
+{
+    QJsonObject obj;
+    obj["include"] = path;
+    if (count != 1)
+        obj["count"] = count;
+    if (!name.isEmpty())
+        obj["name"] = name;
+    return obj;
+}
+
 DescObj::DescObj(const QJsonArray &arr)
 {
     for (int i = 0; i < arr.size(); i++) {
+        if (arr[i].isObject() && arr[i].toObject().contains("derived")) {
+            mDerived = arr[i].toObject()["derived"].toArray();
+            continue;
+        }
+        if (arr[i].isObject() && arr[i].toObject().contains("include")) {
+            QJsonObject obj = arr[i].toObject();
+            DescInclude include;
+            include.dwIdx = size();
+            include.path = obj["include"].toString();
+            include.count = obj["count"].toInt(1);
+            include.name = obj["name"].toString();
+            mIncludes.push_back(include);
+            continue;
+        }
         if (!arr[i].isArray()) {
             qWarning("%s[%d]: %d: Not a valid DW object", __func__, __LINE__, i);
             break;
@@ -59,33 +88,175 @@ DescObj::DescObj(const QJsonArray &arr)
 
 DescObj::DescObj(const DescObj &other)
     : QList<DescDWordObj>(other)
+    , mDerived(other.mDerived)
+    , mIncludes(other.mIncludes)
 {
     qDebug() << __func__ << "Desc copied";
 }
 
 bool DescObj::checkFormat() const
 {
-    if (empty())
-        return true;
     for (auto it = begin(); it != end(); ++it) {
         if (!it->checkFormat())
             return false;
     }
+
+    DescLayout layout = compile();
+    for (const DescFieldSpec &spec : layout.fields) {
+        QString error;
+        FieldFormatter formatter;
+        if (!formatter.compile(spec.format, spec.msb - spec.lsb + 1, &error)) {
+            qWarning("%s[%d]: field %s: %s", __func__, __LINE__, qPrintable(spec.name), qPrintable(error));
+            return false;
+        }
+    }
+
+    // 派生字段的表达式只能引用位字段和排在前面的派生字段
+    for (int i = layout.rawFieldCount(); i < layout.fieldCount(); i++) {
+        const DescFieldSpec &spec = layout.fields.at(i);
+        QString error;
+        FieldExpr expr;
+        if (spec.name.isEmpty() || !expr.compile(spec.expr, layout.fieldNames().mid(0, i), &error)) {
+            qWarning("%s[%d]: derived field %s: %s", __func__, __LINE__, qPrintable(spec.name), qPrintable(error));
+            return false;
+        }
+    }
     return true;
 }
 
-bool DescObj::checkValid() const
+// 掩码中连续的位段，如 "31:24, 7:0"
+static QString bitRanges(uint32_t mask)
 {
-    // toto
-    return true;
+    QStringList ranges;
+    for (int msb = 31; msb >= 0; msb--) {
+        if (!(mask & (1u << msb)))
+            continue;
+        int lsb = msb;
+        while ((lsb > 0) && (mask & (1u << (lsb - 1))))
+            lsb--;
+        ranges.push_back((lsb == msb) ? QString::number(msb) : QString("%1:%2").arg(msb).arg(lsb));
+        msb = lsb;
+    }
+    return ranges.join(", ");
+}
+
+QString DescIssue::toString() const
+{
+    QString text = (level == Error) ? QObject::tr("Error: ") : QObject::tr("Warning: ");
+    if (dwIdx >= 0)
+        text += QObject::tr("DW%1 ").arg(dwIdx);
+    if (!field.isEmpty())
+        text += field + ": ";
+    return text + message;
+}
+
+QString DescIssue::listText(const QVector<DescIssue> &issues, Level minLevel)
+{
+    QStringList lines;
+    for (const DescIssue &issue : issues) {
+        if (issue.level >= minLevel)
+            lines.push_back(issue.toString());
+    }
+    return lines.join('\n');
+}
+
+bool DescObj::checkValid(QVector<DescIssue> *issues) const
+{
+    bool valid = true;
+    auto report = [&](DescIssue::Level level, int dwIdx, const QString &field, const QString &message) {
+        if (level == DescIssue::Error)
+            valid = false;
+        if (issues)
+            issues->push_back({level, dwIdx, field, message});
+    };
+
+    QHash<QString, int> names;
+    auto checkName = [&](int dwIdx, int index, const QString &name) {
+        if (name.isEmpty())
+            report(DescIssue::Error, dwIdx, QString(), QObject::tr("Field %1 has no name").arg(index));
+        else if (names.contains(name))
+            report(DescIssue::Warning, dwIdx, name, QObject::tr("Duplicate field name, also in DW%1").arg(names.value(name)));
+        else
+            names.insert(name, dwIdx);
+    };
+
+    for (int i = 0; i < size(); i++) {
+        const DescDWordObj &dword = at(i);
+        // 每一位所属的字段，用于报告重叠的字段
+        int owners[32];
+        uint32_t used = 0;
+        int prevLsb = -1;
+        for (int j = 0; j < dword.size(); j++) {
+            const DescFieldObj &fieldObj = dword.at(j);
+            // 与 checkFormat 一致，忽略空的字段对象
+            if (fieldObj.isEmpty())
+                continue;
+            QString name = fieldObj["field"].toString();
+            checkName(i, j, name);
+
+            int lsb = fieldObj["LSB"].toInt(-1);
+            int msb = fieldObj["MSB"].toInt(-1);
+            if ((lsb < 0) || (lsb > 31) || (msb < 0) || (msb > 31)) {
+                report(DescIssue::Error, i, name, QObject::tr("Bits %1:%2 out of range 31:0").arg(msb).arg(lsb));
+                continue;
+            }
+            if (lsb > msb) {
+                report(DescIssue::Error, i, name, QObject::tr("LSB %1 greater than MSB %2").arg(lsb).arg(msb));
+                continue;
+            }
+
+            uint32_t mask = subfieldMask(lsb, msb);
+            uint32_t overlap = used & mask;
+            if (overlap) {
+                int bit = 0;
+                while (!(overlap & (1u << bit)))
+                    bit++;
+                QString other = dword.at(owners[bit])["field"].toString();
+                report(DescIssue::Error, i, name, QObject::tr("Bits %1 overlap with %2").arg(bitRanges(overlap), other));
+            }
+            if (lsb < prevLsb)
+                report(DescIssue::Warning, i, name, QObject::tr("Not in ascending bit order"));
+            prevLsb = lsb;
+
+            for (int bit = lsb; bit <= msb; bit++) {
+                if (!(used & (1u << bit)))
+                    owners[bit] = j;
+            }
+            used |= mask;
+        }
+        if (used != 0xffffffffu)
+            report(DescIssue::Warning, i, QString(), QObject::tr("Bits %1 not covered by any field").arg(bitRanges(~used)));
+    }
+
+    for (int i = 0; i < mDerived.size(); i++)
+        checkName(-1, i, mDerived[i].toObject()["field"].toString());
+    return valid;
+}
+
+void DescObj::clear()
+{
+    QList<DescDWordObj>::clear();
+    mDerived = QJsonArray();
+    mIncludes.clear();
 }
 
 QJsonArray DescObj::toJsonArray() const
 {
     QJsonArray arr;
+    // 引用写在它之后的第一个 DW 之前
+    int next = 0;
     for (int i = 0; i < this->size(); i++) {
+        while ((next < mIncludes.size()) && (mIncludes.at(next).dwIdx <= i))
+            arr.push_back(mIncludes.at(next++).toJsonObject());
         arr.push_back(this->at(i).toJsonArray());
     }
+    while (next < mIncludes.size())
+        arr.push_back(mIncludes.at(next++).toJsonObject());
+    if (!mDerived.isEmpty()) {
+        QJsonObject derived;
+        derived["derived"] = mDerived;
+        arr.push_back(derived);
+    }
     return arr;
 }
 
@@ -95,6 +266,66 @@ QByteArray DescObj::toBtyeArray() const
     return doc.toJson();
 }
 
+DescLayout DescObj::compile() const
+{
+    if (hasIncludes())
+        qWarning("%s[%d]: %d includes not resolved", __func__, __LINE__, mIncludes.size());
+
+    // 不检查有效性，模板在读取时已由 TemplateLibrary 检查过
+
+    DescLayout layout;
+    layout.dwCount = size();
+    for (int i = 0; i < size(); i++) {
+        const DescDWordObj &dword = at(i);
+        for (int j = 0; j < dword.size(); j++) {
+            const DescFieldObj &fieldObj = dword.at(j);
+            DescFieldSpec spec;
+            spec.name = fieldObj["field"].toString();
+            spec.lsb = fieldObj["LSB"].toInt();
+            spec.msb = fieldObj["MSB"].toInt();
+            spec.dwIdx = i;
+            spec.format = fieldObj["format"];
+            layout.fields.push_back(spec);
+        }
+    }
+    layout.rawCount = layout.fields.size();
+
+    for (int i = 0; i < mDerived.size(); i++) {
+        QJsonObject derived = mDerived[i].toObject();
+        DescFieldSpec spec;
+        spec.name = derived["field"].toString();
+        spec.dwIdx = -1;
+        spec.lsb = 0;
+        spec.msb = 63;
+        spec.expr = derived["expr"].toString();
+        spec.format = derived["format"];
+        layout.fields.push_back(spec);
+    }
+    return layout;
+}
+
+DescLayout DescObj::compileValid(QString *error) const
+{
+    QVector<DescIssue> issues;
+    if (!checkFormat() || !checkValid(&issues)) {
+        if (error) {
+            *error = QObject::tr("Not a valid template");
+            if (!issues.isEmpty())
+                *error += "\n" + DescIssue::listText(issues, DescIssue::Error);
+        }
+        return DescLayout();
+    }
+    return compile();
+}
+
+QStringList DescLayout::fieldNames() const
+{
+    QStringList names;
+    for (const DescFieldSpec &spec : fields)
+        names.push_back(spec.name);
+    return names;
+}
+
 DescObj DescObj::fromJson(const QByteArray &json, bool *ok)
 {
     QJsonParseError error;
@@ -128,3 +359,22 @@ uint32_t DescObj::extractSubfield(uint32_t number, int n, int m)
 
     return result;
 }
+
+uint32_t DescObj::subfieldMask(int n, int m)
+{
+    if ((n < 0) || (m > 31) || (n > m)) {
+        return 0;
+    }
+    uint32_t width = (m - n == 31) ? 0xffffffffu : ((1u << (m - n + 1)) - 1);
+    return width << n;
+}
+
+uint32_t DescObj::insertSubfield(uint32_t number, int n, int m, uint32_t value)
+{
+    // value 超出字段宽度的高位被丢弃
+    uint32_t mask = subfieldMask(n, m);
+    if (mask == 0) {
+        return number;
+    }
+    return (number & ~mask) | ((value << n) & mask);
+}
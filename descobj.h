@@ -6,6 +6,7 @@
 #include <QJsonArray>
 #include <QJsonValue>
 #include <QDebug>
+#include <QVector>
 
 struct DescFieldItem
 {
@@ -18,6 +19,51 @@ struct DescFieldItem
 
 typedef QList<DescFieldItem> DescFieldList;
 
+// 编译后的字段描述，解析时不再查询 JSON 对象
+// 派生字段没有对应的位，dwIdx 为 -1，值由 expr 从其它字段计算
+struct DescFieldSpec
+{
+    QString name;
+    int dwIdx;
+    int lsb;
+    int msb;
+    QString expr;
+    // 显示格式，见 FieldFormatter
+    QJsonValue format;
+
+    bool isDerived() const { return dwIdx < 0; }
+};
+
+// 编译后的模板布局：按 DW 顺序展开的字段列表，派生字段排在所有位字段之后
+class DescLayout
+{
+public:
+    QVector<DescFieldSpec> fields;
+    int dwCount = 0;
+    int rawCount = 0;
+
+    bool isEmpty() const { return fields.isEmpty() || (dwCount <= 0); }
+    int fieldCount() const { return fields.size(); }
+    int rawFieldCount() const { return rawCount; }
+    QStringList fieldNames() const;
+};
+
+// checkValid 发现的问题，Warning 不影响解析
+struct DescIssue
+{
+    enum Level { Warning, Error };
+
+    Level level;
+    // 派生字段为 -1
+    int dwIdx;
+    QString field;
+    QString message;
+
+    QString toString() const;
+    // 级别不低于 minLevel 的问题，每行一个
+    static QString listText(const QVector<DescIssue> &issues, Level minLevel = Warning);
+};
+
 class DescFieldObj : public QJsonObject
 {
 public:
@@ -38,6 +84,20 @@ public:
     QJsonArray toJsonArray() const;
 };
 
+// 引用的子模板，JSON 中为 DW 数组之间的 {"include": 路径, "count": 个数, "name": 前缀}
+// 按出现的位置展开：dwIdx 为它之前本模板自身的 DW 数，count 个子模板依次排列。
+// 字段名加上前缀：count 为 1 时为 "前缀_字段"，否则为 "前缀i_字段"；没有前缀且 count 为 1 时保持原名。
+struct DescInclude
+{
+    int dwIdx;
+    // 模板目录下的相对路径
+    QString path;
+    int count;
+    QString name;
+
+    QJsonObject toJsonObject() const;
+};
+
 class DescObj : public QList<DescDWordObj>
 {
 public:
@@ -48,16 +108,43 @@ public:
         if (this != &other) { // 检查自赋值
             // 调用基类的赋值运算符
             QList<DescDWordObj>::operator=(other);
+            mDerived = other.mDerived;
+            mIncludes = other.mIncludes;
         }
         return *this;
     }
+    // 同时清除派生字段和引用
+    void clear();
     bool checkFormat() const;
-    bool checkValid() const;
+    // 逐个 DW 用 32 位占用掩码检查位字段：位号越界、LSB 大于 MSB 和位重叠为 Error，
+    // 字段名重复、字段未按 LSB 升序排列和未被任何字段覆盖的位为 Warning；没有 Error 时返回 true。
+    // 编辑窗口 TemplateEditModel 使用相同的级别
+    bool checkValid(QVector<DescIssue> *issues = nullptr) const;
     QJsonArray toJsonArray() const;
     QByteArray toBtyeArray() const;
+    // 只转换结构，不检查有效性
+    DescLayout compile() const;
+    // 不经过 TemplateLibrary 的模板（会话、数据流、命令行工具）使用：
+    // 先检查格式和有效性，有 Error 时返回空的结构并在 error 中列出
+    DescLayout compileValid(QString *error = nullptr) const;
 
     static DescObj fromJson(const QByteArray &json, bool *ok = nullptr);
+    // 派生字段 [{"field": 名称, "expr": 表达式}, ...]，JSON 中保存为数组末尾的 {"derived": [...]}
+    const QJsonArray &derivedFields() const { return mDerived; }
+    void setDerivedFields(const QJsonArray &derived) { mDerived = derived; }
+    // 未展开的子模板引用，展开见 TemplateLibrary
+    const QVector<DescInclude> &includes() const { return mIncludes; }
+    bool hasIncludes() const { return !mIncludes.isEmpty(); }
+    void setIncludes(const QVector<DescInclude> &includes) { mIncludes = includes; }
     static uint32_t extractSubfield(uint32_t number, int n, int m);
+    // extractSubfield 的逆操作：用 value 替换 number 的第 n 到第 m 位
+    static uint32_t insertSubfield(uint32_t number, int n, int m, uint32_t value);
+    // 第 n 到第 m 位的掩码
+    static uint32_t subfieldMask(int n, int m);
+
+private:
+    QJsonArray mDerived;
+    QVector<DescInclude> mIncludes;
 };
 
 #endif // DESCOBJ_H
@@ -0,0 +1,198 @@
+#include <climits>
+#include <QBrush>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include "backgroundtask.h"
+#include "dwordtokenizer.h"
+#include "diffwindow.h"
+
+// 文本抓取文件每次读取的字节数
+static const qint64 kReadChunk = 4 * 1024 * 1024;
+
+DiffModel::DiffModel(const ResultStore *storeA, const ResultStore *storeB, QObject *parent)
+    : QAbstractTableModel(parent)
+    , storeA(storeA)
+    , storeB(storeB)
+{
+}
+
+void DiffModel::setResult(const DescLayout &layout, const CaptureDiffResult &result)
+{
+    beginResetModel();
+    mLayout = layout;
+    mResult = result;
+    endResetModel();
+}
+
+int DiffModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : mResult.rows.size();
+}
+
+int DiffModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 5;
+}
+
+QVariant DiffModel::fieldValue(const ResultStore *store, qint64 group, const DescFieldSpec &spec) const
+{
+    if (group < 0)
+        return QVariant();
+    uint32_t dw = store->dword(store->groupDwordIndex(group) + spec.dwIdx);
+    return QString::asprintf("0x%x", DescObj::extractSubfield(dw, spec.lsb, spec.msb));
+}
+
+QVariant DiffModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (index.row() >= mResult.rows.size()))
+        return QVariant();
+
+    const DiffRow &row = mResult.rows.at(index.row());
+    const DiffPair &pair = mResult.pairs.at(row.pair);
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case 0:
+            return (pair.groupA >= 0) ? QVariant(QString::asprintf("Group %lld", pair.groupA)) : QVariant();
+        case 1:
+            return (pair.groupB >= 0) ? QVariant(QString::asprintf("Group %lld", pair.groupB)) : QVariant();
+        case 2:
+            if (row.field < 0)
+                return (pair.groupA >= 0) ? tr("(only in current)") : tr("(only in file)");
+            return mLayout.fields.at(row.field).name;
+        case 3:
+            return (row.field < 0) ? QVariant() : fieldValue(storeA, pair.groupA, mLayout.fields.at(row.field));
+        case 4:
+            return (row.field < 0) ? QVariant() : fieldValue(storeB, pair.groupB, mLayout.fields.at(row.field));
+        default:
+            break;
+        }
+    } else if ((role == Qt::TextAlignmentRole) && (index.column() >= 3)) {
+        return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+    } else if ((role == Qt::BackgroundRole) && (row.field < 0)) {
+        // 只存在于一侧的组
+        return QBrush((pair.groupA >= 0) ? QColor(255, 210, 210) : QColor(210, 240, 210));
+    }
+    return QVariant();
+}
+
+QVariant DiffModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if ((orientation != Qt::Horizontal) || (role != Qt::DisplayRole))
+        return QVariant();
+    switch (section) {
+    case 0:
+        return tr("Current");
+    case 1:
+        return tr("File");
+    case 2:
+        return tr("Field");
+    case 3:
+        return tr("Current Value");
+    case 4:
+        return tr("File Value");
+    default:
+        return QVariant();
+    }
+}
+
+DiffWin::DiffWin(QWidget *parent, const ResultStore *storeA, const DescLayout &layout)
+    : QDialog(parent)
+    , ui(new Ui::DiffWin)
+    , storeA(storeA)
+    , mLayout(layout)
+    , beginA(0)
+    , endA(LLONG_MAX)
+{
+    ui->setupUi(this);
+    model = new DiffModel(storeA, &storeB, this);
+    ui->diffTable->setModel(model);
+}
+
+DiffWin::~DiffWin()
+{
+    delete ui;
+}
+
+void DiffWin::setGroupRange(qint64 begin, qint64 end)
+{
+    beginA = begin;
+    endA = end;
+}
+
+bool DiffWin::loadCapture(const QString &path, QString *error)
+{
+    storeB.clear();
+    storeB.setDwordsPerGroup(mLayout.dwCount);
+
+    // 二进制 dump 文件直接映射，其它按文本逐块分词
+    QString suffix = QFileInfo(path).suffix().toLower();
+    if ((suffix == "bin") || (suffix == "dump") || (suffix == "raw"))
+        return storeB.mapFile(path, error);
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    // 与当前数据的来源格式无关，按文件内容识别；每块分词后直接追加到数据存储，不保留整份副本
+    DwordTokenizer tokenizer;
+    tokenizer.setFormat(DwordTokenizer::Auto);
+    QVector<uint32_t> dwords;
+    QByteArray carry;
+    while (true) {
+        QByteArray chunk = file.read(kReadChunk);
+        bool atEnd = chunk.isEmpty();
+        carry += chunk;
+        int used = tokenizer.feed(carry.constData(), carry.size(), dwords, atEnd);
+        carry.remove(0, used);
+        storeB.append(dwords);
+        dwords.resize(0);
+        if (atEnd)
+            break;
+    }
+    return true;
+}
+
+bool DiffWin::compareWith(const QString &path, QString *error)
+{
+    // 读取与比较都在工作线程中完成，期间模态进度框阻止修改当前数据
+    bool loaded = false;
+    QString loadError;
+    CaptureDiffResult result;
+    BackgroundTask::run(parentWidget(), tr("Comparing with %1...").arg(QFileInfo(path).fileName()), [&]() {
+        loaded = loadCapture(path, &loadError);
+        if (!loaded)
+            return;
+        // 限定了当前数据的范围时，文件只取开头同样数量的组
+        qint64 endB = storeB.endGroup();
+        if (endA < LLONG_MAX)
+            endB = qMin(endB, storeB.firstGroup() + (endA - beginA));
+        result = CaptureDiff::compare(*storeA, beginA, endA, storeB, storeB.firstGroup(), endB, mLayout);
+    }, nullptr, nullptr, 0);
+
+    if (!loaded) {
+        if (error)
+            *error = loadError;
+        return false;
+    }
+    if (result.tooLarge) {
+        if (error)
+            *error = tr("Too many groups to compare, at most %1 on each side").arg(CaptureDiff::kMaxGroups);
+        return false;
+    }
+
+    qDebug("%s[%d]: equal %lld, changed %lld, only current %lld, only file %lld, rows %d", __func__, __LINE__,
+           result.equalGroups, result.changedGroups, result.onlyInA, result.onlyInB, result.rows.size());
+    QString summary = tr("Identical groups: %1    Changed groups: %2    Only in current: %3    Only in file: %4")
+                      .arg(result.equalGroups).arg(result.changedGroups).arg(result.onlyInA).arg(result.onlyInB);
+    if (result.rowsTruncated)
+        summary += tr("    (only the first %1 differences are listed)").arg(result.rows.size());
+    ui->summaryLabel->setText(summary);
+    model->setResult(mLayout, result);
+    ui->diffTable->resizeColumnsToContents();
+    return true;
+}
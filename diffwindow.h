@@ -0,0 +1,96 @@
+#ifndef DIFFWINDOW_H
+#define DIFFWINDOW_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <QAbstractTableModel>
+#include "capturediff.h"
+#include "tableview.h"
+
+QT_BEGIN_NAMESPACE
+
+class UiDiffWin
+{
+public:
+    QVBoxLayout *contentLayout;
+    QLabel *summaryLabel;
+    TableView *diffTable;
+
+    void setupUi(QDialog *dialog)
+    {
+        dialog->setWindowTitle(QObject::tr("Capture Diff"));
+        dialog->resize(900, 600);
+
+        contentLayout = new QVBoxLayout(dialog);
+
+        summaryLabel = new QLabel(dialog);
+        summaryLabel->setObjectName(QString::fromUtf8("summaryLabel"));
+        contentLayout->addWidget(summaryLabel);
+
+        diffTable = new TableView(dialog);
+        diffTable->setObjectName(QString::fromUtf8("diffTable"));
+        diffTable->verticalHeader()->setVisible(false);
+        // 设置内容不可编辑
+        diffTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        contentLayout->addWidget(diffTable);
+    }
+};
+
+namespace Ui {
+    class DiffWin: public UiDiffWin {};
+} // namespace Ui
+
+QT_END_NAMESPACE
+
+// 差异报告表格：每个不同的字段一行，只存在于一侧的组占一行
+// 字段值按需从两个数据存储中读取
+class DiffModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    DiffModel(const ResultStore *storeA, const ResultStore *storeB, QObject *parent = nullptr);
+
+    void setResult(const DescLayout &layout, const CaptureDiffResult &result);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    QVariant fieldValue(const ResultStore *store, qint64 group, const DescFieldSpec &spec) const;
+
+    const ResultStore *storeA;
+    const ResultStore *storeB;
+    DescLayout mLayout;
+    CaptureDiffResult mResult;
+};
+
+// 当前解析结果与另一份抓取文件的比较窗口
+class DiffWin : public QDialog
+{
+    Q_OBJECT
+public:
+    DiffWin(QWidget *parent, const ResultStore *storeA, const DescLayout &layout);
+    ~DiffWin();
+
+    // 只比较当前数据中 [begin, end) 的组与文件开头同样数量的组，默认比较全部
+    void setGroupRange(qint64 begin, qint64 end);
+    // 读取另一份抓取文件并与当前数据比较，比较期间显示进度对话框
+    bool compareWith(const QString &path, QString *error);
+
+private:
+    bool loadCapture(const QString &path, QString *error);
+
+    Ui::DiffWin *ui;
+    const ResultStore *storeA;
+    ResultStore storeB;
+    DescLayout mLayout;
+    qint64 beginA;
+    qint64 endA;
+    DiffModel *model;
+};
+
+#endif // DIFFWINDOW_H
@@ -0,0 +1,449 @@
+#include <cstring>
+#include <QDebug>
+#include "dwordtokenizer.h"
+
+// 十六进制字符查找表，非十六进制字符为 -1
+struct HexTable
+{
+    signed char digit[256];
+
+    HexTable()
+    {
+        memset(digit, -1, sizeof(digit));
+        for (int i = 0; i < 10; i++)
+            digit['0' + i] = static_cast<signed char>(i);
+        for (int i = 0; i < 6; i++) {
+            digit['a' + i] = static_cast<signed char>(10 + i);
+            digit['A' + i] = static_cast<signed char>(10 + i);
+        }
+    }
+};
+
+static const HexTable hexTable;
+
+static inline int hexDigit(char c)
+{
+    return hexTable.digit[static_cast<unsigned char>(c)];
+}
+
+// 从 p 开始连续的十六进制字符个数
+static int hexRun(const char *p, const char *end)
+{
+    const char *q = p;
+    while ((q < end) && (hexDigit(*q) >= 0))
+        q++;
+    return static_cast<int>(q - p);
+}
+
+static quint64 hexValue(const char *p, int digits)
+{
+    quint64 value = 0;
+    for (int i = 0; i < digits; i++)
+        value = (value << 4) | static_cast<quint64>(hexDigit(p[i]));
+    return value;
+}
+
+static const char *skipBlanks(const char *p, const char *end)
+{
+    while ((p < end) && ((*p == ' ') || (*p == '\t')))
+        p++;
+    return p;
+}
+
+static bool isHexPrefix(const char *p, const char *end)
+{
+    return (end - p >= 2) && (p[0] == '0') && ((p[1] == 'x') || (p[1] == 'X'));
+}
+
+// 按一行的特征判断格式
+static DwordTokenizer::Format detectLine(const char *p, const char *end)
+{
+    int run = hexRun(p, end);
+    // hexdump -C：偏移之后两个空格，然后是空格分隔的字节
+    if ((run >= 7) && (end - p >= run + 5) && (p[run] == ' ') && (p[run + 1] == ' ')
+            && (hexDigit(p[run + 2]) >= 0) && (hexDigit(p[run + 3]) >= 0) && (p[run + 4] == ' '))
+        return DwordTokenizer::HexdumpC;
+    // xxd：偏移之后是冒号，然后是 4 位一组的字节
+    if ((run >= 7) && (end - p >= run + 7) && (p[run] == ':') && (p[run + 1] == ' ')
+            && (hexRun(p + run + 2, end) == 4) && (p[run + 6] == ' '))
+        return DwordTokenizer::Xxd;
+
+    bool prefix = false;
+    if (DwordTokenizer::parseWords(p, end, 16, nullptr, &prefix) > 0)
+        return DwordTokenizer::Qwords;
+
+    // 只有一个 0x 数时与默认格式结果相同，"0x地址 0x数值" 这类行按默认格式取最后一个
+    int words = DwordTokenizer::parseWords(p, end, 8, nullptr, &prefix);
+    bool has0x = false;
+    for (const char *q = p; !has0x && (q + 1 < end); q++)
+        has0x = isHexPrefix(q, end);
+    if (((words >= 2) && (prefix || !has0x)) || ((words == 1) && !has0x))
+        return DwordTokenizer::Dwords;
+    return DwordTokenizer::LastDword;
+}
+
+DwordTokenizer::DwordTokenizer()
+    : mFormat(LastDword)
+    , mActive(LastDword)
+    , mGroupDwords(0)
+{
+    reset();
+}
+
+void DwordTokenizer::setFormat(Format format)
+{
+    mFormat = format;
+    reset();
+}
+
+void DwordTokenizer::reset()
+{
+    mActive = mFormat;
+    mParsedLines = 0;
+    mSkippedLines = 0;
+    byteAcc = 0;
+    byteCount = 0;
+    lastOffset = 0;
+    lastBytes.clear();
+    repeatPending = false;
+    mPhase = 0;
+}
+
+void DwordTokenizer::setTimeGroups(int dwPerGroup, int phase)
+{
+    mGroupDwords = qMax(0, dwPerGroup);
+    mPhase = (mGroupDwords > 0) ? (phase % mGroupDwords) : 0;
+}
+
+DwordTokenizer::Format DwordTokenizer::detect(const char *data, int size)
+{
+    // 参与识别的最多行数
+    static const int kDetectLines = 32;
+
+    int votes[Xxd + 1] = {};
+    const char *p = data;
+    const char *end = data + size;
+    int lines = 0;
+    while ((p < end) && (lines < kDetectLines)) {
+        const char *eol = static_cast<const char *>(memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (eol == nullptr)
+            eol = end;
+        const char *lineEnd = ((eol > p) && (eol[-1] == '\r')) ? eol - 1 : eol;
+        // 去掉行首的时间戳再判断
+        const char *s = p;
+        parseTimestamp(p, lineEnd, nullptr, &s);
+        s = skipBlanks(s, lineEnd);
+        // 空行和 hexdump 的重复行不参与识别
+        if ((s < lineEnd) && !((lineEnd - s == 1) && (*s == '*'))) {
+            votes[detectLine(s, lineEnd)]++;
+            lines++;
+        }
+        p = (eol < end) ? eol + 1 : end;
+    }
+
+    Format best = LastDword;
+    for (int f = Dwords; f <= Xxd; f++) {
+        if (votes[f] > votes[best])
+            best = static_cast<Format>(f);
+    }
+    return best;
+}
+
+int DwordTokenizer::parseWords(const char *begin, const char *end, int digits, QVector<uint32_t> *out, bool *colonPrefix)
+{
+    const char *p = skipBlanks(begin, end);
+
+    // 可选的 "地址:" 前缀
+    const char *q = isHexPrefix(p, end) ? p + 2 : p;
+    int run = hexRun(q, end);
+    bool prefix = (run > 0) && (q + run < end) && (q[run] == ':');
+    if (prefix)
+        p = q + run + 1;
+    if (colonPrefix)
+        *colonPrefix = prefix;
+
+    // 遇到其它内容（如 ASCII 列）为止
+    int count = 0;
+    while (true) {
+        p = skipBlanks(p, end);
+        const char *t = isHexPrefix(p, end) ? p + 2 : p;
+        int n = hexRun(t, end);
+        if ((n != digits) || ((t + n < end) && (t[n] != ' ') && (t[n] != '\t') && (t[n] != '\r')))
+            break;
+        if (out) {
+            quint64 value = hexValue(t, n);
+            out->push_back(static_cast<uint32_t>(value));
+            if (digits > 8)
+                out->push_back(static_cast<uint32_t>(value >> 32));
+        }
+        count++;
+        p = t + n;
+    }
+    return count;
+}
+
+bool DwordTokenizer::parseAddressValue(const char *begin, const char *end, quint64 *address, uint32_t *value)
+{
+    int found = 0;
+    const char *p = begin;
+    while (end - p >= 3) {
+        if (!isHexPrefix(p, end) || (hexDigit(p[2]) < 0)) {
+            p++;
+            continue;
+        }
+        int n = hexRun(p + 2, end);
+        if (found == 0) {
+            if (n > 16)
+                return false;
+            *address = hexValue(p + 2, n);
+        } else {
+            // 数值按 DWORD 解析，超出 8 位时取低 32 位
+            *value = static_cast<uint32_t>(hexValue(p + 2 + qMax(0, n - 8), qMin(n, 8)));
+        }
+        found++;
+        p += 2 + n;
+    }
+    if (found >= 2)
+        return true;
+    if (found == 1)
+        return false;
+
+    // 不带 0x 的 "地址 数值"
+    p = skipBlanks(begin, end);
+    int n = hexRun(p, end);
+    if ((n == 0) || (n > 16) || (p + n == end) || ((p[n] != ' ') && (p[n] != '\t') && (p[n] != ':')))
+        return false;
+    *address = hexValue(p, n);
+    p = skipBlanks(p + n + ((p[n] == ':') ? 1 : 0), end);
+    int m = hexRun(p, end);
+    if ((m == 0) || (m > 8) || ((p + m < end) && (p[m] != ' ') && (p[m] != '\t') && (p[m] != '\r')))
+        return false;
+    *value = static_cast<uint32_t>(hexValue(p, m));
+    return true;
+}
+
+void DwordTokenizer::pushByte(uint32_t byte, QVector<uint32_t> &out)
+{
+    byteAcc |= byte << (8 * byteCount);
+    if (++byteCount == 4) {
+        out.push_back(byteAcc);
+        byteAcc = 0;
+        byteCount = 0;
+    }
+}
+
+bool DwordTokenizer::parseHexdumpLine(const char *begin, const char *end, QVector<uint32_t> &out)
+{
+    const char *p = skipBlanks(begin, end);
+    if ((p < end) && (*p == '*')) {
+        repeatPending = true;
+        return true;
+    }
+
+    int run = hexRun(p, end);
+    if ((run == 0) || (run > 16))
+        return false;
+    qint64 offset = static_cast<qint64>(hexValue(p, run));
+    p += run;
+
+    // 补齐被 "*" 省略的、与上一行相同的行
+    if (repeatPending && !lastBytes.isEmpty()) {
+        for (qint64 next = lastOffset + lastBytes.size(); next + lastBytes.size() <= offset; next += lastBytes.size()) {
+            for (uint32_t byte : lastBytes)
+                pushByte(byte, out);
+        }
+    }
+    repeatPending = false;
+
+    // 最后一行只有偏移
+    lastBytes.clear();
+    while (lastBytes.size() < 16) {
+        p = skipBlanks(p, end);
+        if ((end - p < 2) || (hexDigit(p[0]) < 0) || (hexDigit(p[1]) < 0))
+            break;
+        if ((end - p > 2) && (p[2] != ' ') && (p[2] != '\t'))
+            break;
+        lastBytes.push_back(static_cast<uint32_t>(hexValue(p, 2)));
+        p += 2;
+    }
+    lastOffset = offset;
+    for (uint32_t byte : lastBytes)
+        pushByte(byte, out);
+    return true;
+}
+
+bool DwordTokenizer::parseXxdLine(const char *begin, const char *end, QVector<uint32_t> &out)
+{
+    const char *p = skipBlanks(begin, end);
+    int run = hexRun(p, end);
+    if ((run == 0) || (p + run >= end) || (p[run] != ':'))
+        return false;
+    p += run + 1;
+    if ((p < end) && (*p == ' '))
+        p++;
+
+    // 字节组之间一个空格，ASCII 列之前两个空格
+    while (p < end) {
+        if (*p == ' ') {
+            if ((end - p >= 2) && (p[1] == ' '))
+                break;
+            p++;
+            continue;
+        }
+        if ((end - p < 2) || (hexDigit(p[0]) < 0) || (hexDigit(p[1]) < 0))
+            break;
+        pushByte(static_cast<uint32_t>(hexValue(p, 2)), out);
+        p += 2;
+    }
+    return true;
+}
+
+bool DwordTokenizer::parseLine(const char *begin, const char *end, uint32_t *value)
+{
+    bool found = false;
+    uint32_t last = 0;
+    const char *p = begin;
+
+    // 与正则 0x[0-9a-fA-F]{8} 的非重叠全局匹配一致，保留最后一个匹配
+    while (end - p >= 10) {
+        if ((p[0] != '0') || (p[1] != 'x')) {
+            p++;
+            continue;
+        }
+        uint32_t dword = 0;
+        int i = 0;
+        for (; i < 8; i++) {
+            signed char d = hexTable.digit[static_cast<unsigned char>(p[2 + i])];
+            if (d < 0)
+                break;
+            dword = (dword << 4) | static_cast<uint32_t>(d);
+        }
+        if (i == 8) {
+            last = dword;
+            found = true;
+            p += 10;
+        } else {
+            p++;
+        }
+    }
+
+    if (found && value)
+        *value = last;
+    return found;
+}
+
+bool DwordTokenizer::parseTimestamp(const char *begin, const char *end, qint64 *ns, const char **stop)
+{
+    const char *p = begin;
+    while ((p < end) && ((*p == ' ') || (*p == '\t')))
+        p++;
+    if ((p == end) || (*p != '['))
+        return false;
+    p++;
+    while ((p < end) && (*p == ' '))
+        p++;
+
+    qint64 t;
+    if (!TimeIndex::parseSeconds(p, end, &t, &p))
+        return false;
+    while ((p < end) && (*p == ' '))
+        p++;
+    if ((p == end) || (*p != ']'))
+        return false;
+
+    if (ns)
+        *ns = t;
+    if (stop)
+        *stop = p + 1;
+    return true;
+}
+
+int DwordTokenizer::feed(const char *data, int size, QVector<uint32_t> &out, bool flush, TimeMarks *marks)
+{
+    const char *p = data;
+    const char *end = data + size;
+    // out 由本分词器连续填充，out[0] 在组内的位置
+    int startSize = out.size();
+    int outPhase = (mGroupDwords > 0) ? (((mPhase - startSize) % mGroupDwords) + mGroupDwords) % mGroupDwords : 0;
+
+    if (mActive == Auto) {
+        // 有完整的行之后才识别
+        int complete = size;
+        if (!flush) {
+            while ((complete > 0) && (data[complete - 1] != '\n'))
+                complete--;
+            if (complete == 0)
+                return 0;
+        }
+        mActive = detect(data, complete);
+        qDebug("%s[%d]: detected format %d", __func__, __LINE__, mActive);
+    }
+
+    while (p < end) {
+        const char *eol = static_cast<const char *>(memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (eol == nullptr) {
+            if (!flush)
+                break;
+            eol = end;
+        }
+        const char *lineEnd = ((eol > p) && (eol[-1] == '\r')) ? eol - 1 : eol;
+
+        // 行首的时间戳只解析一次，各格式从其后开始解析
+        const char *body = p;
+        qint64 t = TimeIndex::kNoTime;
+        bool hasTime = parseTimestamp(p, lineEnd, &t, &body);
+
+        int before = out.size();
+        bool ok = false;
+        switch (mActive) {
+        case Dwords:
+            ok = (parseWords(body, lineEnd, 8, &out) > 0);
+            break;
+        case Qwords:
+            ok = (parseWords(body, lineEnd, 16, &out) > 0);
+            break;
+        case HexdumpC:
+            ok = parseHexdumpLine(body, lineEnd, out);
+            break;
+        case Xxd:
+            ok = parseXxdLine(body, lineEnd, out);
+            break;
+        default: {
+            uint32_t dword;
+            ok = parseLine(body, lineEnd, &dword);
+            if (ok)
+                out.push_back(dword);
+            break;
+        }
+        }
+
+        if (ok) {
+            mParsedLines++;
+            if (marks && hasTime && (out.size() > before)) {
+                // 一行跨越多组时，每组的第一个 DWORD 都记录这一行的时间
+                TimeIndex::addMark(*marks, before, t, mGroupDwords, outPhase);
+                if (mGroupDwords > 0) {
+                    qint64 next = before + mGroupDwords - (before + outPhase) % mGroupDwords;
+                    for (; next < out.size(); next += mGroupDwords)
+                        TimeIndex::addMark(*marks, next, t, mGroupDwords, outPhase);
+                }
+            }
+        } else if (eol - p > 1) {
+            // 日志中夹杂的其它行直接跳过
+            mSkippedLines++;
+        }
+        p = (eol < end) ? eol + 1 : end;
+    }
+
+    // 按字节输出的格式在数据结束时输出剩余的字节
+    if (flush && (p == end) && (byteCount > 0)) {
+        qWarning("%s[%d]: %d trailing bytes padded with zeros", __func__, __LINE__, byteCount);
+        out.push_back(byteAcc);
+        byteAcc = 0;
+        byteCount = 0;
+    }
+
+    if (mGroupDwords > 0)
+        mPhase = static_cast<int>((mPhase + qint64(out.size() - startSize)) % mGroupDwords);
+    return static_cast<int>(p - data);
+}
@@ -0,0 +1,85 @@
+#ifndef DWORDTOKENIZER_H
+#define DWORDTOKENIZER_H
+
+#include <QVector>
+#include "timeindex.h"
+
+// 文本 DWORD 快速分词器
+// 默认格式与 DataInputEdit::stripLines 规则一致：每行取最后一个 "0x" + 8 位十六进制数，
+// 但直接扫描字节、不使用正则表达式，用于大批量数据。
+// 其它常见的 dump 格式同样逐行单遍解析，输出连续的 DWORD 流：
+//   Dwords    "80001000: deadbeef 01020304"、"0xdeadbeef 0x01020304"、"deadbeef"
+//   Qwords    "0x0123456789abcdef"，按小端序拆为低、高两个 DWORD
+//   HexdumpC  "00000010  ef be ad de 04 03 ...  |....|"，字节按小端序组成 DWORD，支持 "*" 重复行
+//   Xxd       "00000010: efbe adde 0403 ...  ........"
+// 可选提取行首的时间戳，如 "[ 1234.567890] ... 0xdeadbeef"。
+class DwordTokenizer
+{
+public:
+    enum Format {
+        Auto,       // 按开头的若干行识别，之后固定使用识别结果
+        LastDword,
+        Dwords,
+        Qwords,
+        HexdumpC,
+        Xxd,
+    };
+
+    DwordTokenizer();
+
+    void setFormat(Format format);
+    Format format() const { return mFormat; }
+    // 实际使用的格式，自动识别前为 Auto
+    Format activeFormat() const { return mActive; }
+    // 按 data 开头的若干行识别格式，无法识别时为 LastDword
+    static Format detect(const char *data, int size);
+
+    // 解析 data 中的完整行并追加到 out，返回消费的字节数
+    // 末尾不完整的行不消费，由调用者保留到下次；flush 为 true 时当作完整行处理，
+    // 按字节输出的格式末尾不足 4 字节时高位补 0 输出
+    // 行首的时间戳在解析之前去掉，不影响格式识别和各格式的解析
+    // marks 不为空时同时追加带时间戳的行的标记，位置为 out 中的下标，见 setTimeGroups
+    int feed(const char *data, int size, QVector<uint32_t> &out, bool flush = false, TimeMarks *marks = nullptr);
+    // 清除解析状态和自动识别结果，保留设置的格式和每组 DWORD 数，下一个 DWORD 位于组首
+    void reset();
+    // 按组记录时间戳标记：每组 dwPerGroup 个 DWORD，每组只保留第一个标记，0 表示每行都记录；
+    // phase 为下一个输出的 DWORD 在组内的位置
+    void setTimeGroups(int dwPerGroup, int phase = 0);
+    // 下一个输出的 DWORD 在组内的位置
+    int timePhase() const { return mPhase; }
+
+    qint64 parsedLines() const { return mParsedLines; }
+    qint64 skippedLines() const { return mSkippedLines; }
+
+    static bool parseLine(const char *begin, const char *end, uint32_t *value);
+    // 行首 "[ 秒.小数]" 格式的时间戳，stop 返回 "]" 之后的位置
+    static bool parseTimestamp(const char *begin, const char *end, qint64 *ns, const char **stop = nullptr);
+    // 一行中连续的 digits 位十六进制数（0x 可省略，可带 "地址:" 前缀），返回个数
+    // out 为空时只计数；colonPrefix 返回是否带地址前缀
+    static int parseWords(const char *begin, const char *end, int digits, QVector<uint32_t> *out,
+                          bool *colonPrefix = nullptr);
+    // MMIO 访问记录的 "地址 数值" 行：第一个 0x 数为地址，最后一个为数值；
+    // 没有 0x 时取前两个十六进制单词
+    static bool parseAddressValue(const char *begin, const char *end, quint64 *address, uint32_t *value);
+
+private:
+    bool parseHexdumpLine(const char *begin, const char *end, QVector<uint32_t> &out);
+    bool parseXxdLine(const char *begin, const char *end, QVector<uint32_t> &out);
+    void pushByte(uint32_t byte, QVector<uint32_t> &out);
+
+    Format mFormat;
+    Format mActive;
+    int mGroupDwords;
+    int mPhase;
+    qint64 mParsedLines;
+    qint64 mSkippedLines;
+    // 按字节输出的格式中尚未组成 DWORD 的字节
+    uint32_t byteAcc;
+    int byteCount;
+    // hexdump -C 上一行的偏移和字节，遇到 "*" 行时按下一行的偏移补齐重复的行
+    qint64 lastOffset;
+    QVector<uint32_t> lastBytes;
+    bool repeatPending;
+};
+
+#endif // DWORDTOKENIZER_H
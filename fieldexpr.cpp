@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <QObject>
+#include "fieldexpr.h"
+
+// 递归下降解析，按优先级直接生成后缀字节码
+class FieldExpr::Parser
+{
+public:
+    Parser(const QString &text, const QStringList &names, FieldExpr *expr)
+        : text(text), names(names), expr(expr), pos(0), depth(0) {}
+
+    bool parse(QString *error);
+
+private:
+    struct BinaryOp
+    {
+        const char *token;
+        Op op;
+        int prec;
+    };
+
+    bool parseExpr(int minPrec);
+    bool parseUnary();
+    const BinaryOp *peekBinary();
+    void skipSpaces();
+    void emitOp(Op op, int operand = 0);
+    bool fail(const QString &message);
+
+    const QString &text;
+    const QStringList &names;
+    FieldExpr *expr;
+    int pos;
+    int depth;
+    QString mError;
+};
+
+// 两字符的运算符排在前面，先匹配
+static const int kBinaryOpCount = 18;
+
+bool FieldExpr::Parser::parse(QString *error)
+{
+    bool ok = parseExpr(1);
+    skipSpaces();
+    if (ok && (pos < text.size()))
+        ok = fail(QObject::tr("Unexpected '%1'").arg(text.mid(pos, 1)));
+    if (!ok && error)
+        *error = QObject::tr("%1 at position %2").arg(mError).arg(pos);
+    return ok;
+}
+
+void FieldExpr::Parser::skipSpaces()
+{
+    while ((pos < text.size()) && text.at(pos).isSpace())
+        pos++;
+}
+
+void FieldExpr::Parser::emitOp(Op op, int operand)
+{
+    expr->code.push_back({op, operand});
+    if ((op == PushField) || (op == PushConst))
+        depth++;
+    else if (op >= Mul)
+        depth--;
+    expr->maxDepth = qMax(expr->maxDepth, depth);
+}
+
+bool FieldExpr::Parser::fail(const QString &message)
+{
+    mError = message;
+    return false;
+}
+
+const FieldExpr::Parser::BinaryOp *FieldExpr::Parser::peekBinary()
+{
+    static const BinaryOp ops[kBinaryOpCount] = {
+        {"||", LOr, 1}, {"&&", LAnd, 2}, {"==", Eq, 6}, {"!=", Ne, 6}, {"<=", Le, 7}, {">=", Ge, 7},
+        {"<<", Shl, 8}, {">>", Shr, 8},
+        {"|", Or, 3}, {"^", Xor, 4}, {"&", And, 5}, {"<", Lt, 7}, {">", Gt, 7},
+        {"+", Add, 9}, {"-", Sub, 9}, {"*", Mul, 10}, {"/", Div, 10}, {"%", Mod, 10},
+    };
+
+    skipSpaces();
+    for (const BinaryOp &op : ops) {
+        if (text.midRef(pos).startsWith(QLatin1String(op.token)))
+            return &op;
+    }
+    return nullptr;
+}
+
+bool FieldExpr::Parser::parseExpr(int minPrec)
+{
+    if (!parseUnary())
+        return false;
+
+    const BinaryOp *op;
+    while (((op = peekBinary()) != nullptr) && (op->prec >= minPrec)) {
+        pos += static_cast<int>(qstrlen(op->token));
+        // 左结合：右侧只接受更高优先级的运算
+        if (!parseExpr(op->prec + 1))
+            return false;
+        emitOp(op->op);
+    }
+    return true;
+}
+
+bool FieldExpr::Parser::parseUnary()
+{
+    skipSpaces();
+    if (pos >= text.size())
+        return fail(QObject::tr("Unexpected end of expression"));
+
+    QChar c = text.at(pos);
+    if ((c == '-') || (c == '~') || (c == '!')) {
+        pos++;
+        if (!parseUnary())
+            return false;
+        emitOp((c == '-') ? Neg : ((c == '~') ? Not : LNot));
+        return true;
+    }
+
+    if (c == '(') {
+        pos++;
+        if (!parseExpr(1))
+            return false;
+        skipSpaces();
+        if ((pos >= text.size()) || (text.at(pos) != ')'))
+            return fail(QObject::tr("Missing ')'"));
+        pos++;
+        return true;
+    }
+
+    if (c.isDigit()) {
+        int start = pos;
+        while ((pos < text.size()) && (text.at(pos).isLetterOrNumber() || (text.at(pos) == '_')))
+            pos++;
+        QString number = text.mid(start, pos - start).remove('_');
+        bool ok;
+        quint64 value = number.startsWith("0x", Qt::CaseInsensitive) ? number.mid(2).toULongLong(&ok, 16)
+                                                                     : number.toULongLong(&ok, 10);
+        if (!ok)
+            return fail(QObject::tr("Invalid number '%1'").arg(number));
+        expr->consts.push_back(value);
+        emitOp(PushConst, expr->consts.size() - 1);
+        return true;
+    }
+
+    if (c.isLetter() || (c == '_')) {
+        int start = pos;
+        while ((pos < text.size()) && (text.at(pos).isLetterOrNumber() || (text.at(pos) == '_') || (text.at(pos) == '.')))
+            pos++;
+        QString name = text.mid(start, pos - start);
+        int field = names.indexOf(name);
+        if (field < 0)
+            return fail(QObject::tr("Unknown field '%1'").arg(name));
+        if (!expr->mInputs.contains(field))
+            expr->mInputs.push_back(field);
+        emitOp(PushField, field);
+        return true;
+    }
+
+    return fail(QObject::tr("Unexpected '%1'").arg(c));
+}
+
+bool FieldExpr::compile(const QString &text, const QStringList &names, QString *error)
+{
+    code.clear();
+    consts.clear();
+    mInputs.clear();
+    maxDepth = 0;
+
+    Parser parser(text, names, this);
+    if (!parser.parse(error)) {
+        code.clear();
+        return false;
+    }
+    return true;
+}
+
+// 按列执行一条二元指令：a[i] = f(a[i], b[i])
+// 保持简单的连续循环，便于编译器自动向量化
+template <typename F>
+static inline void binaryColumn(quint64 *__restrict a, const quint64 *__restrict b, int count, F f)
+{
+    for (int i = 0; i < count; i++)
+        a[i] = f(a[i], b[i]);
+}
+
+template <typename F>
+static inline void unaryColumn(quint64 *__restrict a, int count, F f)
+{
+    for (int i = 0; i < count; i++)
+        a[i] = f(a[i]);
+}
+
+void FieldExpr::evaluate(const QVector<const quint64 *> &columns, int count, quint64 *out) const
+{
+    if (!isValid() || (count <= 0))
+        return;
+
+    // 栈中每个元素是一整列
+    QVector<quint64> stack(maxDepth * count);
+    int sp = 0;
+    for (const Instr &instr : code) {
+        quint64 *top = (sp > 0) ? stack.data() + (sp - 1) * count : nullptr;
+        quint64 *a = (sp > 1) ? top - count : nullptr;
+        const quint64 *b = top;
+
+        switch (instr.op) {
+        case PushField: {
+            const quint64 *src = columns.at(instr.operand);
+            std::copy(src, src + count, stack.data() + sp * count);
+            sp++;
+            continue;
+        }
+        case PushConst:
+            std::fill(stack.data() + sp * count, stack.data() + (sp + 1) * count, consts.at(instr.operand));
+            sp++;
+            continue;
+        case Neg:
+            unaryColumn(top, count, [](quint64 x) { return 0 - x; });
+            continue;
+        case Not:
+            unaryColumn(top, count, [](quint64 x) { return ~x; });
+            continue;
+        case LNot:
+            unaryColumn(top, count, [](quint64 x) { return quint64(x == 0); });
+            continue;
+        case Mul: binaryColumn(a, b, count, [](quint64 x, quint64 y) { return x * y; }); break;
+        case Div: binaryColumn(a, b, count, [](quint64 x, quint64 y) { return y ? x / y : 0; }); break;
+        case Mod: binaryColumn(a, b, count, [](quint64 x, quint64 y) { return y ? x % y : 0; }); break;
+        case Add: binaryColumn(a, b, count, [](quint64 x, quint64 y) { return x + y; }); break;
+        case Sub: binaryColumn(a, b, count, [](quint64 x, quint64 y) { return x - y; }); break;
+        case Shl: binaryColumn(a, b, count, [](quint64 x, quint64 y) { return (y < 64) ? (x << y) : 0; }); break;
+        case Shr: binaryColumn(a, b, count, [](quint64 x, quint64 y) { return (y < 64) ? (x >> y) : 0; }); break;
+        case Lt: binaryColumn(a, b, count, [](quint64 x, quint64 y) { return quint64(x < y); }); break;
+        case Le: binaryColumn(a, b, count, [](quint64 x, quint64 y) { return quint64(x <= y); }); break;
+        case Gt: binaryColumn(a, b, count, [](quint64 x, quint64 y) { return quint64(x > y); }); break;
+        case Ge: binaryColumn(a, b, count, [](quint64 x, quint64 y) { return quint64(x >= y); }); break;
+        case Eq: binaryColumn(a, b, count, [](quint64 x, quint64 y) { return quint64(x == y); }); break;
+        case Ne: binaryColumn(a, b, count, [](quint64 x, quint64 y) { return quint64(x != y); }); break;
+        case And: binaryColumn(a, b, count, [](quint64 x, quint64 y) { return x & y; }); break;
+        case Xor: binaryColumn(a, b, count, [](quint64 x, quint64 y) { return x ^ y; }); break;
+        case Or: binaryColumn(a, b, count, [](quint64 x, quint64 y) { return x | y; }); break;
+        case LAnd: binaryColumn(a, b, count, [](quint64 x, quint64 y) { return quint64(x && y); }); break;
+        case LOr: binaryColumn(a, b, count, [](quint64 x, quint64 y) { return quint64(x || y); }); break;
+        }
+        sp--;
+    }
+
+    std::copy(stack.constData(), stack.constData() + count, out);
+}
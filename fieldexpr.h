@@ -0,0 +1,48 @@
+#ifndef FIELDEXPR_H
+#define FIELDEXPR_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// 派生字段表达式，例如 (addr_hi << 32) | addr_lo << 2
+// 支持十进制和 0x 十六进制常数、字段名、括号，以及 C 语言的一元和二元整数运算符，
+// 按 64 位无符号数计算，除数为 0 时结果为 0。
+// 表达式只解析一次，编译为后缀形式的字节码；求值时每条指令处理一整批组（按列计算），
+// 不逐个单元格解释执行。
+class FieldExpr
+{
+public:
+    // names 为表达式中可以引用的字段名，下标即字段序号
+    bool compile(const QString &text, const QStringList &names, QString *error = nullptr);
+    bool isValid() const { return !code.isEmpty(); }
+    // 表达式引用的字段序号
+    const QVector<int> &inputs() const { return mInputs; }
+
+    // columns[field] 指向该字段的 count 个值，只需提供 inputs() 中的字段，结果写入 out
+    void evaluate(const QVector<const quint64 *> &columns, int count, quint64 *out) const;
+
+private:
+    enum Op : quint8 {
+        PushField, PushConst,
+        Neg, Not, LNot,
+        Mul, Div, Mod, Add, Sub, Shl, Shr,
+        Lt, Le, Gt, Ge, Eq, Ne,
+        And, Xor, Or, LAnd, LOr,
+    };
+
+    struct Instr
+    {
+        Op op;
+        int operand;    // 字段序号或常数下标
+    };
+
+    class Parser;
+
+    QVector<Instr> code;
+    QVector<quint64> consts;
+    QVector<int> mInputs;
+    int maxDepth = 0;
+};
+
+#endif // FIELDEXPR_H
@@ -0,0 +1,128 @@
+#include <cmath>
+#include <QJsonObject>
+#include <QObject>
+#include "fieldformatter.h"
+
+// 位宽不超过该值的枚举和标志位字段展开为完整的字符串表
+static const int kMaxTableBits = 12;
+
+bool FieldFormatter::compile(const QJsonValue &format, int width, QString *error)
+{
+    this->width = width;
+    type = Unsigned;
+    table.clear();
+    names.clear();
+    bitNames.clear();
+    if (format.isUndefined() || format.isNull())
+        return true;
+
+    QJsonObject obj = format.isString() ? QJsonObject{{"type", format.toString()}} : format.toObject();
+    QString typeName = obj["type"].toString();
+    bool useTable = (width <= kMaxTableBits);
+    int entries = useTable ? (1 << width) : 0;
+
+    if (typeName == "signed") {
+        type = Signed;
+    } else if (typeName == "fixed") {
+        type = Fixed;
+        int frac = obj["frac"].toInt(-1);
+        if ((frac < 0) || (frac > width)) {
+            if (error)
+                *error = QObject::tr("fixed: \"frac\" must be between 0 and the field width");
+            return false;
+        }
+        isSigned = obj["signed"].toBool(true);
+        scale = std::ldexp(1.0, -frac);
+        decimals = static_cast<int>(std::ceil(frac * std::log10(2.0)));
+    } else if (typeName == "bool") {
+        type = Bool;
+        table = {"false", "true"};
+    } else if (typeName == "enum") {
+        type = Enum;
+        QJsonObject values = obj["values"].toObject();
+        for (auto it = values.begin(); it != values.end(); ++it) {
+            bool ok;
+            quint64 v = it.key().startsWith("0x", Qt::CaseInsensitive) ? it.key().mid(2).toULongLong(&ok, 16)
+                                                                        : it.key().toULongLong(&ok, 10);
+            if (!ok) {
+                if (error)
+                    *error = QObject::tr("enum: invalid value \"%1\"").arg(it.key());
+                return false;
+            }
+            names.insert(v, it.value().toString());
+        }
+        // 未命名的值显示为数字
+        for (int v = 0; v < entries; v++)
+            table.push_back(names.value(v, QString::number(v)));
+    } else if (typeName == "flags") {
+        type = Flags;
+        QJsonObject bits = obj["bits"].toObject();
+        bitNames.resize(width);
+        for (int b = 0; b < width; b++)
+            bitNames[b] = QString("bit%1").arg(b);
+        for (auto it = bits.begin(); it != bits.end(); ++it) {
+            bool ok;
+            int b = it.key().toInt(&ok);
+            if (!ok || (b < 0) || (b >= width)) {
+                if (error)
+                    *error = QObject::tr("flags: invalid bit \"%1\"").arg(it.key());
+                return false;
+            }
+            bitNames[b] = it.value().toString();
+        }
+        for (int v = 0; v < entries; v++)
+            table.push_back(formatFlags(v));
+    } else {
+        if (error)
+            *error = QObject::tr("Unknown format \"%1\"").arg(typeName);
+        return false;
+    }
+    return true;
+}
+
+qint64 FieldFormatter::signExtend(quint64 value) const
+{
+    if (width >= 64)
+        return static_cast<qint64>(value);
+    int shift = 64 - width;
+    return static_cast<qint64>(value << shift) >> shift;
+}
+
+QString FieldFormatter::formatFlags(quint64 value) const
+{
+    if (value == 0)
+        return QStringLiteral("0");
+    QString text;
+    for (int b = 0; b < bitNames.size(); b++) {
+        if (!((value >> b) & 1))
+            continue;
+        if (!text.isEmpty())
+            text += '|';
+        text += bitNames.at(b);
+    }
+    return text;
+}
+
+QString FieldFormatter::format(quint64 value) const
+{
+    switch (type) {
+    case Signed:
+        return QString::number(signExtend(value));
+    case Fixed: {
+        double v = isSigned ? static_cast<double>(signExtend(value)) : static_cast<double>(value);
+        return QString::number(v * scale, 'f', decimals);
+    }
+    case Bool:
+        return table.at(value != 0);
+    case Enum:
+        if (value < static_cast<quint64>(table.size()))
+            return table.at(static_cast<int>(value));
+        return names.value(value, QString::number(value));
+    case Flags:
+        if (value < static_cast<quint64>(table.size()))
+            return table.at(static_cast<int>(value));
+        return formatFlags(value);
+    default:
+        return QString::number(value);
+    }
+}
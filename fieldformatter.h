@@ -0,0 +1,45 @@
+#ifndef FIELDFORMATTER_H
+#define FIELDFORMATTER_H
+
+#include <QHash>
+#include <QJsonValue>
+#include <QString>
+#include <QVector>
+
+// 字段值的显示格式，由模板字段的 "format" 指定：
+//   "signed"                                        补码有符号数
+//   {"type": "fixed", "frac": 8, "signed": true}    Qm.n 定点数，signed 默认为 true
+//   "bool"                                          false / true
+//   {"type": "enum", "values": {"0": "READ", "1": "WRITE_DMA"}}
+//   {"type": "flags", "bits": {"0": "VALID", "3": "EOP"}}
+// 没有 format 时显示无符号十进制数。
+// 枚举、标志位和布尔值在编译模板时展开为按值索引的字符串表，显示时只是一次查表，
+// 字符串隐式共享，不产生新的分配；位宽过大的字段退回到散列表和逐位拼接。
+class FieldFormatter
+{
+public:
+    enum Type { Unsigned, Signed, Fixed, Bool, Enum, Flags };
+
+    // width 为字段位宽，派生字段为 64
+    bool compile(const QJsonValue &format, int width, QString *error = nullptr);
+    bool isPlain() const { return type == Unsigned; }
+    Type formatType() const { return type; }
+    QString format(quint64 value) const;
+
+private:
+    qint64 signExtend(quint64 value) const;
+    QString formatFlags(quint64 value) const;
+
+    Type type = Unsigned;
+    int width = 32;
+    bool isSigned = true;
+    double scale = 1.0;
+    int decimals = 0;
+    // 按值索引的字符串表
+    QVector<QString> table;
+    QHash<quint64, QString> names;
+    // 标志位名称，下标为位号
+    QVector<QString> bitNames;
+};
+
+#endif // FIELDFORMATTER_H
@@ -0,0 +1,179 @@
+#include <QDebug>
+#include <QFileInfo>
+#include "filefollower.h"
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+// 单次读取的最大字节数
+static const qint64 kReadChunkSize = 4 * 1024 * 1024;
+
+// 路径当前指向的文件的标识，用于发现轮转
+static quint64 fileIdOf(const QString &path)
+{
+#ifdef Q_OS_UNIX
+    struct stat st;
+    if (stat(QFile::encodeName(path).constData(), &st) != 0)
+        return 0;
+    return (quint64(st.st_dev) << 32) ^ quint64(st.st_ino);
+#else
+    Q_UNUSED(path);
+    return 0;
+#endif
+}
+
+FileFollower::FileFollower(QObject *parent)
+    : QObject(parent)
+    , fileId(0)
+    , offset(0)
+    , timestamps(false)
+    , groupDwords(0)
+    , startPhase(0)
+{
+    pollTimer.setInterval(200);
+    connect(&pollTimer, &QTimer::timeout, this, &FileFollower::readAppended);
+    connect(&watcher, &QFileSystemWatcher::fileChanged, this, &FileFollower::readAppended);
+}
+
+FileFollower::~FileFollower()
+{
+    stop();
+}
+
+void FileFollower::setTimestamps(bool enabled, int dwPerGroup, int phase)
+{
+    timestamps = enabled;
+    groupDwords = dwPerGroup;
+    startPhase = phase;
+}
+
+bool FileFollower::start(const QString &path, QString *error)
+{
+    stop();
+    tokenizer.setTimeGroups(groupDwords, startPhase);
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    fileId = fileIdOf(path);
+
+    watcher.addPath(path);
+    pollTimer.start();
+    qDebug() << "Follow" << path;
+
+    // 先读取已有内容
+    readAppended();
+    return true;
+}
+
+void FileFollower::stop()
+{
+    pollTimer.stop();
+    if (!watcher.files().isEmpty())
+        watcher.removePaths(watcher.files());
+    if (file.isOpen())
+        file.close();
+    fileId = 0;
+    carry.clear();
+    offset = 0;
+    tokenizer.reset();
+}
+
+bool FileFollower::isRotated() const
+{
+    // 轮转过程中路径可能暂时不存在，继续读取旧文件
+    QFileInfo info(file.fileName());
+    if (!info.exists())
+        return false;
+    quint64 id = fileIdOf(file.fileName());
+    if ((id != 0) && (fileId != 0))
+        return id != fileId;
+    // 无法取得标识时，路径上的文件比已读取的少而打开的文件没有变小，说明是另一个文件
+    return (info.size() < offset) && (file.size() >= offset);
+}
+
+void FileFollower::reopen()
+{
+    // 旧文件末尾不完整的行当作完整行处理
+    readNew(true);
+
+    QString path = file.fileName();
+    file.close();
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        qWarning("%s[%d]: cannot reopen %s: %s", __func__, __LINE__, qPrintable(path), qPrintable(file.errorString()));
+        stop();
+        return;
+    }
+    fileId = fileIdOf(path);
+    offset = 0;
+    carry.clear();
+    // 新文件的数据接在后面，组内位置不变
+    int phase = tokenizer.timePhase();
+    tokenizer.reset();
+    tokenizer.setTimeGroups(groupDwords, phase);
+    if (!watcher.files().isEmpty())
+        watcher.removePaths(watcher.files());
+    watcher.addPath(path);
+    qDebug() << "File rotated" << path;
+}
+
+void FileFollower::readAppended()
+{
+    if (!file.isOpen())
+        return;
+
+    if (isRotated()) {
+        reopen();
+        if (!file.isOpen())
+            return;
+    }
+
+    if (file.size() < offset) {
+        // 文件被原地截断，从头开始
+        qDebug() << "File truncated" << file.fileName();
+        offset = 0;
+        carry.clear();
+        // 数据存储随之清空，新内容从组首开始，之前未完成的字节和识别的格式不再适用
+        tokenizer.reset();
+        tokenizer.setTimeGroups(groupDwords, 0);
+        emit fileTruncated();
+    }
+
+    // 部分平台上文件被替换后监视会失效，重新加入
+    if (watcher.files().isEmpty())
+        watcher.addPath(file.fileName());
+
+    readNew();
+}
+
+void FileFollower::readNew(bool flush)
+{
+    qint64 size = file.size();
+    if ((size == offset) && !(flush && !carry.isEmpty()))
+        return;
+    if (!file.seek(offset))
+        return;
+
+    QVector<uint32_t> dwords;
+    TimeMarks marks;
+    while (offset < size) {
+        QByteArray chunk = file.read(qMin(kReadChunkSize, size - offset));
+        if (chunk.isEmpty())
+            break;
+        offset += chunk.size();
+
+        carry.append(chunk);
+        int consumed = tokenizer.feed(carry.constData(), carry.size(), dwords, false, timestamps ? &marks : nullptr);
+        carry.remove(0, consumed);
+    }
+    if (flush && !carry.isEmpty()) {
+        tokenizer.feed(carry.constData(), carry.size(), dwords, true, timestamps ? &marks : nullptr);
+        carry.clear();
+    }
+
+    if (!dwords.isEmpty())
+        emit dwordsAppended(dwords, marks);
+}
@@ -0,0 +1,59 @@
+#ifndef FILEFOLLOWER_H
+#define FILEFOLLOWER_H
+
+#include <QObject>
+#include <QFile>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include "dwordtokenizer.h"
+
+// 跟踪持续增长的抓取文件
+// 只读取新追加的字节，不完整的行保留到下次读取；不完整的组由 ResultStore 保留。
+// 文件被截断时从头读取并通知清空数据；路径指向新文件（轮转）时读完旧文件后打开新文件，数据接在后面。
+class FileFollower : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FileFollower(QObject *parent = nullptr);
+    ~FileFollower();
+
+    // 是否提取行首时间戳，在 start() 之前设置
+    // 每组只记录第一个时间戳：每组 dwPerGroup 个 DWORD，文件的第一个 DWORD 位于组内第 phase 个
+    void setTimestamps(bool enabled, int dwPerGroup = 0, int phase = 0);
+    void setFormat(DwordTokenizer::Format format) { tokenizer.setFormat(format); }
+    bool start(const QString &path, QString *error = nullptr);
+    void stop();
+    bool isFollowing() const { return file.isOpen(); }
+    QString filePath() const { return file.fileName(); }
+
+signals:
+    // 未提取时间戳时 marks 为空
+    void dwordsAppended(const QVector<uint32_t> &dwords, const TimeMarks &marks);
+    void fileTruncated();
+
+private slots:
+    void readAppended();
+
+private:
+    // 读取 offset 之后的新内容
+    void readNew(bool flush = false);
+    // 路径是否已指向另一个文件
+    bool isRotated() const;
+    void reopen();
+
+    QFile file;
+    // 打开的文件的标识（设备号和 inode），不支持的平台为 0
+    quint64 fileId;
+    QFileSystemWatcher watcher;
+    // 部分平台上文件变化通知不可靠，定时轮询作为补充
+    QTimer pollTimer;
+    QByteArray carry;
+    qint64 offset;
+    DwordTokenizer tokenizer;
+    bool timestamps;
+    int groupDwords;
+    int startPhase;
+};
+
+#endif // FILEFOLLOWER_H
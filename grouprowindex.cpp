@@ -0,0 +1,100 @@
+#include <algorithm>
+#include "grouprowindex.h"
+
+// 已丢弃的前缀超过该数量时压缩数组
+static const int kCompactThreshold = 64 * 1024;
+
+GroupRowIndex::GroupRowIndex()
+    : uniformRows(0)
+    , uniformGroups(0)
+    , head(0)
+{
+    starts.push_back(0);
+}
+
+void GroupRowIndex::reset(int rowsPerGroup)
+{
+    uniformRows = qMax(0, rowsPerGroup);
+    uniformGroups = 0;
+    starts.clear();
+    starts.push_back(0);
+    head = 0;
+}
+
+void GroupRowIndex::appendGroups(qint64 count)
+{
+    if (isUniform()) {
+        uniformGroups += count;
+    } else {
+        for (qint64 i = 0; i < count; i++)
+            appendGroup(0);
+    }
+}
+
+void GroupRowIndex::appendGroup(int rows)
+{
+    if (isUniform()) {
+        uniformGroups++;
+        return;
+    }
+    starts.push_back(starts.last() + rows);
+}
+
+qint64 GroupRowIndex::dropFront(qint64 count)
+{
+    count = qMin(count, groupCount());
+    if (count <= 0)
+        return 0;
+
+    if (isUniform()) {
+        uniformGroups -= count;
+        return count * uniformRows;
+    }
+
+    qint64 rows = starts.at(head + static_cast<int>(count)) - starts.at(head);
+    head += static_cast<int>(count);
+    if (head >= kCompactThreshold) {
+        starts.remove(0, head);
+        head = 0;
+    }
+    return rows;
+}
+
+qint64 GroupRowIndex::groupCount() const
+{
+    return isUniform() ? uniformGroups : (starts.size() - 1 - head);
+}
+
+qint64 GroupRowIndex::rowCount() const
+{
+    return isUniform() ? (uniformGroups * uniformRows) : (starts.last() - starts.at(head));
+}
+
+qint64 GroupRowIndex::groupOfRow(qint64 row) const
+{
+    if ((row < 0) || (row >= rowCount()))
+        return -1;
+
+    if (isUniform())
+        return row / uniformRows;
+
+    // 第一个起始行大于 row 的组的前一组即为所在组，空组会被自然跳过
+    qint64 absRow = starts.at(head) + row;
+    auto it = std::upper_bound(starts.constBegin() + head, starts.constEnd(), absRow);
+    return (it - starts.constBegin()) - 1 - head;
+}
+
+qint64 GroupRowIndex::firstRowOf(qint64 group) const
+{
+    if (isUniform())
+        return group * uniformRows;
+    return starts.at(head + static_cast<int>(group)) - starts.at(head);
+}
+
+int GroupRowIndex::rowsOf(qint64 group) const
+{
+    if (isUniform())
+        return uniformRows;
+    int idx = head + static_cast<int>(group);
+    return static_cast<int>(starts.at(idx + 1) - starts.at(idx));
+}
@@ -0,0 +1,43 @@
+#ifndef GROUPROWINDEX_H
+#define GROUPROWINDEX_H
+
+#include <QVector>
+
+// 组与行号的双向映射
+// 各组行数相同时直接按算术计算，不占用额外内存；
+// 行数不同时保存行号前缀和，用 std::upper_bound 查找，复杂度 O(log n)。
+// 组号是相对于当前第一组的序号，从前端丢弃组后序号随之平移。
+class GroupRowIndex
+{
+public:
+    GroupRowIndex();
+
+    // rowsPerGroup > 0 为等长模式，否则为变长模式
+    void reset(int rowsPerGroup);
+    bool isUniform() const { return uniformRows > 0; }
+
+    // 等长模式追加 count 组
+    void appendGroups(qint64 count);
+    // 变长模式追加一组
+    void appendGroup(int rows);
+    // 丢弃前 count 组，返回丢弃的行数
+    qint64 dropFront(qint64 count);
+
+    qint64 groupCount() const;
+    qint64 rowCount() const;
+
+    // 行所在的组，越界返回 -1
+    qint64 groupOfRow(qint64 row) const;
+    qint64 firstRowOf(qint64 group) const;
+    int rowsOf(qint64 group) const;
+
+private:
+    int uniformRows;
+    qint64 uniformGroups;
+    // starts[i] 为第 i 组之前的累计行数（含已丢弃的组），末尾多一个元素表示总行数
+    QVector<qint64> starts;
+    // starts 中已丢弃的组数
+    int head;
+};
+
+#endif // GROUPROWINDEX_H
@@ -0,0 +1,247 @@
+#include <QLocalSocket>
+#include <QTcpSocket>
+#include <QtEndian>
+#include <QDebug>
+#include "ingestserver.h"
+
+// 帧头长度
+static const int kFrameHeaderSize = 12;
+// 单帧 DWORD 个数上限
+static const quint32 kMaxFrameDwords = 16 * 1024 * 1024;
+// 环形缓冲区容量（DWORD 个数）
+static const int kRingDwords = 16 * 1024 * 1024;
+// 模板切换记录的容量
+static const int kSwitchRecords = 256;
+// 单次转换的 DWORD 个数
+static const int kPushChunk = 4096;
+// 待解析数据的上限，超过后不再从连接读取，由套接字和系统缓冲区向发送方施加反压
+static const int kMaxBufferBytes = 4 * 1024 * 1024;
+
+IngestServer::IngestServer(QObject *parent)
+    : QObject(parent)
+    , localServer(nullptr)
+    , tcpServer(nullptr)
+    , peer(nullptr)
+    , retryTimer(nullptr)
+    , dwordsLeft(0)
+    , hasTemplate(false)
+{
+}
+
+IngestServer::~IngestServer()
+{
+    stop();
+}
+
+void IngestServer::start(const QString &socketName, int tcpPort)
+{
+    stop();
+    hasTemplate = false;
+    activeTemplateId.clear();
+    // 界面线程在收到 started 后才开始读取，此时分配不会与消费者冲突
+    mDwordRing.reset(kRingDwords);
+    mSwitchRing.reset(kSwitchRecords);
+
+    // 子对象在服务线程中创建
+    retryTimer = new QTimer(this);
+    retryTimer->setSingleShot(true);
+    retryTimer->setInterval(5);
+    connect(retryTimer, &QTimer::timeout, this, &IngestServer::retryTimer_timeout_handler);
+
+    QStringList endpoints;
+    if (!socketName.isEmpty()) {
+        localServer = new QLocalServer(this);
+        QLocalServer::removeServer(socketName);
+        if (localServer->listen(socketName)) {
+            connect(localServer, &QLocalServer::newConnection, this, &IngestServer::newLocalConnection);
+            endpoints << localServer->fullServerName();
+        } else {
+            qWarning() << "Local server:" << localServer->errorString();
+        }
+    }
+
+    if (tcpPort != 0) {
+        tcpServer = new QTcpServer(this);
+        if (tcpServer->listen(QHostAddress::LocalHost, static_cast<quint16>(tcpPort))) {
+            connect(tcpServer, &QTcpServer::newConnection, this, &IngestServer::newTcpConnection);
+            endpoints << QString("127.0.0.1:%1").arg(tcpServer->serverPort());
+        } else {
+            qWarning() << "TCP server:" << tcpServer->errorString();
+        }
+    }
+
+    if (endpoints.isEmpty()) {
+        stop();
+        releaseRings();
+        emit failed(tr("Cannot listen on any endpoint"));
+        return;
+    }
+    emit started(endpoints.join(", "));
+}
+
+void IngestServer::stop()
+{
+    dropPeer(QString());
+    delete localServer;
+    localServer = nullptr;
+    delete tcpServer;
+    tcpServer = nullptr;
+    delete retryTimer;
+    retryTimer = nullptr;
+}
+
+void IngestServer::releaseRings()
+{
+    mDwordRing.release();
+    mSwitchRing.release();
+}
+
+void IngestServer::newLocalConnection()
+{
+    while (QLocalSocket *socket = localServer->nextPendingConnection())
+        acceptPeer(socket);
+}
+
+void IngestServer::newTcpConnection()
+{
+    while (QTcpSocket *socket = tcpServer->nextPendingConnection())
+        acceptPeer(socket);
+}
+
+void IngestServer::acceptPeer(QIODevice *device)
+{
+    // 同一时间只接收一路数据流，避免不同来源的帧交错
+    if (peer || !buffer.isEmpty()) {
+        qWarning() << "Ingest: reject connection, a stream is already active";
+        device->close();
+        device->deleteLater();
+        return;
+    }
+
+    peer = device;
+    buffer.clear();
+    dwordsLeft = 0;
+    connect(peer, &QIODevice::readyRead, this, &IngestServer::peer_readyRead_handler);
+    // 套接字的读缓冲区也限制大小，满后不再从系统读取
+    if (QLocalSocket *socket = qobject_cast<QLocalSocket *>(peer)) {
+        socket->setReadBufferSize(kMaxBufferBytes);
+        connect(socket, &QLocalSocket::disconnected, this, &IngestServer::peer_disconnected_handler);
+    } else if (QTcpSocket *socket = qobject_cast<QTcpSocket *>(peer)) {
+        socket->setReadBufferSize(kMaxBufferBytes);
+        connect(socket, &QTcpSocket::disconnected, this, &IngestServer::peer_disconnected_handler);
+    }
+    emit peerChanged(true);
+
+    peer_readyRead_handler();
+}
+
+void IngestServer::dropPeer(const QString &reason)
+{
+    if (!reason.isEmpty())
+        qWarning() << "Ingest: drop connection:" << reason;
+    releasePeer();
+    buffer.clear();
+    dwordsLeft = 0;
+}
+
+void IngestServer::releasePeer()
+{
+    if (peer) {
+        peer->disconnect(this);
+        peer->close();
+        peer->deleteLater();
+        peer = nullptr;
+        emit peerChanged(false);
+    }
+}
+
+void IngestServer::peer_readyRead_handler()
+{
+    readPeer();
+}
+
+void IngestServer::retryTimer_timeout_handler()
+{
+    // 环形缓冲区腾出空间后继续读取之前留在连接中的数据
+    processBuffer();
+    readPeer();
+}
+
+void IngestServer::readPeer()
+{
+    // 环形缓冲区满时重试定时器处于等待状态，数据留在连接中
+    while (peer && !retryTimer->isActive()) {
+        qint64 room = kMaxBufferBytes - buffer.size();
+        if ((room <= 0) || (peer->bytesAvailable() <= 0))
+            break;
+        buffer.append(peer->read(room));
+        processBuffer();
+    }
+}
+
+void IngestServer::peer_disconnected_handler()
+{
+    // 断开前收到的数据仍然写入缓冲区，环形缓冲区满时由重试定时器继续写入
+    if (peer)
+        buffer.append(peer->readAll());
+    releasePeer();
+    processBuffer();
+}
+
+void IngestServer::processBuffer()
+{
+    const uchar *data = reinterpret_cast<const uchar *>(buffer.constData());
+    int size = buffer.size();
+    int pos = 0;
+    uint32_t chunk[kPushChunk];
+
+    while (true) {
+        if (dwordsLeft == 0) {
+            // 解析帧头
+            if (size - pos < kFrameHeaderSize)
+                break;
+            quint32 magic = qFromLittleEndian<quint32>(data + pos);
+            quint16 idLength = qFromLittleEndian<quint16>(data + pos + 4);
+            quint32 dwordCount = qFromLittleEndian<quint32>(data + pos + 8);
+            if ((magic != kFrameMagic) || (dwordCount > kMaxFrameDwords)) {
+                dropPeer(tr("invalid frame header"));
+                return;
+            }
+            if (size - pos < kFrameHeaderSize + idLength)
+                break;
+
+            QString templateId = QString::fromUtf8(buffer.constData() + pos + kFrameHeaderSize, idLength);
+            if (!hasTemplate || (templateId != activeTemplateId)) {
+                // 先写入模板切换记录，再写入数据，消费者看到数据时一定能看到切换记录
+                IngestTemplateSwitch record = {mDwordRing.writePosition(), templateId};
+                if (mSwitchRing.push(&record, 1) == 0) {
+                    retryTimer->start();
+                    break;
+                }
+                hasTemplate = true;
+                activeTemplateId = templateId;
+            }
+            pos += kFrameHeaderSize + idLength;
+            dwordsLeft = dwordCount;
+            continue;
+        }
+
+        int avail = qMin<qint64>(dwordsLeft, (size - pos) / 4);
+        if (avail == 0)
+            break;
+
+        int count = qMin(avail, kPushChunk);
+        for (int i = 0; i < count; i++)
+            chunk[i] = qFromLittleEndian<quint32>(data + pos + i * 4);
+        int written = mDwordRing.push(chunk, count);
+        pos += written * 4;
+        dwordsLeft -= written;
+        if (written < count) {
+            // 缓冲区已满，等待界面线程取走数据
+            retryTimer->start();
+            break;
+        }
+    }
+
+    buffer.remove(0, pos);
+}
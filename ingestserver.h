@@ -0,0 +1,83 @@
+#ifndef INGESTSERVER_H
+#define INGESTSERVER_H
+
+#include <QObject>
+#include <QLocalServer>
+#include <QTcpServer>
+#include <QTimer>
+#include "spscring.h"
+
+// 模板切换记录：从 position 开始的 DWORD 使用 templateId 对应的模板解析
+struct IngestTemplateSwitch
+{
+    quint64 position;
+    QString templateId;
+};
+
+// 描述符流接收服务
+// 在独立线程中监听本地套接字和本机 TCP 端口，按帧解析后写入无锁环形缓冲区，
+// 由界面线程取出解析显示。
+//
+// 帧格式（小端序）：
+//   uint32 magic         "SPDF" (0x46445053)
+//   uint16 idLength      模板 ID 字节数，0 表示使用当前选中的模板
+//   uint16 reserved
+//   uint32 dwordCount
+//   char   templateId[idLength]   UTF-8，模板目录下的相对路径
+//   uint32 dwords[dwordCount]
+class IngestServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const quint32 kFrameMagic = 0x46445053;
+
+    explicit IngestServer(QObject *parent = nullptr);
+    ~IngestServer();
+
+    SpscRing<uint32_t> &dwordRing() { return mDwordRing; }
+    SpscRing<IngestTemplateSwitch> &switchRing() { return mSwitchRing; }
+    // 环形缓冲区在开始监听时分配，停止并取完剩余数据后由界面线程释放
+    void releaseRings();
+
+public slots:
+    // 以下槽函数在服务线程中执行
+    void start(const QString &socketName, int tcpPort);
+    void stop();
+
+signals:
+    void started(const QString &description);
+    void failed(const QString &error);
+    void peerChanged(bool connected);
+
+private slots:
+    void newLocalConnection();
+    void newTcpConnection();
+    void peer_readyRead_handler();
+    void peer_disconnected_handler();
+    void retryTimer_timeout_handler();
+
+private:
+    // 在待解析数据不超过上限的前提下从连接读取并解析
+    void readPeer();
+    void acceptPeer(QIODevice *device);
+    void processBuffer();
+    void dropPeer(const QString &reason);
+    void releasePeer();
+
+    QLocalServer *localServer;
+    QTcpServer *tcpServer;
+    QIODevice *peer;
+    // 环形缓冲区满时稍后重试，期间不从连接读取
+    QTimer *retryTimer;
+
+    QByteArray buffer;
+    quint32 dwordsLeft;
+    bool hasTemplate;
+    QString activeTemplateId;
+
+    SpscRing<uint32_t> mDwordRing;
+    SpscRing<IngestTemplateSwitch> mSwitchRing;
+};
+
+#endif // INGESTSERVER_H
@@ -0,0 +1,464 @@
+#include <algorithm>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QScopedPointer>
+#include <QSet>
+#include <QTemporaryDir>
+#include <QXmlStreamReader>
+#include "ipxactimporter.h"
+
+// 寄存器数组展开的元素数上限，防止错误的 dim 生成过大的寄存器映射
+static const quint64 kMaxInstances = 1 << 20;
+
+static bool isElement(const QXmlStreamReader &xml, const char *name)
+{
+    return xml.name() == QLatin1String(name);
+}
+
+// 模板文件名只保留字母、数字和 "_.-"
+static QString fileNameOf(const QString &name)
+{
+    QString result = name.trimmed();
+    for (int i = 0; i < result.size(); i++) {
+        QChar c = result.at(i);
+        if (!c.isLetterOrNumber() && (c != '_') && (c != '.') && (c != '-'))
+            result[i] = '_';
+    }
+    return result;
+}
+
+IpxactImporter::IpxactImporter()
+    : mBlocks(0)
+    , mRenamedBlocks(0)
+    , mRegisters(0)
+    , mSkippedFields(0)
+    , cancelled(false)
+    , total(0)
+    , done(0)
+{
+}
+
+bool IpxactImporter::parseNumber(const QString &text, quint64 *value)
+{
+    QString digits = text.trimmed().remove('_');
+    int base = 10;
+    int tick = digits.indexOf('\'');
+    if (tick >= 0) {
+        // Verilog 形式，位宽忽略，可带表示有符号的 s
+        int pos = tick + 1;
+        if ((pos < digits.size()) && (digits.at(pos).toLower() == 's'))
+            pos++;
+        if (pos >= digits.size())
+            return false;
+        switch (digits.at(pos).toLower().toLatin1()) {
+        case 'h':
+            base = 16;
+            break;
+        case 'd':
+            base = 10;
+            break;
+        case 'o':
+            base = 8;
+            break;
+        case 'b':
+            base = 2;
+            break;
+        default:
+            return false;
+        }
+        digits = digits.mid(pos + 1);
+    } else if (digits.startsWith("0x", Qt::CaseInsensitive)) {
+        base = 16;
+        digits = digits.mid(2);
+    }
+
+    bool ok = false;
+    *value = digits.toULongLong(&ok, base);
+    return ok;
+}
+
+bool IpxactImporter::import(const QString &xmlPath, const QString &templateRoot, const QString &outDir, QString *error)
+{
+    QFile file(xmlPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    if (!QDir(outDir).mkpath(".")) {
+        if (error)
+            *error = QObject::tr("Cannot create %1").arg(outDir);
+        return false;
+    }
+
+    // 模板目录被界面监视，临时目录放在它的上一级，与目标在同一文件系统上便于直接改名
+    // 上一级不可写时使用系统临时目录，移动时退回复制
+    QScopedPointer<QTemporaryDir> stage(new QTemporaryDir(QFileInfo(QDir(templateRoot).absolutePath()).absolutePath() + "/.ipxact-import-XXXXXX"));
+    if (!stage->isValid())
+        stage.reset(new QTemporaryDir());
+    if (!stage->isValid()) {
+        if (error)
+            *error = QObject::tr("Cannot create a temporary directory: %1").arg(stage->errorString());
+        return false;
+    }
+
+    mRoot = templateRoot;
+    mOutDir = outDir;
+    mStageDir = stage->path();
+    mBlockDirs.clear();
+    mBlocks = 0;
+    mRenamedBlocks = 0;
+    mRegisters = 0;
+    mSkippedFields = 0;
+    total = file.size();
+    done = 0;
+
+    QXmlStreamReader xml(&file);
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (xml.isStartElement() && isElement(xml, "addressBlock")) {
+            if (!parseBlock(xml, error))
+                return false;
+        }
+    }
+    if (xml.hasError()) {
+        if (error)
+            *error = QObject::tr("Line %1: %2").arg(xml.lineNumber()).arg(xml.errorString());
+        return false;
+    }
+    if (mBlocks == 0) {
+        if (error)
+            *error = QObject::tr("No address blocks found");
+        return false;
+    }
+    if (cancelled) {
+        if (error)
+            *error = QObject::tr("Import cancelled");
+        return false;
+    }
+    if (!moveIntoPlace(error))
+        return false;
+
+    done = total.load();
+    qDebug("%s[%d]: %d blocks (%d renamed), %lld registers, %lld fields skipped", __func__, __LINE__,
+           mBlocks, mRenamedBlocks, mRegisters, mSkippedFields);
+    return true;
+}
+
+bool IpxactImporter::parseBlock(QXmlStreamReader &xml, QString *error)
+{
+    QString name;
+    quint64 base = 0;
+    QVector<Register> regs;
+    while (xml.readNextStartElement()) {
+        if (cancelled) {
+            if (error)
+                *error = QObject::tr("Import cancelled");
+            return false;
+        }
+        if (isElement(xml, "name"))
+            name = xml.readElementText();
+        else if (isElement(xml, "baseAddress"))
+            parseNumber(xml.readElementText(), &base);
+        else if (isElement(xml, "register"))
+            parseRegister(xml, regs);
+        else if (isElement(xml, "registerFile"))
+            parseRegisterFile(xml, regs);
+        else
+            xml.skipCurrentElement();
+    }
+    if (xml.hasError())
+        return true;
+
+    if (name.isEmpty())
+        name = QString("block%1").arg(mBlocks);
+    mBlocks++;
+    return writeBlock(name, base, regs, error);
+}
+
+void IpxactImporter::parseRegisterFile(QXmlStreamReader &xml, QVector<Register> &regs)
+{
+    QString name;
+    quint64 offset = 0;
+    quint64 dim = 1;
+    quint64 range = 0;
+    QVector<Register> inner;
+    while (xml.readNextStartElement()) {
+        quint64 value;
+        if (isElement(xml, "name")) {
+            name = xml.readElementText();
+        } else if (isElement(xml, "addressOffset")) {
+            parseNumber(xml.readElementText(), &offset);
+        } else if (isElement(xml, "dim")) {
+            // 多维数组按行优先展开
+            if (parseNumber(xml.readElementText(), &value) && (value > 0))
+                dim = qMin(dim * qMin(value, kMaxInstances), kMaxInstances);
+        } else if (isElement(xml, "range")) {
+            parseNumber(xml.readElementText(), &range);
+        } else if (isElement(xml, "register")) {
+            parseRegister(xml, inner);
+        } else if (isElement(xml, "registerFile")) {
+            parseRegisterFile(xml, inner);
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+
+    // 寄存器名称加上 registerFile 名称，数组的各元素共用模板
+    QString filePrefix = name.isEmpty() ? QString() : name + '_';
+    for (Register &reg : inner) {
+        QVector<quint64> offsets;
+        for (quint64 i = 0; (i < dim) && (quint64(offsets.size()) < kMaxInstances); i++) {
+            for (quint64 regOffset : reg.offsets)
+                offsets.push_back(offset + i * range + regOffset);
+        }
+        reg.name = filePrefix + reg.name;
+        reg.offsets = offsets;
+        regs.push_back(reg);
+    }
+}
+
+void IpxactImporter::parseRegister(QXmlStreamReader &xml, QVector<Register> &regs)
+{
+    Register reg;
+    quint64 offset = 0;
+    quint64 dim = 1;
+    while (xml.readNextStartElement()) {
+        quint64 value;
+        if (isElement(xml, "name")) {
+            reg.name = xml.readElementText();
+        } else if (isElement(xml, "addressOffset")) {
+            parseNumber(xml.readElementText(), &offset);
+        } else if (isElement(xml, "size")) {
+            if (parseNumber(xml.readElementText(), &value) && (value > 0) && (value <= 1024))
+                reg.size = static_cast<int>(value);
+        } else if (isElement(xml, "dim")) {
+            if (parseNumber(xml.readElementText(), &value) && (value > 0))
+                dim = qMin(dim * qMin(value, kMaxInstances), kMaxInstances);
+        } else if (isElement(xml, "field")) {
+            Field field;
+            parseField(xml, &field);
+            reg.fields.push_back(field);
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+
+    // 寄存器数组的元素连续排列
+    quint64 stride = (reg.size + 7) / 8;
+    for (quint64 i = 0; i < dim; i++)
+        reg.offsets.push_back(offset + i * stride);
+    regs.push_back(reg);
+    mRegisters++;
+    updateProgress(xml);
+}
+
+void IpxactImporter::parseField(QXmlStreamReader &xml, Field *field)
+{
+    quint64 width = 0;
+    bool hasWidth = false;
+    while (xml.readNextStartElement()) {
+        quint64 value;
+        if (isElement(xml, "name")) {
+            field->name = xml.readElementText();
+        } else if (isElement(xml, "bitOffset") || isElement(xml, "lsb")) {
+            if (parseNumber(xml.readElementText(), &value) && (value < 1024))
+                field->lsb = static_cast<int>(value);
+        } else if (isElement(xml, "bitWidth")) {
+            hasWidth = parseNumber(xml.readElementText(), &width) && (width > 0) && (width <= 1024);
+        } else if (isElement(xml, "msb")) {
+            if (parseNumber(xml.readElementText(), &value) && (value < 1024))
+                field->msb = static_cast<int>(value);
+        } else if (isElement(xml, "enumeratedValues")) {
+            field->format = parseEnums(xml);
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+    if (hasWidth && (field->lsb >= 0))
+        field->msb = field->lsb + static_cast<int>(width) - 1;
+}
+
+QJsonValue IpxactImporter::parseEnums(QXmlStreamReader &xml)
+{
+    QJsonObject values;
+    while (xml.readNextStartElement()) {
+        if (!isElement(xml, "enumeratedValue")) {
+            xml.skipCurrentElement();
+            continue;
+        }
+
+        QString name;
+        quint64 value = 0;
+        bool hasValue = false;
+        while (xml.readNextStartElement()) {
+            if (isElement(xml, "name"))
+                name = xml.readElementText();
+            else if (isElement(xml, "value"))
+                hasValue = parseNumber(xml.readElementText(), &value);
+            else
+                xml.skipCurrentElement();
+        }
+        if (hasValue && !name.isEmpty())
+            values[QString::number(value)] = name;
+    }
+
+    if (values.isEmpty())
+        return QJsonValue();
+    QJsonObject format;
+    format["type"] = "enum";
+    format["values"] = values;
+    return format;
+}
+
+QJsonArray IpxactImporter::registerTemplate(const Register &reg)
+{
+    int dwCount = qMax(1, (reg.size + 31) / 32);
+    QVector<QVector<QPair<int, QJsonObject>>> dwords(dwCount);
+    for (const Field &field : reg.fields) {
+        if (field.name.isEmpty() || (field.lsb < 0) || (field.msb < field.lsb) || (field.msb >= dwCount * 32)) {
+            mSkippedFields++;
+            continue;
+        }
+
+        int first = field.lsb / 32;
+        int last = field.msb / 32;
+        for (int dw = first; dw <= last; dw++) {
+            QJsonObject obj;
+            obj["field"] = (first == last) ? field.name : QString("%1_%2").arg(field.name).arg(dw - first);
+            obj["LSB"] = qMax(field.lsb, dw * 32) - dw * 32;
+            obj["MSB"] = qMin(field.msb, dw * 32 + 31) - dw * 32;
+            // 拆分后的字段不再适用原来的枚举
+            if ((first == last) && !field.format.isNull())
+                obj["format"] = field.format;
+            dwords[dw].push_back(qMakePair(obj["LSB"].toInt(), obj));
+        }
+    }
+
+    QJsonArray desc;
+    for (QVector<QPair<int, QJsonObject>> &fields : dwords) {
+        std::sort(fields.begin(), fields.end(), [](const QPair<int, QJsonObject> &a, const QPair<int, QJsonObject> &b) {
+            return a.first < b.first;
+        });
+        QJsonArray dword;
+        for (const QPair<int, QJsonObject> &field : fields)
+            dword.push_back(field.second);
+        desc.push_back(dword);
+    }
+    return desc;
+}
+
+bool IpxactImporter::writeBlock(const QString &blockName, quint64 baseAddress, const QVector<Register> &regs, QString *error)
+{
+    // 同名的地址块加上基地址区分，仍然重复时再加序号
+    QString dirName = fileNameOf(blockName);
+    if (mBlockDirs.contains(dirName)) {
+        QString unique = dirName + QString::asprintf("_%llx", baseAddress);
+        for (int i = 1; mBlockDirs.contains(unique); i++)
+            unique = dirName + QString::asprintf("_%llx_%d", baseAddress, i);
+        qWarning("%s[%d]: duplicate address block %s renamed to %s", __func__, __LINE__,
+                 qPrintable(blockName), qPrintable(unique));
+        dirName = unique;
+        mRenamedBlocks++;
+    }
+    mBlockDirs.insert(dirName);
+
+    QDir dir(mStageDir);
+    if (!dir.mkpath(dirName) || !dir.cd(dirName)) {
+        if (error)
+            *error = QObject::tr("Cannot create %1").arg(dir.absoluteFilePath(dirName));
+        return false;
+    }
+
+    QDir root(mRoot);
+    QSet<QString> usedNames;
+    QSet<quint64> usedAddresses;
+    QJsonArray entries;
+    for (const Register &reg : regs) {
+        // 同名寄存器加上偏移区分
+        QString fileName = fileNameOf(reg.name.isEmpty() ? QString("reg") : reg.name);
+        if (usedNames.contains(fileName) && !reg.offsets.isEmpty())
+            fileName += QString::asprintf("_%llx", reg.offsets.first());
+        usedNames.insert(fileName);
+
+        QString path = dir.absoluteFilePath(fileName + ".json");
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            if (error)
+                *error = QObject::tr("Cannot write %1: %2").arg(path, file.errorString());
+            return false;
+        }
+        file.write(QJsonDocument(registerTemplate(reg)).toJson());
+        file.close();
+
+        // 寄存器映射只能使用单个 DW 的模板，地址重复的别名寄存器只保留第一个
+        if (reg.size > 32)
+            continue;
+        // 模板名称对应移入 outDir 后的位置
+        QString templateName = root.relativeFilePath(QDir(mOutDir).absoluteFilePath(dirName + '/' + fileName + ".json"));
+        for (int i = 0; i < reg.offsets.size(); i++) {
+            quint64 address = baseAddress + reg.offsets.at(i);
+            if (usedAddresses.contains(address))
+                continue;
+            usedAddresses.insert(address);
+            QJsonObject entry;
+            entry["address"] = QString::asprintf("0x%llx", address);
+            entry["template"] = templateName;
+            entry["name"] = (reg.offsets.size() > 1) ? QString("%1[%2]").arg(reg.name).arg(i) : reg.name;
+            entries.push_back(entry);
+        }
+    }
+
+    if (entries.isEmpty())
+        return true;
+    QJsonObject map;
+    map["registers"] = entries;
+    QFile mapFile(dir.absoluteFilePath("registers.regmap"));
+    if (!mapFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error)
+            *error = QObject::tr("Cannot write %1: %2").arg(mapFile.fileName(), mapFile.errorString());
+        return false;
+    }
+    mapFile.write(QJsonDocument(map).toJson());
+    return true;
+}
+
+bool IpxactImporter::moveIntoPlace(QString *error)
+{
+    QDir outDir(mOutDir);
+    for (const QString &dirName : mBlockDirs) {
+        QDir from(QDir(mStageDir).absoluteFilePath(dirName));
+        if (!from.exists())
+            continue;
+        if (!outDir.mkpath(dirName)) {
+            if (error)
+                *error = QObject::tr("Cannot create %1").arg(outDir.absoluteFilePath(dirName));
+            return false;
+        }
+        QDir to(outDir.absoluteFilePath(dirName));
+        for (const QString &fileName : from.entryList(QDir::Files)) {
+            QString source = from.absoluteFilePath(fileName);
+            QString target = to.absoluteFilePath(fileName);
+            // 覆盖上次导入的同名文件，不在同一文件系统上时改名失败，退回复制
+            QFile::remove(target);
+            if (!QFile::rename(source, target) && !QFile::copy(source, target)) {
+                if (error)
+                    *error = QObject::tr("Cannot write %1").arg(target);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void IpxactImporter::updateProgress(const QXmlStreamReader &xml)
+{
+    if (xml.device())
+        done = xml.device()->pos();
+}
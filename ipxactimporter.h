@@ -0,0 +1,90 @@
+#ifndef IPXACTIMPORTER_H
+#define IPXACTIMPORTER_H
+
+#include <atomic>
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+class QXmlStreamReader;
+
+// IP-XACT 寄存器描述导入
+// 用 QXmlStreamReader 顺序读取，不建立 DOM，只按元素的本地名称识别，兼容 spirit: / ipxact: 等命名空间：
+//   addressBlock (name, baseAddress) > registerFile (name, addressOffset, dim)* > register
+//   register (name, addressOffset, size, dim) > field (name, bitOffset, bitWidth 或 lsb, msb)
+//   field > enumeratedValues > enumeratedValue (name, value)，转换为 enum 显示格式
+// 每个寄存器生成一个模板，保存为 outDir/<地址块>/<寄存器>.json，字段在 DW 内按 LSB 升序排列；
+// 超过 32 位的寄存器按 DW 拆分，跨 DW 的字段拆为 <名称>_0、<名称>_1 …
+// 每个地址块同时生成寄存器映射 outDir/<地址块>/registers.regmap，见 RegisterMap。
+// 同名的地址块加上基地址区分。
+// 先写入模板目录外的临时目录，全部成功后才移入 outDir，失败或取消时模板目录不变。
+// import() 在调用线程中执行，界面通过 QtConcurrent 在后台线程调用，期间可以查询进度或取消。
+class IpxactImporter
+{
+public:
+    IpxactImporter();
+
+    // templateRoot 为模板目录，寄存器映射中的模板名称相对于它
+    bool import(const QString &xmlPath, const QString &templateRoot, const QString &outDir, QString *error = nullptr);
+    void cancel() { cancelled = true; }
+    bool isCancelled() const { return cancelled; }
+    qint64 totalBytes() const { return total; }
+    qint64 readBytes() const { return done; }
+
+    int blockCount() const { return mBlocks; }
+    // 因重名而改名的地址块
+    int renamedBlocks() const { return mRenamedBlocks; }
+    qint64 registerCount() const { return mRegisters; }
+    // 位置或位宽无法解析（如引用参数）的字段
+    qint64 skippedFields() const { return mSkippedFields; }
+
+    // 数字可以是十进制、0x 开头的十六进制或 Verilog 形式（'h1f、32'h1f、'd10、'b101）
+    static bool parseNumber(const QString &text, quint64 *value);
+
+private:
+    struct Field
+    {
+        QString name;
+        int lsb = -1;
+        int msb = -1;
+        QJsonValue format;
+    };
+
+    struct Register
+    {
+        QString name;
+        // 相对于地址块的偏移，寄存器数组的每个元素一项
+        QVector<quint64> offsets;
+        int size = 32;
+        QVector<Field> fields;
+    };
+
+    bool parseBlock(QXmlStreamReader &xml, QString *error);
+    // 读取的寄存器追加到 regs，偏移相对于所在的 addressBlock 或 registerFile
+    void parseRegisterFile(QXmlStreamReader &xml, QVector<Register> &regs);
+    void parseRegister(QXmlStreamReader &xml, QVector<Register> &regs);
+    void parseField(QXmlStreamReader &xml, Field *field);
+    QJsonValue parseEnums(QXmlStreamReader &xml);
+    bool writeBlock(const QString &blockName, quint64 baseAddress, const QVector<Register> &regs, QString *error);
+    // 把临时目录中的地址块目录移入 outDir，覆盖同名文件
+    bool moveIntoPlace(QString *error);
+    QJsonArray registerTemplate(const Register &reg);
+    void updateProgress(const QXmlStreamReader &xml);
+
+    QString mRoot;
+    QString mOutDir;
+    // 写入的临时目录
+    QString mStageDir;
+    QSet<QString> mBlockDirs;
+    int mBlocks;
+    int mRenamedBlocks;
+    qint64 mRegisters;
+    qint64 mSkippedFields;
+    std::atomic<bool> cancelled;
+    std::atomic<qint64> total;
+    std::atomic<qint64> done;
+};
+
+#endif // IPXACTIMPORTER_H
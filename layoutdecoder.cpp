@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <QDebug>
+#include "layoutdecoder.h"
+
+void LayoutDecoder::setLayout(const DescLayout &layout)
+{
+    mLayout = layout;
+    formatters.clear();
+    widthMasks.clear();
+    derivedExprs.clear();
+    rawInputs.clear();
+
+    QStringList names = mLayout.fieldNames();
+    int rawCount = mLayout.rawFieldCount();
+    for (int f = 0; f < mLayout.fieldCount(); f++) {
+        const DescFieldSpec &spec = mLayout.fields.at(f);
+        FieldFormatter formatter;
+        formatter.compile(spec.format, spec.msb - spec.lsb + 1);
+        formatters.push_back(formatter);
+        widthMasks.push_back(spec.isDerived() ? 0 : DescObj::extractSubfield(0xffffffffu, 0, spec.msb - spec.lsb));
+        if (!spec.isDerived())
+            continue;
+        // 模板加载时已检查过表达式，这里编译失败的字段值为 0
+        QString error;
+        FieldExpr expr;
+        if (!expr.compile(spec.expr, names.mid(0, f), &error))
+            qWarning("%s[%d]: derived field %s: %s", __func__, __LINE__, qPrintable(spec.name), qPrintable(error));
+        for (int input : expr.inputs()) {
+            if ((input < rawCount) && !rawInputs.contains(input))
+                rawInputs.push_back(input);
+        }
+        derivedExprs.push_back(expr);
+    }
+    std::sort(rawInputs.begin(), rawInputs.end());
+}
+
+void LayoutDecoder::decodeGroup(const uint32_t *dwords, QVector<quint64> &values) const
+{
+    int rawCount = mLayout.rawFieldCount();
+    values.resize(mLayout.fieldCount());
+    for (int f = 0; f < rawCount; f++) {
+        const DescFieldSpec &spec = mLayout.fields.at(f);
+        values[f] = DescObj::extractSubfield(dwords[spec.dwIdx], spec.lsb, spec.msb);
+    }
+
+    QVector<const quint64 *> columns(values.size());
+    QVector<quint64 *> out(derivedExprs.size());
+    for (int f = 0; f < rawCount; f++)
+        columns[f] = values.constData() + f;
+    for (int d = 0; d < out.size(); d++)
+        out[d] = values.data() + rawCount + d;
+    evaluateDerived(columns, 1, out);
+}
+
+void LayoutDecoder::decodeColumns(const uint32_t *dwords, int stride, int count, QVector<QVector<quint64>> &columns) const
+{
+    int rawCount = mLayout.rawFieldCount();
+    columns.resize(mLayout.fieldCount());
+    for (QVector<quint64> &column : columns)
+        column.resize(count);
+    for (int f = 0; f < rawCount; f++) {
+        const DescFieldSpec &spec = mLayout.fields.at(f);
+        quint64 *column = columns[f].data();
+        for (int i = 0; i < count; i++)
+            column[i] = DescObj::extractSubfield(dwords[i * stride + spec.dwIdx], spec.lsb, spec.msb);
+    }
+
+    // 派生字段整块按列计算
+    QVector<const quint64 *> inputs(columns.size());
+    QVector<quint64 *> out(derivedExprs.size());
+    for (int f = 0; f < rawCount; f++)
+        inputs[f] = columns.at(f).constData();
+    for (int d = 0; d < out.size(); d++)
+        out[d] = columns[rawCount + d].data();
+    evaluateDerived(inputs, count, out);
+}
+
+void LayoutDecoder::evaluateDerived(QVector<const quint64 *> &columns, int count, const QVector<quint64 *> &out) const
+{
+    int rawCount = mLayout.rawFieldCount();
+    for (int d = 0; d < derivedExprs.size(); d++) {
+        if (derivedExprs.at(d).isValid())
+            derivedExprs.at(d).evaluate(columns, count, out.at(d));
+        else
+            std::fill(out.at(d), out.at(d) + count, 0);
+        columns[rawCount + d] = out.at(d);
+    }
+}
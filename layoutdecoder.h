@@ -0,0 +1,43 @@
+#ifndef LAYOUTDECODER_H
+#define LAYOUTDECODER_H
+
+#include <QVector>
+#include "descobj.h"
+#include "fieldexpr.h"
+#include "fieldformatter.h"
+
+// 按模板布局解析数据
+// 设置布局时把各字段的显示格式和派生字段的表达式编译一次，结果表、导出和寄存器解析共用。
+// 设置布局后只读，可以在多个线程中同时解析。
+class LayoutDecoder
+{
+public:
+    LayoutDecoder() {}
+    explicit LayoutDecoder(const DescLayout &layout) { setLayout(layout); }
+
+    void setLayout(const DescLayout &layout);
+    const DescLayout &layout() const { return mLayout; }
+    const FieldFormatter &formatter(int field) const { return formatters.at(field); }
+    // 位字段按位宽生成的掩码，派生字段为 0
+    uint32_t widthMask(int field) const { return widthMasks.at(field); }
+    int derivedCount() const { return derivedExprs.size(); }
+    // 派生字段引用的位字段序号，不重复
+    const QVector<int> &derivedInputs() const { return rawInputs; }
+
+    // 解析一组的全部字段值（含派生字段）
+    void decodeGroup(const uint32_t *dwords, QVector<quint64> &values) const;
+    // 解析 dwords 中连续的 count 组，每组 stride 个 DWORD，columns[field][i] 为第 i 组的字段值
+    void decodeColumns(const uint32_t *dwords, int stride, int count, QVector<QVector<quint64>> &columns) const;
+    // 按列计算派生字段：columns 至少提供 derivedInputs() 中位字段的 count 个值，
+    // 第 d 个派生字段写入 out[d]，同时填入 columns 供后面的派生字段引用；无效的表达式结果为 0
+    void evaluateDerived(QVector<const quint64 *> &columns, int count, const QVector<quint64 *> &out) const;
+
+private:
+    DescLayout mLayout;
+    QVector<FieldFormatter> formatters;
+    QVector<uint32_t> widthMasks;
+    QVector<FieldExpr> derivedExprs;
+    QVector<int> rawInputs;
+};
+
+#endif // LAYOUTDECODER_H
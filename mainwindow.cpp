@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <atomic>
+#include <climits>
 #include <QCoreApplication>
 #include <QProcessEnvironment>
 #include <QJsonArray>
@@ -5,6 +8,22 @@
 #include <QDebug>
 #include <QMessageBox>
 #include <QStyledItemDelegate>
+#include <QScrollBar>
+#include <QPainter>
+#include <QApplication>
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QInputDialog>
+#include <QRegularExpression>
+#include <QClipboard>
+#include "backgroundtask.h"
+#include "diffwindow.h"
+#include "registertracewindow.h"
+#include "uniquegroupswindow.h"
+#include "signaturesearchwindow.h"
+#include "resultexporter.h"
+#include "sessionfile.h"
 #include "mainwindow.h"
 
 // 自定义表格样式委托
@@ -14,6 +33,7 @@ public:
     explicit CustomStyleDelegate(QObject *parent = nullptr) : QStyledItemDelegate(parent) {}
 
     void initStyleOption(QStyleOptionViewItem *option, const QModelIndex &index) const override;
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
 };
 
 void CustomStyleDelegate::initStyleOption(QStyleOptionViewItem *option, const QModelIndex &index) const
@@ -39,17 +59,71 @@ void CustomStyleDelegate::initStyleOption(QStyleOptionViewItem *option, const QM
     }
 }
 
+void CustomStyleDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    // 差异视图的二进制列，逐位绘制并高亮变化的位
+    QVariant changed = index.data(ResultModel::ChangedMaskRole);
+    if (!changed.isValid()) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    QString bits = opt.text;
+    opt.text.clear();
+    const QWidget *widget = opt.widget;
+    QStyle *style = widget ? widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+
+    uint32_t mask = changed.toUInt();
+    QFont boldFont = opt.font;
+    boldFont.setBold(true);
+    QFontMetrics metrics(boldFont);
+    QRect textRect = style->subElementRect(QStyle::SE_ItemViewItemText, &opt, widget);
+    int x = textRect.left();
+
+    painter->save();
+    for (int i = 0; i < bits.size(); i++) {
+        int bit = bits.size() - 1 - i;
+        bool hit = (bit < 32) && ((mask >> bit) & 1);
+        painter->setFont(hit ? boldFont : opt.font);
+        painter->setPen(hit ? QColor(Qt::red) : opt.palette.color(QPalette::Text));
+        int width = metrics.horizontalAdvance(bits.at(i));
+        painter->drawText(QRect(x, textRect.top(), width, textRect.height()), Qt::AlignCenter, bits.at(i));
+        x += width;
+    }
+    painter->restore();
+}
+
+// 解析 "秒.小数" 格式的时间
+static bool parseTimeText(const QString &text, qint64 *ns)
+{
+    QByteArray bytes = text.trimmed().toLatin1();
+    const char *stop = nullptr;
+    return TimeIndex::parseSeconds(bytes.constData(), bytes.constData() + bytes.size(), ns, &stop)
+            && (stop == bytes.constData() + bytes.size());
+}
+
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
-    , descList()
-    , groupStartRows()
-    , model(new QStandardItemModel(0, 3, this))
+    , store()
+    , model(new ResultModel(&store, this))
+    , follower(new FileFollower(this))
+    , ingestServer(new IngestServer)
+    , ingestDiscard(false)
 {
     // 获取环境变量
     QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
     templatesPath = env.value("TEMPLATE_PATH");
     qDebug() << "APP root path: " << templatesPath;
+    // 数据流接收地址
+    ingestSocketName = env.value("SP_INGEST_SOCKET", "superpaser");
+    ingestPort = env.value("SP_INGEST_PORT", "5577").toInt();
+    // 持续抓取时的数据保留上限：最近 N 组或最近 X MB
+    streamRetention.maxGroups = env.value("SP_RETAIN_GROUPS").toLongLong();
+    streamRetention.maxBytes = env.value("SP_RETAIN_MB", "1024").toLongLong() * 1024 * 1024;
 #ifdef Q_OS_WIN
     setWindowIcon(QIcon(":/icons/images/endless.ico"));
 #elif defined(Q_OS_LINUX)
@@ -81,120 +155,1032 @@ MainWindow::MainWindow(QWidget *parent)
     updateResultTimer.setSingleShot(true);
     updateResultTimer.setInterval(50);  // 50ms更新一次UI
     isUpdating = false;
+    resizeColumnsPending = true;
+    connect(model, &ResultModel::modelReset, this, [this]() { resizeColumnsPending = true; });
+    connect(model, &ResultModel::columnsInserted, this, [this]() { resizeColumnsPending = true; });
     // 连续多组解析
     multiGroup = false;
+    rowLimitWarned = false;
     // 连接信号与槽
     connect(tmpMgmtWin, &TmpMgmtWin::tempSelected, structViewWin, &StructViewWin::tempMgmt_tempSelected_handler);
     connect(ui->resultTable, &TableView::clicked, this, &MainWindow::result_rowSelected_handler);
+    connect(ui->resultTable, &TableView::largeCopyRequested, this, &MainWindow::result_largeCopyRequested_handler);
+    connect(structViewWin, &StructViewWin::fieldClicked, this, &MainWindow::structView_fieldClicked_handler);
+    // 结果表右键菜单：差异视图
+    QAction *deltaAction = new QAction(tr("Delta View"), this);
+    deltaAction->setCheckable(true);
+    ui->resultTable->addMenuAction(deltaAction);
+    connect(deltaAction, &QAction::toggled, this, [this](bool checked) {
+        model->setDeltaMode(checked);
+        model->syncGroups();
+        ui->resultTable->resizeColumnsToContents();
+        if (checked && model->isPreview())
+            ui->statusbar->showMessage(tr("Delta view is shown after full decoding completes"), 3000);
+    });
+    // 结果表右键菜单：与另一份抓取文件比较
+    QAction *diffAction = new QAction(tr("Diff Against File..."), this);
+    ui->resultTable->addMenuAction(diffAction);
+    connect(diffAction, &QAction::triggered, this, &MainWindow::diffAction_triggered_handler);
+    // 结果表右键菜单：合并重复的描述符
+    QAction *uniqueAction = new QAction(tr("Unique Groups..."), this);
+    ui->resultTable->addMenuAction(uniqueAction);
+    connect(uniqueAction, &QAction::triggered, this, &MainWindow::uniqueAction_triggered_handler);
+    // 结果表右键菜单：在原始数据中查找描述符特征
+    QAction *searchAction = new QAction(tr("Signature Search..."), this);
+    ui->resultTable->addMenuAction(searchAction);
+    connect(searchAction, &QAction::triggered, this, &MainWindow::searchAction_triggered_handler);
+    // 结果表右键菜单：批量修改字段，复制选中组的 DWORD
+    QAction *setFieldAction = new QAction(tr("Set Field in Selected Groups..."), this);
+    ui->resultTable->addMenuAction(setFieldAction);
+    connect(setFieldAction, &QAction::triggered, this, &MainWindow::setFieldAction_triggered_handler);
+    QAction *copyDwordsAction = new QAction(tr("Copy Groups as DWORDs"), this);
+    ui->resultTable->addMenuAction(copyDwordsAction);
+    connect(copyDwordsAction, &QAction::triggered, this, &MainWindow::copyDwordsAction_triggered_handler);
+    // 结果表右键菜单：导出解析结果
+    QAction *exportAction = new QAction(tr("Export..."), this);
+    ui->resultTable->addMenuAction(exportAction);
+    connect(exportAction, &QAction::triggered, this, &MainWindow::exportAction_triggered_handler);
+    // 结果表右键菜单：保存会话，通过数据输入窗口的 Open... 重新打开
+    QAction *saveSessionAction = new QAction(tr("Save Session..."), this);
+    ui->resultTable->addMenuAction(saveSessionAction);
+    connect(saveSessionAction, &QAction::triggered, this, &MainWindow::saveSessionAction_triggered_handler);
+    // 结果表右键菜单：按行首时间戳跳转和筛选
+    QAction *gotoTimeAction = new QAction(tr("Go to Time..."), this);
+    ui->resultTable->addMenuAction(gotoTimeAction);
+    connect(gotoTimeAction, &QAction::triggered, this, &MainWindow::gotoTimeAction_triggered_handler);
+    QAction *timeFilterAction = new QAction(tr("Filter by Time..."), this);
+    ui->resultTable->addMenuAction(timeFilterAction);
+    connect(timeFilterAction, &QAction::triggered, this, &MainWindow::timeFilterAction_triggered_handler);
+    // 结果表右键菜单：行数超过表格上限时分段查看
+    QAction *showGroupsAction = new QAction(tr("Show Groups..."), this);
+    ui->resultTable->addMenuAction(showGroupsAction);
+    connect(showGroupsAction, &QAction::triggered, this, &MainWindow::showGroupsAction_triggered_handler);
+    // 结果表右键菜单：按之前的模板查看数据流中切换模板前的数据
+    QAction *streamSegmentsAction = new QAction(tr("Stream Segments..."), this);
+    ui->resultTable->addMenuAction(streamSegmentsAction);
+    connect(streamSegmentsAction, &QAction::triggered, this, &MainWindow::streamSegmentsAction_triggered_handler);
+    // 主菜单：寄存器访问记录与结果表无关
+    QAction *registerTraceAction = new QAction(tr("Decode Register Trace..."), this);
+    ui->toolsMenu->addAction(registerTraceAction);
+    connect(registerTraceAction, &QAction::triggered, this, &MainWindow::registerTraceAction_triggered_handler);
+    // F3/Shift+F3 跳转到下一组/上一组的同一字段
+    nextFieldShortcut = new QShortcut(QKeySequence::FindNext, this);
+    prevFieldShortcut = new QShortcut(QKeySequence::FindPrevious, this);
+    connect(nextFieldShortcut, &QShortcut::activated, this, &MainWindow::nextFieldShortcut_activated_handler);
+    connect(prevFieldShortcut, &QShortcut::activated, this, &MainWindow::prevFieldShortcut_activated_handler);
     connect(tmpMgmtWin, &TmpMgmtWin::tempSelected, dataInputWin, &DataInputWin::tempMgmt_tempSelected_handler);
     connect(&updateResultTimer, &QTimer::timeout, this, &MainWindow::batchUpdateResult);
     connect(dataInputWin, &DataInputWin::multiGroupChecked, this, [this](bool checked) {
         multiGroup = checked;
+        model->setMultiGroup(checked);
+        model->syncGroups();
     });
     connect(dataInputWin, &DataInputWin::requestToClear, this, &MainWindow::common_clearDisplay_handler);
-    connect(dataInputWin, &DataInputWin::appendOneGroup, this, &MainWindow::dataInput_appendOneGroup_handler);
+    connect(dataInputWin, &DataInputWin::dwordsSubmitted, this, &MainWindow::dataInput_dwordsSubmitted_handler);
+    connect(dataInputWin, &DataInputWin::previewSubmitted, this, &MainWindow::dataInput_previewSubmitted_handler);
+    connect(dataInputWin, &DataInputWin::parseProgress, this, &MainWindow::dataInput_parseProgress_handler);
+    connect(dataInputWin, &DataInputWin::dumpFileOpened, this, &MainWindow::dataInput_dumpFileOpened_handler);
+    connect(dataInputWin, &DataInputWin::sessionOpenRequested, this, &MainWindow::dataInput_sessionOpenRequested_handler);
+    connect(dataInputWin, &DataInputWin::followFileRequested, this, &MainWindow::dataInput_followFileRequested_handler);
+    connect(dataInputWin, &DataInputWin::followStopped, this, &MainWindow::dataInput_followStopped_handler);
+    connect(follower, &FileFollower::dwordsAppended, this, &MainWindow::follower_dwordsAppended_handler);
+    connect(follower, &FileFollower::fileTruncated, this, &MainWindow::common_clearDisplay_handler);
+    // 数据流接收服务
+    ingestServer->moveToThread(&ingestThread);
+    ingestThread.start();
+    ingestTimer.setInterval(20);
+    connect(&ingestTimer, &QTimer::timeout, this, &MainWindow::ingestTimer_timeout_handler);
+    connect(dataInputWin, &DataInputWin::listenToggled, this, &MainWindow::dataInput_listenToggled_handler);
+    connect(ingestServer, &IngestServer::started, this, [this](const QString &description) {
+        dataInputWin->setListening(true);
+        ui->statusbar->showMessage(tr("Listening on %1").arg(description));
+        ingestTimer.start();
+    });
+    connect(ingestServer, &IngestServer::failed, this, [this](const QString &error) {
+        dataInputWin->setListening(false);
+        QMessageBox::warning(this, tr("Error"), error);
+    });
+    connect(ingestServer, &IngestServer::peerChanged, this, [this](bool connected) {
+        ui->statusbar->showMessage(connected ? tr("Stream connected") : tr("Stream disconnected"), 3000);
+    });
 }
 
 MainWindow::~MainWindow()
 {
+    QMetaObject::invokeMethod(ingestServer, "stop", Qt::BlockingQueuedConnection);
+    ingestThread.quit();
+    ingestThread.wait();
+    delete ingestServer;
     delete ui;
 }
 
-void MainWindow::dataInput_appendOneGroup_handler(DescFieldList fields)
+void MainWindow::dataInput_dwordsSubmitted_handler(const DescLayout &layout, const QVector<uint32_t> &dwords, const TimeMarks &marks)
+{
+    // 记住预览时视图顶部对应的组，全部解析完成后滚动回同一组
+    qint64 topGroup = -1;
+    int topField = 0;
+    if (model->isPreview()) {
+        int topRow = ui->resultTable->rowAt(0);
+        QModelIndex topIndex = model->index(topRow, 0);
+        if (topIndex.isValid()) {
+            topGroup = topIndex.data(ResultModel::GroupRole).toLongLong();
+            topField = topIndex.data(ResultModel::FieldRole).toInt();
+        }
+    }
+
+    ingestSegments.clear();
+    store.setDwordsPerGroup(layout.dwCount);
+    store.setRetention(ResultStore::Retention());
+    store.setBuffer(dwords, marks);
+    resultDesc = dataInputWin->currentDesc();
+    model->setDescLayout(layout);
+    model->setPreviewStride(1);
+    ui->statusbar->clearMessage();
+
+    if (topGroup >= 0) {
+        model->syncGroups();
+        int row = model->rowOfField(model->groupOfSource(topGroup), topField);
+        if (row >= 0)
+            ui->resultTable->scrollTo(model->index(row, 0), QAbstractItemView::PositionAtTop);
+    }
+
+    if (!updateResultTimer.isActive() && !isUpdating) {
+        updateResultTimer.start();
+    }
+}
+
+void MainWindow::dataInput_previewSubmitted_handler(const DescLayout &layout, const QVector<uint32_t> &dwords, int stride)
+{
+    ingestSegments.clear();
+    store.setDwordsPerGroup(layout.dwCount);
+    store.setRetention(ResultStore::Retention());
+    store.setBuffer(dwords);
+    resultDesc = dataInputWin->currentDesc();
+    model->setDescLayout(layout);
+    model->setPreviewStride(stride);
+    ui->statusbar->showMessage(tr("Preview: showing 1 of every %1 groups, full decoding in progress...").arg(stride));
+
+    // 预览立即显示，不等待定时器
+    batchUpdateResult();
+}
+
+void MainWindow::dataInput_parseProgress_handler(int parsedLines, int totalLines)
+{
+    if (!model->isPreview())
+        return;
+    int percent = (totalLines > 0) ? static_cast<int>(qint64(parsedLines) * 100 / totalLines) : 100;
+    ui->statusbar->showMessage(tr("Preview: showing 1 of every %1 groups, full decoding %2%")
+                               .arg(model->stride()).arg(percent));
+}
+
+void MainWindow::dataInput_dumpFileOpened_handler(const DescLayout &layout, const QString &path)
+{
+    QString error;
+    ingestSegments.clear();
+    store.setDwordsPerGroup(layout.dwCount);
+    if (!store.mapFile(path, &error)) {
+        QMessageBox::warning(this, tr("Error"), tr("Cannot open %1: %2").arg(path, error));
+        return;
+    }
+    resultDesc = dataInputWin->currentDesc();
+    model->setDescLayout(layout);
+
+    if (!updateResultTimer.isActive() && !isUpdating) {
+        updateResultTimer.start();
+    }
+}
+
+void MainWindow::dataInput_sessionOpenRequested_handler(const QString &path)
+{
+    if (isStreaming()) {
+        QMessageBox::warning(this, tr("Error"), tr("Stop capturing first"));
+        return;
+    }
+
+    // 后台线程载入数据期间视图不能读取数据存储
+    common_clearDisplay_handler();
+
+    // 未压缩的会话只映射文件，进度框通常来不及显示
+    SessionFile session;
+    bool ok = false;
+    DescObj desc;
+    QString error;
+    BackgroundTask::run(this, tr("Opening %1...").arg(QFileInfo(path).fileName()),
+        [&]() { ok = session.open(path, &desc, &store, &error); },
+        [&]() { return static_cast<int>(session.processedDwords() * 1000 / qMax<qint64>(1, session.totalDwords())); },
+        [&]() { session.cancel(); });
+
+    if (!ok) {
+        if (!session.isCancelled())
+            QMessageBox::warning(this, tr("Error"), tr("Cannot open %1: %2").arg(path, error));
+        return;
+    }
+
+    // 会话文件中的模板没有经过模板库检查
+    DescLayout layout = desc.compileValid(&error);
+    if (layout.isEmpty()) {
+        common_clearDisplay_handler();
+        QMessageBox::warning(this, tr("Error"), tr("Cannot open %1: %2").arg(path, error));
+        return;
+    }
+
+    // 会话中的模板同时作为当前模板
+    resultDesc = desc;
+    structViewWin->tempMgmt_tempSelected_handler(desc);
+    dataInputWin->tempMgmt_tempSelected_handler(desc);
+    model->setDescLayout(layout);
+    dataInputWin->setMultiGroup(session.flags() & SessionFile::MultiGroup);
+    ui->statusbar->showMessage(tr("Opened session %1, %2 groups").arg(path).arg(store.groupCount()), 3000);
+
+    if (!updateResultTimer.isActive() && !isUpdating) {
+        updateResultTimer.start();
+    }
+}
+
+void MainWindow::dataInput_followFileRequested_handler(const DescLayout &layout, const QString &path)
+{
+    store.setDwordsPerGroup(layout.dwCount);
+    store.setRetention(streamRetention);
+    resultDesc = dataInputWin->currentDesc();
+    model->setDescLayout(layout);
+
+    QString error;
+    // 跟踪的数据接在已有数据之后，按当前的组划分位置记录时间戳
+    qint64 phase = (layout.dwCount > 0) ? (store.endDwordIndex() - store.groupOrigin()) % layout.dwCount : 0;
+    follower->setTimestamps(dataInputWin->timestampsEnabled(), layout.dwCount, static_cast<int>(phase));
+    follower->setFormat(dataInputWin->inputFormat());
+    if (!follower->start(path, &error)) {
+        QMessageBox::warning(this, tr("Error"), tr("Cannot follow %1: %2").arg(path, error));
+        dataInputWin->setFollowing(false);
+        return;
+    }
+    dataInputWin->setFollowing(true);
+    ui->statusbar->showMessage(tr("Following %1").arg(path));
+}
+
+void MainWindow::dataInput_followStopped_handler()
 {
-    // 加入到解析结果数组
-    descList.push_back(std::move(fields));
+    follower->stop();
+    dataInputWin->setFollowing(false);
+    ui->statusbar->clearMessage();
+}
+
+void MainWindow::follower_dwordsAppended_handler(const QVector<uint32_t> &dwords, const TimeMarks &marks)
+{
+    store.append(dwords, marks);
 
+    // 追加频繁时由定时器合并刷新
     if (!updateResultTimer.isActive() && !isUpdating) {
         updateResultTimer.start();
     }
 }
 
+void MainWindow::dataInput_listenToggled_handler(bool listening)
+{
+    if (listening) {
+        ingestSegments.clear();
+        QMetaObject::invokeMethod(ingestServer, "start", Qt::QueuedConnection,
+                                  Q_ARG(QString, ingestSocketName), Q_ARG(int, ingestPort));
+    } else {
+        QMetaObject::invokeMethod(ingestServer, "stop", Qt::BlockingQueuedConnection);
+        // 服务已停止，取完剩余数据后释放环形缓冲区
+        do {
+            ingestTimer_timeout_handler();
+        } while (ingestServer->dwordRing().available() > 0);
+        ingestServer->releaseRings();
+        ingestTimer.stop();
+        dataInputWin->setListening(false);
+        ui->statusbar->clearMessage();
+    }
+}
+
+void MainWindow::applyIngestTemplate(const QString &templateId)
+{
+    // 模板库缓存了编译结果，流中反复切换模板时不重新编译
+    DescObj desc;
+    DescLayout layout;
+    if (templateId.isEmpty()) {
+        desc = dataInputWin->currentDesc();
+        layout = desc.compileValid();
+        if (layout.isEmpty())
+            desc.clear();
+    } else if (!tmpMgmtWin->loadTemplate(templateId, &desc, &layout)) {
+        desc.clear();
+    }
+
+    // 本次监听的第一段清空之前的数据；之后切换模板时保留已收到的数据，新模板从切换位置开始解析
+    if (ingestSegments.isEmpty())
+        common_clearDisplay_handler();
+
+    // 找不到模板或模板无效时丢弃数据，直到下一次模板切换
+    ingestDiscard = desc.empty();
+    if (ingestDiscard) {
+        if (templateId.isEmpty())
+            ui->statusbar->showMessage(tr("The current template is invalid, stream data dropped"));
+        else
+            ui->statusbar->showMessage(tr("Unknown template \"%1\", stream data dropped").arg(templateId));
+        return;
+    }
+
+    qint64 origin = store.endDwordIndex();
+    store.setDwordsPerGroup(layout.dwCount);
+    store.setGroupOrigin(origin);
+    store.setRetention(streamRetention);
+    resultDesc = desc;
+    ingestSegments.push_back({templateId, desc, origin});
+    model->setDescLayout(layout);
+    ui->statusbar->showMessage(tr("Receiving stream with template \"%1\"").arg(templateId), 3000);
+}
+
+void MainWindow::ingestTimer_timeout_handler()
+{
+    // 单次最多取出的 DWORD 个数，避免阻塞界面
+    static const int kDrainDwords = 1024 * 1024;
+
+    SpscRing<uint32_t> &ring = ingestServer->dwordRing();
+    SpscRing<IngestTemplateSwitch> &switches = ingestServer->switchRing();
+    QVector<uint32_t> dwords;
+    int budget = kDrainDwords;
+    bool appended = false;
+
+    auto flush = [this, &dwords, &appended]() {
+        if (!ingestDiscard && !dwords.isEmpty()) {
+            store.append(dwords);
+            appended = true;
+        }
+        dwords.clear();
+    };
+
+    while (budget > 0) {
+        // 先读数据可用量，再查看切换记录，保证看到的数据对应的切换记录都已可见
+        int avail = ring.available();
+        quint64 readPos = ring.readPosition();
+        IngestTemplateSwitch next;
+        bool hasSwitch = switches.peek(&next);
+
+        if (hasSwitch && (next.position == readPos)) {
+            flush();
+            switches.pop(&next, 1);
+            applyIngestTemplate(next.templateId);
+            continue;
+        }
+
+        qint64 limit = qMin(avail, budget);
+        if (hasSwitch)
+            limit = qMin<qint64>(limit, next.position - readPos);
+        if (limit <= 0)
+            break;
+
+        int oldSize = dwords.size();
+        dwords.resize(oldSize + static_cast<int>(limit));
+        int n = ring.pop(dwords.data() + oldSize, static_cast<int>(limit));
+        dwords.resize(oldSize + n);
+        budget -= n;
+    }
+    flush();
+
+    if (appended && !updateResultTimer.isActive() && !isUpdating) {
+        updateResultTimer.start();
+    }
+}
+
+bool MainWindow::isStreaming() const
+{
+    return follower->isFollowing() || ingestTimer.isActive();
+}
+
 void MainWindow::common_clearDisplay_handler()
 {
-    model->clear();
-    groupStartRows.clear();
-    descList.clear();
+    ingestSegments.clear();
+    store.clear();
+    model->reset();
 }
 
 void MainWindow::batchUpdateResult()
 {
-    if (isUpdating || descList.isEmpty()) return;
+    if (isUpdating) return;
 
     isUpdating = true;
 
-    int processCnt = 0;
+    // 跟踪模式下视图位于底部时自动滚动
+    QScrollBar *scrollBar = ui->resultTable->verticalScrollBar();
+    bool atBottom = (scrollBar->value() >= scrollBar->maximum());
 
-    // 禁用 UI 自动更新
-    ui->resultTable->setUpdatesEnabled(false);
+    // 只通知视图组数变化，字段在显示时才解析
+    model->syncGroups();
 
-    // 限制单次刷新行数
-    while ((groupStartRows.size() < descList.size()) && (processCnt < 5000)) {
-        int curGroupId = groupStartRows.size();
-        auto &fields = descList[curGroupId];
+    if (isStreaming() && atBottom)
+        ui->resultTable->scrollToBottom();
 
-        int startRow = model->rowCount();
-        int groupSize = fields.size();
-        qDebug() << "Append group" << curGroupId << "start" << startRow << "size" << groupSize;
+    // 超出的行不显示，提示用户分段查看
+    if (model->isRowLimited() && !rowLimitWarned) {
+        ui->statusbar->showMessage(tr("Only the first %1 rows of %2 groups are shown, use \"Show Groups...\" to view the rest")
+                                   .arg(INT_MAX).arg(model->shownGroups()));
+        qWarning("%s[%d]: %lld groups exceed the row limit", __func__, __LINE__, model->shownGroups());
+    }
+    rowLimitWarned = model->isRowLimited();
 
+    // 按内容调整列宽需要遍历可见行，只在布局变化后的第一批数据时调整
+    if (resizeColumnsPending && (model->rowCount() > 0)) {
+        if (multiGroup)
+            ui->resultTable->horizontalHeader()->setSectionResizeMode(3, QHeaderView::Stretch);
+        ui->resultTable->resizeColumnsToContents();
+        resizeColumnsPending = false;
+    }
 
-        for (auto &field : fields) {
-            QStandardItem *nameItem = new QStandardItem(field.name);
+    isUpdating = false;
+}
 
-            QStandardItem *valueItem = new QStandardItem();
-            valueItem->setData(field.value, Qt::DisplayRole);
+void MainWindow::result_rowSelected_handler(const QModelIndex &index)
+{
+    // 通过自定义角色获取字段位置，与显示模式无关
+    QVariant dwIdx = index.data(ResultModel::DWordRole);
+    QVariant lsb = index.data(ResultModel::LsbRole);
+    if (!dwIdx.isValid() || !lsb.isValid()) return;
 
-            QStandardItem *hexValueItem = new QStandardItem(QString::asprintf("0x%x", field.value));
+    structViewWin->fieldSelected_handler(dwIdx.toInt(), lsb.toInt());
+}
+
+void MainWindow::structView_fieldClicked_handler(int dw, int lsb)
+{
+    int field = model->fieldAt(dw, lsb);
+    model->setHighlightField(field);
+    if (field < 0) {
+        ui->statusbar->clearMessage();
+        return;
+    }
+
+    // 从当前行所在的组开始，没有当前行则从第一组开始
+    qint64 group = 0;
+    qint64 curGroup;
+    if (model->locateRow(ui->resultTable->currentIndex().row(), &curGroup, nullptr))
+        group = curGroup;
+    jumpToField(group, 0);
+}
+
+void MainWindow::diffAction_triggered_handler()
+{
+    // 比较期间当前数据不能变化
+    if (isStreaming() || model->isPreview()) {
+        QMessageBox::warning(this, tr("Error"), tr("Stop capturing and wait for parsing to finish before comparing"));
+        return;
+    }
+    if ((store.groupCount() == 0) || model->descLayout().isEmpty()) {
+        QMessageBox::warning(this, tr("Error"), tr("No parsed data to compare"));
+        return;
+    }
 
-            QList<QStandardItem *> newRow({nameItem, valueItem, hexValueItem});
+    QString path = QFileDialog::getOpenFileName(this, tr("Diff Against Capture"), QString(),
+                                                tr("Captures (*.log *.txt *.bin *.dump *.raw);;All files (*)"));
+    if (path.isEmpty())
+        return;
 
-            if (multiGroup) {
-                QStandardItem *groupIdItem = new QStandardItem(QString::asprintf("Group %d", curGroupId));
-                if (curGroupId % 2 == 0) {
-                    groupIdItem->setBackground(QBrush(Qt::white)); // 白色
-                } else {
-                    groupIdItem->setBackground(QBrush(Qt::lightGray)); // 浅灰色
+    DiffWin diffWin(this, &store, model->descLayout());
+    // 单组模式只比较显示的组
+    if (!multiGroup)
+        diffWin.setGroupRange(model->storeGroup(0), model->storeGroup(0) + 1);
+    QString error;
+    if (!diffWin.compareWith(path, &error)) {
+        QMessageBox::warning(this, tr("Error"), tr("Cannot open %1: %2").arg(path, error));
+        return;
+    }
+    diffWin.exec();
+}
+
+void MainWindow::uniqueAction_triggered_handler()
+{
+    // 统计期间当前数据不能变化
+    if (isStreaming() || model->isPreview()) {
+        QMessageBox::warning(this, tr("Error"), tr("Stop capturing and wait for parsing to finish first"));
+        return;
+    }
+    if ((store.groupCount() == 0) || model->descLayout().isEmpty()) {
+        QMessageBox::warning(this, tr("Error"), tr("No parsed data"));
+        return;
+    }
+    if (store.groupCount() > UniqueGroups::kMaxGroups) {
+        QMessageBox::warning(this, tr("Error"), tr("Too many groups to collect, at most %1").arg(UniqueGroups::kMaxGroups));
+        return;
+    }
+
+    UniqueGroupsWin uniqueWin(this, &store, model->descLayout());
+    uniqueWin.collect();
+    if (uniqueWin.exec() != QDialog::Accepted)
+        return;
+
+    // 跳转到选中描述符首次出现的组
+    int row = model->rowOfGroup(model->groupOfSource(uniqueWin.selectedGroup()));
+    if (row < 0)
+        return;
+    QModelIndex index = model->index(row, 0);
+    ui->resultTable->setCurrentIndex(index);
+    ui->resultTable->scrollTo(index, QAbstractItemView::PositionAtTop);
+}
+
+void MainWindow::searchAction_triggered_handler()
+{
+    // 搜索期间当前数据不能变化
+    if (isStreaming() || model->isPreview()) {
+        QMessageBox::warning(this, tr("Error"), tr("Stop capturing and wait for parsing to finish first"));
+        return;
+    }
+    if (store.dwordCount() == 0) {
+        QMessageBox::warning(this, tr("Error"), tr("No data to search"));
+        return;
+    }
+
+    // 当前模板无效时只搜索，不解析
+    DescLayout layout = dataInputWin->currentDesc().compileValid();
+    // 匹配个数不超过结果表格一次能显示的组数
+    SignatureSearchWin searchWin(this, &store, !layout.isEmpty(),
+                                 layout.isEmpty() ? SignatureSearch::kMaxMatches : (INT_MAX / qMax(1, layout.fieldCount())));
+    if (searchWin.exec() != QDialog::Accepted)
+        return;
+
+    // 以各匹配位置为起点按当前模板解析，替换当前数据
+    QVector<uint32_t> dwords = SignatureSearch::gather(store, searchWin.matches(), layout.dwCount);
+    dataInputWin->setMultiGroup(true);
+    dataInput_dwordsSubmitted_handler(layout, dwords, TimeMarks());
+    ui->statusbar->showMessage(tr("Decoded %1 matches as groups").arg(dwords.size() / layout.dwCount));
+}
+
+QVector<QPair<qint64, qint64>> MainWindow::selectedGroupRanges() const
+{
+    // 按选择区间计算，不展开每个选中的单元格
+    QVector<QPair<qint64, qint64>> ranges;
+    for (const QItemSelectionRange &range : ui->resultTable->selectionModel()->selection()) {
+        qint64 first;
+        qint64 last;
+        if (model->locateRow(range.top(), &first, nullptr) && model->locateRow(range.bottom(), &last, nullptr))
+            ranges.push_back(qMakePair(model->storeGroup(first), model->storeGroup(last) + 1));
+    }
+
+    std::sort(ranges.begin(), ranges.end());
+    QVector<QPair<qint64, qint64>> merged;
+    for (const auto &range : ranges) {
+        if (!merged.isEmpty() && (range.first <= merged.last().second))
+            merged.last().second = qMax(merged.last().second, range.second);
+        else
+            merged.push_back(range);
+    }
+    return merged;
+}
+
+void MainWindow::setFieldAction_triggered_handler()
+{
+    if (!model->isEditable()) {
+        QMessageBox::warning(this, tr("Error"), tr("Values cannot be edited in preview, delta view or a mapped dump"));
+        return;
+    }
+    QModelIndex current = ui->resultTable->currentIndex();
+    QVector<QPair<qint64, qint64>> ranges = selectedGroupRanges();
+    if (!current.isValid() || ranges.isEmpty()) {
+        QMessageBox::warning(this, tr("Error"), tr("Select the field and groups to modify"));
+        return;
+    }
+
+    int field = current.data(ResultModel::FieldRole).toInt();
+    const DescFieldSpec &spec = model->descLayout().fields.at(field);
+    if (spec.isDerived()) {
+        QMessageBox::warning(this, tr("Error"), tr("%1 is derived from other fields and cannot be set").arg(spec.name));
+        return;
+    }
+    // 在十六进制列上修改时输入的数字按十六进制解析
+    int base = ResultModel::columnBase(current.column());
+    bool ok;
+    QString text = QInputDialog::getText(this, tr("Set Field"),
+                                         ((base == 16) ? tr("New value of %1 (hex):") : tr("New value of %1:")).arg(spec.name),
+                                         QLineEdit::Normal, QString(), &ok);
+    if (!ok)
+        return;
+    uint32_t value;
+    if (!model->parseFieldValue(field, text, &value, base)) {
+        QMessageBox::warning(this, tr("Error"), tr("Invalid value for a %1-bit field").arg(spec.msb - spec.lsb + 1));
+        return;
+    }
+
+    // 所有选中组的同一字段一次性按掩码写入
+    QVector<uint32_t> keep(store.dwordsPerGroup(), 0xffffffffu);
+    QVector<uint32_t> set(store.dwordsPerGroup(), 0);
+    keep[spec.dwIdx] = ~DescObj::subfieldMask(spec.lsb, spec.msb);
+    set[spec.dwIdx] = DescObj::insertSubfield(0, spec.lsb, spec.msb, value);
+    qint64 groups = 0;
+    for (const auto &range : ranges) {
+        store.maskedWrite(range.first, range.second, keep, set);
+        groups += range.second - range.first;
+    }
+    model->valuesChanged();
+    ui->statusbar->showMessage(tr("Set %1 = 0x%2 in %3 groups").arg(spec.name).arg(value, 0, 16).arg(groups), 3000);
+}
+
+void MainWindow::copyDwordsAction_triggered_handler()
+{
+    // 与输入框接受的格式一致，每行一个 0x%08x，共 11 个字符
+    static const int kLineChars = 11;
+    QVector<QPair<qint64, qint64>> ranges = selectedGroupRanges();
+    int dwPerGroup = store.dwordsPerGroup();
+    qint64 groups = 0;
+    for (const auto &range : ranges)
+        groups += range.second - range.first;
+    if ((groups <= 0) || (dwPerGroup <= 0))
+        return;
+    // 与表格复制使用相同的上限
+    if (groups * dwPerGroup * kLineChars > TableView::kMaxCopyChars) {
+        QMessageBox::warning(this, tr("Error"), tr("The selection is too large to copy, export it instead"));
+        return;
+    }
+
+    QByteArray text(static_cast<int>(groups * dwPerGroup * kLineChars), Qt::Uninitialized);
+    int length = 0;
+    std::atomic<qint64> copied(0);
+    std::atomic<bool> cancelled(false);
+    auto format = [&]() {
+        static const char hex[] = "0123456789abcdef";
+        QVector<uint32_t> dwords(dwPerGroup);
+        char *out = text.data();
+        for (const auto &range : ranges) {
+            for (qint64 g = range.first; (g < range.second) && !cancelled; g++, copied++) {
+                // 流式模式下已丢弃的组跳过
+                if (!store.readGroup(g, dwords.data()))
+                    continue;
+                for (uint32_t dw : dwords) {
+                    *out++ = '0';
+                    *out++ = 'x';
+                    for (int shift = 28; shift >= 0; shift -= 4)
+                        *out++ = hex[(dw >> shift) & 0xf];
+                    *out++ = '\n';
                 }
-                newRow << groupIdItem;
             }
-
-            model->appendRow(newRow);
-            processCnt++;
         }
+        length = static_cast<int>(out - text.data());
+    };
 
-        // 存储每组的开始行号
-        groupStartRows.push_back(startRow);
+    // 持续抓取时数据随时变化，直接在界面线程生成；否则在后台线程生成，模态进度框阻止数据变化
+    if (isStreaming()) {
+        format();
+    } else {
+        BackgroundTask::run(this, tr("Copying %1 groups...").arg(groups), format,
+            [&]() { return static_cast<int>(copied * 1000 / groups); },
+            [&]() { cancelled = true; });
+        if (cancelled)
+            return;
     }
+    text.truncate(length);
+    if (!text.isEmpty())
+        QApplication::clipboard()->setText(QString::fromLatin1(text));
+}
 
-    // 启用更新并刷新
+void MainWindow::exportAction_triggered_handler()
+{
+    // 导出期间当前数据不能变化
+    if (isStreaming() || model->isPreview()) {
+        QMessageBox::warning(this, tr("Error"), tr("Stop capturing and wait for parsing to finish first"));
+        return;
+    }
+    if ((store.groupCount() == 0) || model->descLayout().isEmpty()) {
+        QMessageBox::warning(this, tr("Error"), tr("No parsed data to export"));
+        return;
+    }
+
+    QString selectedFilter;
+    QString path = QFileDialog::getSaveFileName(this, tr("Export Results"), QString(), ResultExporter::fileFilters(),
+                                                &selectedFilter);
+    if (path.isEmpty())
+        return;
+    ResultExporter::Format format;
+    if (!ResultExporter::formatForPath(&path, selectedFilter, &format)) {
+        QMessageBox::warning(this, tr("Error"), tr("Unknown export format %1, use .csv, .jsonl or .spc").arg(QFileInfo(path).suffix()));
+        return;
+    }
+
+    // 后台线程导出，模态进度框定时查询进度
+    ResultExporter exporter(&store, model->descLayout());
+    bool ok = false;
+    QString error;
+    bool finished = BackgroundTask::run(this, tr("Exporting to %1...").arg(QFileInfo(path).fileName()),
+        [&]() { ok = exporter.exportTo(path, format, &error); },
+        [&]() { return static_cast<int>(exporter.exportedGroups() * 1000 / qMax<qint64>(1, exporter.totalGroups())); },
+        [&]() { exporter.cancel(); }, 0);
+
+    if (!finished)
+        return;
+    if (!ok) {
+        QMessageBox::warning(this, tr("Error"), tr("Export failed: %1").arg(error));
+        return;
+    }
+    ui->statusbar->showMessage(tr("Exported %1 groups to %2").arg(exporter.totalGroups()).arg(path), 3000);
+}
+
+void MainWindow::saveSessionAction_triggered_handler()
+{
+    // 保存期间当前数据不能变化
+    if (isStreaming() || model->isPreview()) {
+        QMessageBox::warning(this, tr("Error"), tr("Stop capturing and wait for parsing to finish first"));
+        return;
+    }
+    if ((store.groupCount() == 0) || resultDesc.empty()) {
+        QMessageBox::warning(this, tr("Error"), tr("No parsed data to save"));
+        return;
+    }
+
+    QString compressedFilter = tr("Compressed session (*.sps)");
+    QString filter;
+    QString path = QFileDialog::getSaveFileName(this, tr("Save Session"), QString(),
+                                                tr("Session (*.sps)") + ";;" + compressedFilter, &filter);
+    if (path.isEmpty())
+        return;
+
+    uint32_t flags = 0;
+    if (filter == compressedFilter)
+        flags |= SessionFile::Compressed;
     if (multiGroup)
-        ui->resultTable->horizontalHeader()->setSectionResizeMode(3, QHeaderView::Stretch);
-    ui->resultTable->setUpdatesEnabled(true);
-    ui->resultTable->resizeColumnsToContents();
+        flags |= SessionFile::MultiGroup;
 
-    isUpdating = false;
+    SessionFile session;
+    bool ok = false;
+    QString error;
+    BackgroundTask::run(this, tr("Saving to %1...").arg(QFileInfo(path).fileName()),
+        [&]() { ok = session.save(path, resultDesc, &store, flags, &error); },
+        [&]() { return static_cast<int>(session.processedDwords() * 1000 / qMax<qint64>(1, session.totalDwords())); },
+        [&]() { session.cancel(); }, 0);
 
-    if (groupStartRows.size() < descList.size()) {
-        updateResultTimer.start();
+    if (session.isCancelled())
+        return;
+    if (!ok) {
+        QMessageBox::warning(this, tr("Error"), tr("Save failed: %1").arg(error));
+        return;
     }
+    ui->statusbar->showMessage(tr("Saved %1 groups to %2").arg(store.groupCount()).arg(path), 3000);
 }
 
-void MainWindow::result_rowSelected_handler(const QModelIndex &index)
+void MainWindow::gotoTimeAction_triggered_handler()
 {
-    // 获取点击单元格的行
-    int row = index.row();
-    QStandardItem *groupIdItem = model->item(row, 3);
-    if (groupIdItem == nullptr) return;
+    const TimeIndex &times = store.timeIndex();
+    if (!times.isActive() || model->isPreview()) {
+        QMessageBox::warning(this, tr("Error"), tr("No timestamps in the current data, check \"Time\" before parsing"));
+        return;
+    }
 
-    int groupId = groupIdItem->text().midRef(6).toInt();
+    bool ok = false;
+    QString text = QInputDialog::getText(this, tr("Go to Time"), tr("Time (seconds):"), QLineEdit::Normal,
+                                         QString(), &ok);
+    if (!ok || text.trimmed().isEmpty())
+        return;
+    qint64 t;
+    if (!parseTimeText(text, &t)) {
+        QMessageBox::warning(this, tr("Error"), tr("Invalid time: %1").arg(text));
+        return;
+    }
 
-    if ((groupId < 0) || (groupId >= groupStartRows.size())) return;
-    // 计算组内行索引
-    int localRowId = row - groupStartRows[groupId];
+    qint64 group = times.findGroup(t);
+    int row = (group >= 0) ? model->rowOfGroup(model->groupOfSource(group)) : -1;
+    if (row < 0) {
+        ui->statusbar->showMessage(tr("No shown group at or after %1").arg(TimeIndex::formatTime(t)), 3000);
+        return;
+    }
+    QModelIndex index = model->index(row, 0);
+    ui->resultTable->scrollTo(index, QAbstractItemView::PositionAtTop);
+    ui->resultTable->setCurrentIndex(index);
+    ui->statusbar->showMessage(tr("Group %1 at %2").arg(group).arg(TimeIndex::formatTime(times.groupTime(group))), 3000);
+}
 
-    if ((localRowId < 0) || (localRowId >= descList[groupId].size())) return;
-    // 获取解析条目
-    DescFieldItem &field = descList[groupId][localRowId];
+void MainWindow::timeFilterAction_triggered_handler()
+{
+    const TimeIndex &times = store.timeIndex();
+    if (!times.isActive() || model->isPreview() || !multiGroup) {
+        QMessageBox::warning(this, tr("Error"), tr("No timestamps in the current data, check \"Time\" before parsing"));
+        return;
+    }
+
+    // 输入 "开始 结束"，省略结束时间表示到最后，输入为空时显示全部组
+    bool ok = false;
+    QString text = QInputDialog::getText(this, tr("Filter by Time"), tr("Time range in seconds (empty to show all):"),
+                                         QLineEdit::Normal, QString(), &ok);
+    if (!ok)
+        return;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    QStringList parts = text.split(QRegularExpression("[\\s,]+"), Qt::SkipEmptyParts);
+#else
+    QStringList parts = text.split(QRegularExpression("[\\s,]+"), QString::SkipEmptyParts);
+#endif
+    if (parts.isEmpty()) {
+        model->clearGroupWindow();
+        batchUpdateResult();
+        ui->statusbar->clearMessage();
+        return;
+    }
+
+    qint64 begin;
+    qint64 end = LLONG_MAX;
+    if ((parts.size() > 2) || !parseTimeText(parts.at(0), &begin) || ((parts.size() == 2) && !parseTimeText(parts.at(1), &end))) {
+        QMessageBox::warning(this, tr("Error"), tr("Invalid time range: %1").arg(text));
+        return;
+    }
+
+    // 时间乱序时显示包含该时间段所有组的最小区间
+    QPair<qint64, qint64> span = times.groupSpan(begin, end);
+    if (span.first >= span.second) {
+        QMessageBox::warning(this, tr("Error"), tr("No groups in the time range"));
+        return;
+    }
+    model->setGroupWindow(span.first, span.second);
+    batchUpdateResult();
+    ui->statusbar->showMessage(tr("Showing groups %1 to %2").arg(span.first).arg(span.second - 1));
+}
+
+void MainWindow::showGroupsAction_triggered_handler()
+{
+    if (isStreaming() || model->isPreview() || !multiGroup) {
+        QMessageBox::warning(this, tr("Error"), tr("Stop capturing and wait for parsing to finish first"));
+        return;
+    }
+
+    // 从输入的组号开始显示不超过表格行数上限的一段，输入为空时显示全部组
+    qint64 groups = model->maxWindowGroups();
+    bool ok = false;
+    QString text = QInputDialog::getText(this, tr("Show Groups"),
+                                         tr("First group, up to %1 groups are shown (empty to show all):").arg(groups),
+                                         QLineEdit::Normal, QString(), &ok);
+    if (!ok)
+        return;
+    if (text.trimmed().isEmpty()) {
+        model->clearGroupWindow();
+        batchUpdateResult();
+        ui->statusbar->clearMessage();
+        return;
+    }
+
+    qint64 first = text.trimmed().toLongLong(&ok, 0);
+    if (!ok || (first < store.firstGroup()) || (first >= store.endGroup())) {
+        QMessageBox::warning(this, tr("Error"), tr("Group must be in [%1, %2)").arg(store.firstGroup()).arg(store.endGroup()));
+        return;
+    }
+    qint64 end = qMin(store.endGroup(), first + groups);
+    model->setGroupWindow(first, end);
+    batchUpdateResult();
+    ui->statusbar->showMessage(tr("Showing groups %1 to %2").arg(first).arg(end - 1));
+}
+
+void MainWindow::streamSegmentsAction_triggered_handler()
+{
+    if (isStreaming()) {
+        QMessageBox::warning(this, tr("Error"), tr("Stop capturing first"));
+        return;
+    }
+    if (ingestSegments.size() < 2) {
+        QMessageBox::warning(this, tr("Error"), tr("The stream did not switch templates"));
+        return;
+    }
+
+    QStringList items;
+    for (int i = 0; i < ingestSegments.size(); i++) {
+        const IngestSegment &segment = ingestSegments.at(i);
+        items << tr("%1: \"%2\" from DW %3").arg(i + 1).arg(segment.templateId).arg(segment.origin);
+    }
+    bool ok = false;
+    QString item = QInputDialog::getItem(this, tr("Stream Segments"), tr("Show the data decoded with:"), items,
+                                         items.size() - 1, false, &ok);
+    if (!ok)
+        return;
+
+    // 每段到下一段的起点为止，超出保留策略的部分已经丢弃
+    int index = items.indexOf(item);
+    const IngestSegment &segment = ingestSegments.at(index);
+    qint64 end = (index + 1 < ingestSegments.size()) ? ingestSegments.at(index + 1).origin : store.endDwordIndex();
+    if (end <= store.firstDwordIndex()) {
+        QMessageBox::warning(this, tr("Error"), tr("The data of this segment has been dropped"));
+        return;
+    }
+
+    QString error;
+    DescLayout layout = segment.desc.compileValid(&error);
+    if (layout.isEmpty()) {
+        QMessageBox::warning(this, tr("Error"), error);
+        return;
+    }
+    store.setDwordsPerGroup(layout.dwCount);
+    store.setGroupOrigin(segment.origin);
+    resultDesc = segment.desc;
+    model->setDescLayout(layout);
+    model->setGroupWindow(0, (end - segment.origin) / layout.dwCount);
+    batchUpdateResult();
+    ui->statusbar->showMessage(tr("Showing segment %1 with template \"%2\"").arg(index + 1).arg(segment.templateId));
+}
+
+void MainWindow::registerTraceAction_triggered_handler()
+{
+    QString mapPath = QFileDialog::getOpenFileName(this, tr("Open Register Map"), templatesPath,
+                                                   tr("Register maps (*.regmap *.json);;All files (*)"));
+    if (mapPath.isEmpty())
+        return;
+
+    QFile mapFile(mapPath);
+    if (!mapFile.open(QIODevice::ReadOnly)) {
+        QMessageBox::warning(this, tr("Error"), tr("Cannot open %1: %2").arg(mapPath, mapFile.errorString()));
+        return;
+    }
+    // 映射文件中的模板名称为模板目录下的相对路径
+    RegisterMap map;
+    QString error;
+    bool loaded = map.load(mapFile.readAll(), [this](const QString &name, DescLayout *layout) {
+        return tmpMgmtWin->loadTemplate(name, nullptr, layout);
+    }, &error);
+    if (!loaded) {
+        QMessageBox::warning(this, tr("Error"), tr("Invalid register map %1: %2").arg(mapPath, error));
+        return;
+    }
+
+    QString tracePath = QFileDialog::getOpenFileName(this, tr("Open Register Trace"), QFileInfo(mapPath).absolutePath(),
+                                                     tr("Traces (*.log *.txt *.trace);;All files (*)"));
+    if (tracePath.isEmpty())
+        return;
+
+    RegisterTraceWin traceWin(this, map);
+    if (!traceWin.loadTrace(tracePath, &error)) {
+        if (!traceWin.isCancelled())
+            QMessageBox::warning(this, tr("Error"), tr("Cannot open %1: %2").arg(tracePath, error));
+        return;
+    }
+    traceWin.exec();
+}
+
+void MainWindow::result_largeCopyRequested_handler(int firstRow, int lastRow, int firstCol, int lastCol)
+{
+    // 预览期间后台解析会替换数据，行映射随之变化
+    if (model->isPreview()) {
+        QMessageBox::warning(this, tr("Error"), tr("Wait for parsing to finish before copying"));
+        return;
+    }
+
+    // 持续抓取时行映射随时变化，直接在界面线程生成
+    bool tooLarge = false;
+    if (isStreaming()) {
+        QString text = model->copyText(firstRow, lastRow, firstCol, lastCol, nullptr, nullptr, &tooLarge);
+        if (tooLarge)
+            QMessageBox::warning(this, tr("Error"), tr("The selection is too large to copy, export it instead"));
+        else
+            QApplication::clipboard()->setText(text);
+        return;
+    }
+
+    // 后台线程从数据源生成文本，模态进度框阻止数据变化
+    int rows = lastRow - firstRow + 1;
+    std::atomic<int> copied(0);
+    std::atomic<bool> cancelled(false);
+    QString text;
+    BackgroundTask::run(this, tr("Copying %1 rows...").arg(rows),
+        [&]() { text = model->copyText(firstRow, lastRow, firstCol, lastCol, &copied, &cancelled, &tooLarge); },
+        [&]() { return static_cast<int>(qint64(copied) * 1000 / rows); },
+        [&]() { cancelled = true; });
+
+    if (cancelled)
+        return;
+    if (tooLarge) {
+        QMessageBox::warning(this, tr("Error"), tr("The selection is too large to copy, export it instead"));
+        return;
+    }
+    QApplication::clipboard()->setText(text);
+    ui->statusbar->showMessage(tr("Copied %1 rows").arg(rows), 3000);
+}
+
+void MainWindow::nextFieldShortcut_activated_handler()
+{
+    qint64 group;
+    if (!model->locateRow(ui->resultTable->currentIndex().row(), &group, nullptr))
+        group = -1;
+    jumpToField(group, 1);
+}
+
+void MainWindow::prevFieldShortcut_activated_handler()
+{
+    qint64 group;
+    if (!model->locateRow(ui->resultTable->currentIndex().row(), &group, nullptr))
+        group = 0;
+    jumpToField(group, -1);
+}
+
+void MainWindow::jumpToField(qint64 group, int step)
+{
+    int field = model->highlightField();
+    qint64 groups = model->shownGroups();
+    if ((field < 0) || (groups <= 0))
+        return;
+
+    // 所有组布局相同，目标行直接由组起始行加字段序号得到，首尾循环
+    // 差异视图中字段只出现在发生变化的组，跳过未变化的组
+    int row = -1;
+    for (qint64 tries = 0; (row < 0) && (tries < groups); tries++) {
+        group = ((group + step) % groups + groups) % groups;
+        row = model->rowOfField(group, field);
+        if (step == 0)
+            step = 1;
+    }
+    if (row < 0)
+        return;
 
-    structViewWin->fieldSelected_handler(field.dwIdx, field.lsb);
+    ui->resultTable->itemSelected_handler(row, 0);
+    ui->statusbar->showMessage(tr("%1: group %2 (%3 of %4), F3/Shift+F3 for next/previous")
+                               .arg(model->descLayout().fields.at(field).name)
+                               .arg(model->index(row, 0).data(ResultModel::GroupRole).toLongLong())
+                               .arg(group + 1).arg(groups));
 }
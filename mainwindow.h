@@ -4,15 +4,21 @@
 #include <QtCore/QVariant>
 #include <QMainWindow>
 #include <QtGui/QIcon>
+#include <QMenuBar>
 #include <QStatusBar>
 #include <QVBoxLayout>
 #include <datainputwindow.h>
 #include <structviewwindow.h>
 #include <templatemanagewindow.h>
-#include <QStandardItemModel>
 #include <QCoreApplication>
 #include <QTimer>
 #include "tableview.h"
+#include "resultstore.h"
+#include "resultmodel.h"
+#include "filefollower.h"
+#include "ingestserver.h"
+#include <QThread>
+#include <QShortcut>
 
 QT_BEGIN_NAMESPACE
 
@@ -21,6 +27,9 @@ class UiMainWindow
 public:
     QWidget *centralWidget;
     QVBoxLayout *centralLayout;
+    QMenuBar *menubar;
+    // 不针对结果表的功能
+    QMenu *toolsMenu;
     QStatusBar *statusbar;
 
     TableView *resultTable;
@@ -43,8 +52,15 @@ public:
 
         MainWindow->setCentralWidget(centralWidget);
 
+        menubar = new QMenuBar(MainWindow);
+        menubar->setObjectName(QString::fromUtf8("menubar"));
+        toolsMenu = menubar->addMenu(QCoreApplication::translate("MainWindow", "Tools"));
+        toolsMenu->setObjectName(QString::fromUtf8("toolsMenu"));
+        MainWindow->setMenuBar(menubar);
+
         statusbar = new QStatusBar(MainWindow);
         statusbar->setObjectName(QString::fromUtf8("statusbar"));
+        MainWindow->setStatusBar(statusbar);
 
         MainWindow->setCorner(Qt::BottomLeftCorner, Qt::LeftDockWidgetArea);
         MainWindow->setCorner(Qt::BottomRightCorner, Qt::RightDockWidgetArea);
@@ -53,8 +69,8 @@ public:
         resultTable->setObjectName(QString::fromUtf8("resultTable"));
         resultTable->verticalHeader()->setVisible(false);
         resultTable->horizontalHeader()->setVisible(false);
-        // 设置内容不可编辑
-        resultTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        // 只有模型允许的字段值可以编辑
+        resultTable->setEditTriggers(QAbstractItemView::DoubleClicked | QAbstractItemView::EditKeyPressed);
         // 设置最小列宽
         resultTable->horizontalHeader()->setMinimumSectionSize(75);
         centralLayout = new QVBoxLayout(centralWidget);
@@ -77,22 +93,81 @@ public:
     ~MainWindow();
 
 private slots:
-    void dataInput_appendOneGroup_handler(DescFieldList fields);
+    void dataInput_dwordsSubmitted_handler(const DescLayout &layout, const QVector<uint32_t> &dwords, const TimeMarks &marks);
+    void dataInput_previewSubmitted_handler(const DescLayout &layout, const QVector<uint32_t> &dwords, int stride);
+    void dataInput_parseProgress_handler(int parsedLines, int totalLines);
+    void dataInput_dumpFileOpened_handler(const DescLayout &layout, const QString &path);
+    void dataInput_sessionOpenRequested_handler(const QString &path);
+    void dataInput_followFileRequested_handler(const DescLayout &layout, const QString &path);
+    void dataInput_followStopped_handler();
+    void follower_dwordsAppended_handler(const QVector<uint32_t> &dwords, const TimeMarks &marks);
+    void dataInput_listenToggled_handler(bool listening);
+    void ingestTimer_timeout_handler();
     void common_clearDisplay_handler();
     void batchUpdateResult();
     void result_rowSelected_handler(const QModelIndex &index);
+    void structView_fieldClicked_handler(int dw, int lsb);
+    void diffAction_triggered_handler();
+    void uniqueAction_triggered_handler();
+    void searchAction_triggered_handler();
+    void setFieldAction_triggered_handler();
+    void copyDwordsAction_triggered_handler();
+    void exportAction_triggered_handler();
+    void saveSessionAction_triggered_handler();
+    void gotoTimeAction_triggered_handler();
+    void timeFilterAction_triggered_handler();
+    void showGroupsAction_triggered_handler();
+    void streamSegmentsAction_triggered_handler();
+    void registerTraceAction_triggered_handler();
+    void result_largeCopyRequested_handler(int firstRow, int lastRow, int firstCol, int lastCol);
+    void nextFieldShortcut_activated_handler();
+    void prevFieldShortcut_activated_handler();
 
 private:
+    bool isStreaming() const;
+    void jumpToField(qint64 group, int step);
+    // 选中行所在的组，合并为升序排列、互不重叠的数据源组号区间 [first, second)
+    QVector<QPair<qint64, qint64>> selectedGroupRanges() const;
+    void applyIngestTemplate(const QString &templateId);
+
+    // 数据流中每次切换模板后的一段数据，从 origin 开始按 desc 解析
+    struct IngestSegment
+    {
+        QString templateId;
+        DescObj desc;
+        qint64 origin;
+    };
+
     QString templatesPath;
     DataInputWin *dataInputWin;
     TmpMgmtWin *tmpMgmtWin;
     StructViewWin *structViewWin;
     Ui::MainWindow *ui;
-    QList<DescFieldList> descList;
-    QVector<int> groupStartRows;
+    ResultStore store;
+    // 当前显示的数据使用的模板，保存会话时写入
+    DescObj resultDesc;
+    // 跟踪文件和接收数据流时的保留策略
+    ResultStore::Retention streamRetention;
     QTimer updateResultTimer;
     bool isUpdating;
-    QStandardItemModel *model;
+    // 模型重置或增加列后，有数据时才按内容调整一次列宽，跟踪时不在每次刷新时调整
+    bool resizeColumnsPending;
+    ResultModel *model;
+    FileFollower *follower;
+    // 数据流接收服务运行在独立线程，界面线程定时从环形缓冲区取数据
+    QThread ingestThread;
+    IngestServer *ingestServer;
+    QTimer ingestTimer;
+    QString ingestSocketName;
+    int ingestPort;
+    bool ingestDiscard;
+    // 本次监听中的各段，切换模板后之前的数据仍然保留，可以按原来的模板查看
+    QVector<IngestSegment> ingestSegments;
     bool multiGroup;
+    // 已经提示过行数超过表格上限，避免每次刷新都覆盖状态栏
+    bool rowLimitWarned;
+    // 在所有组中跳转同一字段
+    QShortcut *nextFieldShortcut;
+    QShortcut *prevFieldShortcut;
 };
 #endif // MAINWINDOW_H
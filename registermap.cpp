@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <QDebug>
+#include <QHash>
+#include <QObject>
+#include "registermap.h"
+
+// 地址可以是字符串（十进制或 0x 开头的十六进制）或数字
+static bool parseAddress(const QJsonValue &value, quint64 *address)
+{
+    if (value.isDouble()) {
+        if (value.toDouble() < 0)
+            return false;
+        *address = static_cast<quint64>(value.toDouble());
+        return true;
+    }
+
+    QString text = value.toString().trimmed();
+    bool ok = false;
+    if (text.startsWith("0x", Qt::CaseInsensitive))
+        *address = text.mid(2).toULongLong(&ok, 16);
+    else
+        *address = text.toULongLong(&ok, 10);
+    return ok;
+}
+
+bool RegisterMap::load(const QByteArray &json, const TemplateLoader &loader, QString *error)
+{
+    mRegisters.clear();
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(json, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        if (error)
+            *error = parseError.errorString();
+        return false;
+    }
+
+    QJsonArray entries = doc.object()["registers"].toArray();
+    if (entries.isEmpty()) {
+        if (error)
+            *error = QObject::tr("No registers defined");
+        return false;
+    }
+
+    // 同一模板被多个寄存器引用时只读取、编译一次
+    QHash<QString, LayoutDecoder> decoders;
+    for (int i = 0; i < entries.size(); i++) {
+        QJsonObject entry = entries.at(i).toObject();
+        RegisterDef reg;
+        if (!parseAddress(entry["address"], &reg.begin)) {
+            if (error)
+                *error = QObject::tr("Register %1: invalid address").arg(i);
+            return false;
+        }
+        if (!entry.contains("end"))
+            reg.last = reg.begin;
+        else if (!parseAddress(entry["end"], &reg.last) || (reg.last < reg.begin)) {
+            if (error)
+                *error = QObject::tr("Register %1: invalid end address").arg(i);
+            return false;
+        }
+
+        QString templateName = entry["template"].toString();
+        reg.name = entry["name"].toString(templateName);
+        if (!decoders.contains(templateName)) {
+            DescLayout layout;
+            if (templateName.isEmpty() || !loader(templateName, &layout) || layout.isEmpty()) {
+                if (error)
+                    *error = QObject::tr("Register %1: cannot load template \"%2\"").arg(reg.name, templateName);
+                return false;
+            }
+            if (layout.dwCount != 1) {
+                if (error)
+                    *error = QObject::tr("Register %1: template \"%2\" must have exactly one DW").arg(reg.name, templateName);
+                return false;
+            }
+            decoders.insert(templateName, LayoutDecoder(layout));
+        }
+        reg.decoder = decoders.value(templateName);
+        mRegisters.push_back(reg);
+    }
+
+    std::sort(mRegisters.begin(), mRegisters.end(), [](const RegisterDef &a, const RegisterDef &b) {
+        return a.begin < b.begin;
+    });
+    for (int i = 1; i < mRegisters.size(); i++) {
+        if (mRegisters.at(i).begin <= mRegisters.at(i - 1).last) {
+            if (error)
+                *error = QObject::tr("Registers %1 and %2 overlap").arg(mRegisters.at(i - 1).name, mRegisters.at(i).name);
+            mRegisters.clear();
+            return false;
+        }
+    }
+
+    qDebug("%s[%d]: %d registers", __func__, __LINE__, mRegisters.size());
+    return true;
+}
+
+int RegisterMap::find(quint64 address, int hint) const
+{
+    if ((hint >= 0) && (hint < mRegisters.size())) {
+        const RegisterDef &reg = mRegisters.at(hint);
+        if ((address >= reg.begin) && (address <= reg.last))
+            return hint;
+    }
+
+    // 第一个起始地址大于 address 的区间的前一个
+    auto it = std::upper_bound(mRegisters.constBegin(), mRegisters.constEnd(), address,
+                               [](quint64 addr, const RegisterDef &reg) { return addr < reg.begin; });
+    if (it == mRegisters.constBegin())
+        return -1;
+    --it;
+    return (address <= it->last) ? static_cast<int>(it - mRegisters.constBegin()) : -1;
+}
+
+void RegisterMap::decode(int reg, uint32_t value, QVector<quint64> &values) const
+{
+    mRegisters.at(reg).decoder.decodeGroup(&value, values);
+}
+
+QString RegisterMap::describe(int reg, uint32_t value) const
+{
+    const RegisterDef &def = mRegisters.at(reg);
+    QVector<quint64> values;
+    decode(reg, value, values);
+
+    QString text;
+    for (int f = 0; f < values.size(); f++) {
+        if (f > 0)
+            text += "  ";
+        text += def.decoder.layout().fields.at(f).name + '=' + def.decoder.formatter(f).format(values.at(f));
+    }
+    return text;
+}
@@ -0,0 +1,50 @@
+#ifndef REGISTERMAP_H
+#define REGISTERMAP_H
+
+#include <functional>
+#include <QString>
+#include <QVector>
+#include "descobj.h"
+#include "layoutdecoder.h"
+
+// 寄存器映射：按地址选择解析模板，用于解析 MMIO 访问记录中的 "地址 数值" 行。
+// 映射文件为 JSON：
+//   {"registers": [
+//       {"address": "0x1000", "template": "ctrl"},                         单个地址
+//       {"address": "0x2000", "end": "0x2fff", "template": "fifo", "name": "FIFO"}  地址区间，end 包含在内
+//   ]}
+// 模板只能有一个 DW。各区间按起始地址排序后二分查找，区间不能重叠。
+struct RegisterDef
+{
+    quint64 begin;
+    // 区间最后一个地址（包含），区间可以到 0xffffffffffffffff
+    quint64 last;
+    QString name;
+    LayoutDecoder decoder;
+};
+
+class RegisterMap
+{
+public:
+    // 按模板名称读取编译好的模板
+    typedef std::function<bool(const QString &, DescLayout *)> TemplateLoader;
+
+    bool load(const QByteArray &json, const TemplateLoader &loader, QString *error = nullptr);
+    void clear() { mRegisters.clear(); }
+
+    int count() const { return mRegisters.size(); }
+    const RegisterDef &at(int reg) const { return mRegisters.at(reg); }
+    // 包含 address 的寄存器序号，找不到返回 -1
+    // 访问记录中常连续访问同一寄存器，hint 为上一次的结果时先检查它
+    int find(quint64 address, int hint = -1) const;
+
+    // 按寄存器的模板解析 value，values 依次为各字段的值
+    void decode(int reg, uint32_t value, QVector<quint64> &values) const;
+    // "字段=值" 形式的解析结果，按模板指定的显示格式
+    QString describe(int reg, uint32_t value) const;
+
+private:
+    QVector<RegisterDef> mRegisters;
+};
+
+#endif // REGISTERMAP_H
@@ -0,0 +1,106 @@
+#include <climits>
+#include <cstring>
+#include <QDebug>
+#include <QFile>
+#include <QObject>
+#include "dwordtokenizer.h"
+#include "registertrace.h"
+
+// 每次读取的字节数
+static const qint64 kReadChunk = 16 * 1024 * 1024;
+// 访问记录数上限：Qt5 的 QVector 数据不能超过 2 GB（含头部），最大的元素为 mAddresses 的 quint64
+static const int kMaxAccesses = static_cast<int>((INT_MAX - 64) / sizeof(quint64));
+
+RegisterTrace::RegisterTrace()
+    : mUnmapped(0)
+    , mSkipped(0)
+    , cancelled(false)
+    , total(0)
+    , done(0)
+{
+}
+
+bool RegisterTrace::load(const QString &path, const RegisterMap &map, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    mAddresses.clear();
+    mValues.clear();
+    mRegs.clear();
+    mCounts = QVector<qint64>(map.count(), 0);
+    mUnmapped = 0;
+    mSkipped = 0;
+    total = file.size();
+    done = 0;
+
+    QByteArray carry;
+    int hint = -1;
+    bool reserved = false;
+    while (true) {
+        if (cancelled) {
+            if (error)
+                *error = QObject::tr("Loading cancelled");
+            return false;
+        }
+
+        QByteArray chunk = file.read(kReadChunk);
+        bool atEnd = chunk.isEmpty();
+        done += chunk.size();
+        carry += chunk;
+
+        const char *p = carry.constData();
+        const char *end = p + carry.size();
+        while (p < end) {
+            const char *eol = static_cast<const char *>(memchr(p, '\n', static_cast<size_t>(end - p)));
+            if (eol == nullptr) {
+                if (!atEnd)
+                    break;
+                eol = end;
+            }
+
+            quint64 address;
+            uint32_t value;
+            if (DwordTokenizer::parseAddressValue(p, eol, &address, &value)) {
+                if (mValues.size() >= kMaxAccesses) {
+                    if (error)
+                        *error = QObject::tr("Too many accesses");
+                    return false;
+                }
+                // 相邻的访问通常落在同一寄存器，先检查上一次的结果
+                hint = map.find(address, hint);
+                mAddresses.push_back(address);
+                mValues.push_back(value);
+                mRegs.push_back(hint);
+                if (hint >= 0)
+                    mCounts[hint]++;
+                else
+                    mUnmapped++;
+            } else if (eol - p > 1) {
+                mSkipped++;
+            }
+            p = (eol < end) ? eol + 1 : end;
+        }
+
+        // 按第一块的平均行长估算总行数，避免数组反复扩容
+        if (!reserved && (mValues.size() > 0)) {
+            qint64 estimate = qMin<qint64>(total * mValues.size() / qMax<qint64>(1, done) * 11 / 10, kMaxAccesses);
+            mAddresses.reserve(static_cast<int>(estimate));
+            mValues.reserve(static_cast<int>(estimate));
+            mRegs.reserve(static_cast<int>(estimate));
+            reserved = true;
+        }
+
+        carry.remove(0, static_cast<int>(p - carry.constData()));
+        if (atEnd)
+            break;
+    }
+
+    qDebug("%s[%d]: %d accesses, %lld unmapped, %lld lines skipped", __func__, __LINE__,
+           mValues.size(), mUnmapped, mSkipped);
+    return true;
+}
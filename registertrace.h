@@ -0,0 +1,46 @@
+#ifndef REGISTERTRACE_H
+#define REGISTERTRACE_H
+
+#include <atomic>
+#include <QString>
+#include <QVector>
+#include "registermap.h"
+
+// MMIO 访问记录
+// 单遍读取文本文件，每行解析出地址和数值，同时按寄存器映射查找寄存器，
+// 只保存地址、数值和寄存器序号，字段在显示时才按寄存器的模板解析。
+// load() 在调用线程中执行，界面通过 QtConcurrent 在后台线程调用，期间可以查询进度或取消。
+class RegisterTrace
+{
+public:
+    RegisterTrace();
+
+    bool load(const QString &path, const RegisterMap &map, QString *error = nullptr);
+    void cancel() { cancelled = true; }
+    bool isCancelled() const { return cancelled; }
+    qint64 totalBytes() const { return total; }
+    qint64 loadedBytes() const { return done; }
+
+    int count() const { return mValues.size(); }
+    quint64 address(int i) const { return mAddresses.at(i); }
+    uint32_t value(int i) const { return mValues.at(i); }
+    // 没有对应寄存器时为 -1
+    int registerOf(int i) const { return mRegs.at(i); }
+    // 各寄存器的访问次数
+    const QVector<qint64> &registerCounts() const { return mCounts; }
+    qint64 unmappedCount() const { return mUnmapped; }
+    qint64 skippedLines() const { return mSkipped; }
+
+private:
+    QVector<quint64> mAddresses;
+    QVector<uint32_t> mValues;
+    QVector<int> mRegs;
+    QVector<qint64> mCounts;
+    qint64 mUnmapped;
+    qint64 mSkipped;
+    std::atomic<bool> cancelled;
+    std::atomic<qint64> total;
+    std::atomic<qint64> done;
+};
+
+#endif // REGISTERTRACE_H
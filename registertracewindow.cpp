@@ -0,0 +1,126 @@
+#include <QBrush>
+#include <QDebug>
+#include <QFileInfo>
+#include "backgroundtask.h"
+#include "registertracewindow.h"
+
+RegisterTraceModel::RegisterTraceModel(const RegisterMap *map, const RegisterTrace *trace, QObject *parent)
+    : QAbstractTableModel(parent)
+    , map(map)
+    , trace(trace)
+    , rows(0)
+{
+}
+
+void RegisterTraceModel::reload()
+{
+    beginResetModel();
+    rows = trace->count();
+    endResetModel();
+}
+
+int RegisterTraceModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : rows;
+}
+
+int RegisterTraceModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 5;
+}
+
+QVariant RegisterTraceModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (index.row() >= rows))
+        return QVariant();
+
+    int row = index.row();
+    int reg = trace->registerOf(row);
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case 0:
+            return row;
+        case 1:
+            return QString::asprintf("0x%llx", trace->address(row));
+        case 2:
+            return (reg >= 0) ? map->at(reg).name : tr("(unmapped)");
+        case 3:
+            return QString::asprintf("0x%08x", trace->value(row));
+        case 4:
+            return (reg >= 0) ? map->describe(reg, trace->value(row)) : QString();
+        default:
+            break;
+        }
+    } else if ((role == Qt::TextAlignmentRole) && (index.column() <= 1)) {
+        return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+    } else if ((role == Qt::ForegroundRole) && (reg < 0)) {
+        return QBrush(Qt::gray);
+    }
+    return QVariant();
+}
+
+QVariant RegisterTraceModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if ((orientation != Qt::Horizontal) || (role != Qt::DisplayRole))
+        return QVariant();
+    switch (section) {
+    case 0:
+        return tr("Access");
+    case 1:
+        return tr("Address");
+    case 2:
+        return tr("Register");
+    case 3:
+        return tr("Value");
+    case 4:
+        return tr("Fields");
+    default:
+        return QVariant();
+    }
+}
+
+RegisterTraceWin::RegisterTraceWin(QWidget *parent, const RegisterMap &map)
+    : QDialog(parent)
+    , ui(new Ui::RegisterTraceWin)
+    , mMap(map)
+{
+    ui->setupUi(this);
+    model = new RegisterTraceModel(&mMap, &mTrace, this);
+    ui->traceTable->setModel(model);
+}
+
+RegisterTraceWin::~RegisterTraceWin()
+{
+    delete ui;
+}
+
+bool RegisterTraceWin::loadTrace(const QString &path, QString *error)
+{
+    bool ok = false;
+    QString loadError;
+    BackgroundTask::run(parentWidget(), tr("Decoding %1...").arg(QFileInfo(path).fileName()),
+        [&]() { ok = mTrace.load(path, mMap, &loadError); },
+        [&]() { return static_cast<int>(mTrace.loadedBytes() * 1000 / qMax<qint64>(1, mTrace.totalBytes())); },
+        [&]() { mTrace.cancel(); });
+
+    if (!ok) {
+        if (error)
+            *error = loadError;
+        return false;
+    }
+
+    int hitRegisters = 0;
+    for (qint64 count : mTrace.registerCounts()) {
+        if (count > 0)
+            hitRegisters++;
+    }
+    ui->summaryLabel->setText(tr("Accesses: %1    Registers accessed: %2 / %3    Unmapped: %4    Skipped lines: %5")
+                              .arg(mTrace.count()).arg(hitRegisters).arg(mMap.count())
+                              .arg(mTrace.unmappedCount()).arg(mTrace.skippedLines()));
+    model->reload();
+    ui->traceTable->resizeColumnToContents(0);
+    ui->traceTable->resizeColumnToContents(1);
+    ui->traceTable->resizeColumnToContents(2);
+    ui->traceTable->resizeColumnToContents(3);
+    return true;
+}
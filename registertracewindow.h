@@ -0,0 +1,88 @@
+#ifndef REGISTERTRACEWINDOW_H
+#define REGISTERTRACEWINDOW_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <QAbstractTableModel>
+#include "registermap.h"
+#include "registertrace.h"
+#include "tableview.h"
+
+QT_BEGIN_NAMESPACE
+
+class UiRegisterTraceWin
+{
+public:
+    QVBoxLayout *contentLayout;
+    QLabel *summaryLabel;
+    TableView *traceTable;
+
+    void setupUi(QDialog *dialog)
+    {
+        dialog->setWindowTitle(QObject::tr("Register Trace"));
+        dialog->resize(1000, 600);
+
+        contentLayout = new QVBoxLayout(dialog);
+
+        summaryLabel = new QLabel(dialog);
+        summaryLabel->setObjectName(QString::fromUtf8("summaryLabel"));
+        summaryLabel->setWordWrap(true);
+        contentLayout->addWidget(summaryLabel);
+
+        traceTable = new TableView(dialog);
+        traceTable->setObjectName(QString::fromUtf8("traceTable"));
+        traceTable->verticalHeader()->setVisible(false);
+        // 设置内容不可编辑
+        traceTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        contentLayout->addWidget(traceTable);
+    }
+};
+
+namespace Ui {
+    class RegisterTraceWin: public UiRegisterTraceWin {};
+} // namespace Ui
+
+QT_END_NAMESPACE
+
+// 访问记录表格，每行一次访问，字段在显示时按寄存器的模板解析
+class RegisterTraceModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    RegisterTraceModel(const RegisterMap *map, const RegisterTrace *trace, QObject *parent = nullptr);
+
+    void reload();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    const RegisterMap *map;
+    const RegisterTrace *trace;
+    int rows;
+};
+
+// 按寄存器映射解析 MMIO 访问记录的窗口
+class RegisterTraceWin : public QDialog
+{
+    Q_OBJECT
+public:
+    RegisterTraceWin(QWidget *parent, const RegisterMap &map);
+    ~RegisterTraceWin();
+
+    // 在工作线程中读取访问记录，可以取消
+    bool loadTrace(const QString &path, QString *error);
+    bool isCancelled() const { return mTrace.isCancelled(); }
+
+private:
+    Ui::RegisterTraceWin *ui;
+    RegisterMap mMap;
+    RegisterTrace mTrace;
+    RegisterTraceModel *model;
+};
+
+#endif // REGISTERTRACEWINDOW_H
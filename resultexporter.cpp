@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <QDebug>
+#include <QObject>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+#include "resultexporter.h"
+
+// 每次解析和写入的组数
+static const int kChunkGroups = 64 * 1024;
+
+static QByteArray csvField(const QByteArray &text)
+{
+    if (!text.contains(',') && !text.contains('"') && !text.contains('\n') && !text.contains('\r'))
+        return text;
+    QByteArray quoted = text;
+    quoted.replace("\"", "\"\"");
+    return '"' + quoted + '"';
+}
+
+static QByteArray jsonString(const QByteArray &text)
+{
+    QByteArray out = "\"";
+    for (char c : text) {
+        if ((c == '"') || (c == '\\')) {
+            out += '\\';
+            out += c;
+        } else if (static_cast<uchar>(c) < 0x20) {
+            out += QByteArray("\\u00") + QByteArray::number(static_cast<uchar>(c), 16).rightJustified(2, '0');
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+    return out;
+}
+
+ResultExporter::ResultExporter(const ResultStore *store, const DescLayout &layout)
+    : store(store)
+    , decoder(layout)
+    , columns(layout.fieldCount())
+    , cancelled(false)
+    , done(0)
+{
+}
+
+// 与 Format 顺序一致
+static const char *const kSuffixes[] = {"csv", "jsonl", "spc"};
+
+QString ResultExporter::fileFilters()
+{
+    return QObject::tr("CSV (*.csv);;JSON Lines (*.jsonl);;Columnar binary (*.spc)");
+}
+
+bool ResultExporter::formatForPath(QString *path, const QString &selectedFilter, Format *format)
+{
+    QString suffix = QFileInfo(*path).suffix().toLower();
+    if (suffix.isEmpty()) {
+        int index = fileFilters().split(";;").indexOf(selectedFilter);
+        if (index < 0)
+            return false;
+        *format = static_cast<Format>(index);
+        *path += QString(".") + kSuffixes[index];
+        return true;
+    }
+    for (int i = 0; i < static_cast<int>(sizeof(kSuffixes) / sizeof(kSuffixes[0])); i++) {
+        if (suffix == kSuffixes[i]) {
+            *format = static_cast<Format>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ResultExporter::decodeChunk(qint64 first, int count)
+{
+    int stride = store->dwordsPerGroup();
+    dwords.resize(count * stride);
+    for (int i = 0; i < count; i++) {
+        uint32_t *group = dwords.data() + i * stride;
+        if (!store->readGroup(first + i, group))
+            std::fill(group, group + stride, 0);
+    }
+    decoder.decodeColumns(dwords.constData(), stride, count, columns);
+}
+
+void ResultExporter::appendValue(int field, quint64 value, bool json, QByteArray &out) const
+{
+    const FieldFormatter &formatter = decoder.formatter(field);
+    switch (formatter.formatType()) {
+    case FieldFormatter::Unsigned:
+        out += QByteArray::number(value);
+        break;
+    case FieldFormatter::Signed:
+    case FieldFormatter::Fixed:
+    case FieldFormatter::Bool:
+        // 数字和 true/false 在 CSV 和 JSON 中都可以直接写出
+        out += formatter.format(value).toLatin1();
+        break;
+    default:
+        out += json ? jsonString(formatter.format(value).toUtf8()) : csvField(formatter.format(value).toUtf8());
+        break;
+    }
+}
+
+void ResultExporter::appendCsvChunk(qint64 first, int count, QByteArray &out) const
+{
+    for (int i = 0; i < count; i++) {
+        out += QByteArray::number(first + i);
+        for (int f = 0; f < columns.size(); f++) {
+            out += ',';
+            appendValue(f, columns.at(f).at(i), false, out);
+        }
+        out += '\n';
+    }
+}
+
+void ResultExporter::appendJsonChunk(qint64 first, int count, QByteArray &out) const
+{
+    // 键名只转义一次
+    QVector<QByteArray> keys;
+    for (const DescFieldSpec &spec : decoder.layout().fields)
+        keys.push_back(',' + jsonString(spec.name.toUtf8()) + ':');
+
+    for (int i = 0; i < count; i++) {
+        out += "{\"group\":";
+        out += QByteArray::number(first + i);
+        for (int f = 0; f < columns.size(); f++) {
+            out += keys.at(f);
+            appendValue(f, columns.at(f).at(i), true, out);
+        }
+        out += "}\n";
+    }
+}
+
+bool ResultExporter::writeColumnarHeader(QFileDevice &file, QVector<qint64> &offsets, QString *error) const
+{
+    QByteArray header(24, '\0');
+    qToLittleEndian<quint32>(kColumnarMagic, header.data());
+    qToLittleEndian<quint32>(kColumnarVersion, header.data() + 4);
+    qToLittleEndian<quint64>(static_cast<quint64>(totalGroups()), header.data() + 8);
+    qToLittleEndian<quint32>(static_cast<quint32>(decoder.layout().fieldCount()), header.data() + 16);
+
+    // 先计算字段描述的总长度，再确定各数组的位置
+    QVector<QByteArray> names;
+    qint64 descEnd = header.size();
+    for (const DescFieldSpec &spec : decoder.layout().fields) {
+        QByteArray name = spec.name.toUtf8();
+        names.push_back(name);
+        descEnd += 16 + ((name.size() + 7) & ~7);
+    }
+
+    qint64 offset = (descEnd + 63) & ~qint64(63);
+    for (int f = 0; f < decoder.layout().fieldCount(); f++) {
+        int elementSize = decoder.layout().fields.at(f).isDerived() ? 8 : 4;
+        offsets.push_back(offset);
+
+        QByteArray desc(16, '\0');
+        qToLittleEndian<quint32>(static_cast<quint32>(names.at(f).size()), desc.data());
+        qToLittleEndian<quint32>(static_cast<quint32>(elementSize), desc.data() + 4);
+        qToLittleEndian<quint64>(static_cast<quint64>(offset), desc.data() + 8);
+        header += desc;
+        header += names.at(f);
+        header += QByteArray(((names.at(f).size() + 7) & ~7) - names.at(f).size(), '\0');
+
+        offset = (offset + totalGroups() * elementSize + 63) & ~qint64(63);
+    }
+
+    if (file.write(header) != header.size()) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool ResultExporter::exportTo(const QString &path, Format format, QString *error)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    QVector<qint64> offsets;
+    if (format == Csv) {
+        QByteArray header = "group";
+        for (const DescFieldSpec &spec : decoder.layout().fields)
+            header += ',' + csvField(spec.name.toUtf8());
+        header += '\n';
+        if (file.write(header) != header.size()) {
+            if (error)
+                *error = file.errorString();
+            file.cancelWriting();
+            return false;
+        }
+    } else if ((format == Columnar) && !writeColumnarHeader(file, offsets, error)) {
+        file.cancelWriting();
+        return false;
+    }
+
+    qint64 first = store->firstGroup();
+    qint64 total = totalGroups();
+    QByteArray buffer;
+    for (qint64 rel = 0; rel < total; rel += kChunkGroups) {
+        if (cancelled) {
+            file.cancelWriting();
+            if (error)
+                *error = QObject::tr("Export cancelled");
+            return false;
+        }
+
+        int count = static_cast<int>(qMin<qint64>(kChunkGroups, total - rel));
+        decodeChunk(first + rel, count);
+
+        bool ok = true;
+        if (format == Columnar) {
+            // 每个字段的数组各写一段
+            for (int f = 0; ok && (f < columns.size()); f++) {
+                int elementSize = decoder.layout().fields.at(f).isDerived() ? 8 : 4;
+                buffer.resize(count * elementSize);
+                for (int i = 0; i < count; i++) {
+                    if (elementSize == 8)
+                        qToLittleEndian<quint64>(columns.at(f).at(i), buffer.data() + i * 8);
+                    else
+                        qToLittleEndian<quint32>(static_cast<quint32>(columns.at(f).at(i)), buffer.data() + i * 4);
+                }
+                ok = file.seek(offsets.at(f) + rel * elementSize) && (file.write(buffer) == buffer.size());
+            }
+        } else {
+            buffer.clear();
+            if (format == Csv)
+                appendCsvChunk(first + rel, count, buffer);
+            else
+                appendJsonChunk(first + rel, count, buffer);
+            ok = (file.write(buffer) == buffer.size());
+        }
+
+        if (!ok) {
+            if (error)
+                *error = file.errorString();
+            file.cancelWriting();
+            return false;
+        }
+        done = rel + count;
+    }
+
+    // 最后一个数组末尾补齐，文件长度与描述一致
+    if ((format == Columnar) && !offsets.isEmpty()) {
+        int last = offsets.size() - 1;
+        qint64 end = offsets.at(last) + total * (decoder.layout().fields.at(last).isDerived() ? 8 : 4);
+        if (!file.resize(end)) {
+            if (error)
+                *error = file.errorString();
+            file.cancelWriting();
+            return false;
+        }
+    }
+    if (!file.commit()) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    qDebug("%s[%d]: exported %lld groups to %s", __func__, __LINE__, total, qPrintable(path));
+    return true;
+}
@@ -0,0 +1,58 @@
+#ifndef RESULTEXPORTER_H
+#define RESULTEXPORTER_H
+
+#include <atomic>
+#include <QFileDevice>
+#include <QString>
+#include <QVector>
+#include "layoutdecoder.h"
+#include "resultstore.h"
+
+// 解析结果导出
+// 直接从数据存储按块读取、解析并写入文件，不经过模型，也不生成完整的文本。
+// exportTo() 在调用线程中执行，界面通过 QtConcurrent 在后台线程调用，
+// 期间可以查询进度或取消。先写入临时文件，完成后才替换目标文件，失败或取消时不留下不完整的文件。
+//
+// 列式二进制文件（.spc）格式，均为小端序：
+//   文件头     uint32 magic "SPCL"，uint32 version，uint64 groupCount，uint32 fieldCount，uint32 reserved
+//   字段描述   每个字段 uint32 nameLength，uint32 elementSize（位字段 4，派生字段 8），
+//             uint64 dataOffset，UTF-8 名称（补齐到 8 字节）
+//   数据       每个字段 groupCount 个元素的连续数组，起始位置按 64 字节对齐，可直接映射
+class ResultExporter
+{
+public:
+    enum Format { Csv, JsonLines, Columnar };
+
+    static const uint32_t kColumnarMagic = 0x4C435053;   // "SPCL"
+    static const uint32_t kColumnarVersion = 1;
+
+    ResultExporter(const ResultStore *store, const DescLayout &layout);
+
+    // 保存对话框的文件过滤器，顺序与 Format 一致
+    static QString fileFilters();
+    // 按文件后缀选择格式：.csv、.jsonl、.spc；没有后缀时按选中的过滤器确定格式并补上后缀，
+    // 其它后缀返回 false
+    static bool formatForPath(QString *path, const QString &selectedFilter, Format *format);
+
+    bool exportTo(const QString &path, Format format, QString *error = nullptr);
+    void cancel() { cancelled = true; }
+    qint64 totalGroups() const { return store->groupCount(); }
+    qint64 exportedGroups() const { return done; }
+
+private:
+    // 解析 [first, first + count) 组，columns[field][i] 为第 i 组的字段值
+    void decodeChunk(qint64 first, int count);
+    void appendCsvChunk(qint64 first, int count, QByteArray &out) const;
+    void appendJsonChunk(qint64 first, int count, QByteArray &out) const;
+    void appendValue(int field, quint64 value, bool json, QByteArray &out) const;
+    bool writeColumnarHeader(QFileDevice &file, QVector<qint64> &offsets, QString *error) const;
+
+    const ResultStore *store;
+    LayoutDecoder decoder;
+    QVector<uint32_t> dwords;
+    QVector<QVector<quint64>> columns;
+    std::atomic<bool> cancelled;
+    std::atomic<qint64> done;
+};
+
+#endif // RESULTEXPORTER_H
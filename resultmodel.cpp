@@ -0,0 +1,684 @@
+#include <climits>
+#include <QBrush>
+#include <QFont>
+#include <QDebug>
+#include <QtConcurrent>
+#include "resultmodel.h"
+#include "tableview.h"
+
+// 单页解析的字段值个数上限，以及缓存的字段值总数上限
+static const int kPageValues = 16 * 1024;
+static const int kCacheValues = 4 * 1024 * 1024;
+// 差异计算每个并行任务处理的组数，以及每次通知视图插入的组数
+static const int kDeltaChunkGroups = 4096;
+static const int kDeltaBatchGroups = 1024 * 1024;
+
+// 相邻组按 DWORD 异或：dst[i] = src[i + stride] ^ src[i]
+// 保持简单的连续循环，便于编译器自动向量化
+static void xorAdjacentGroups(const uint32_t *__restrict src, uint32_t *__restrict dst, int count, int stride)
+{
+    for (int i = 0; i < count; i++)
+        dst[i] = src[i + stride] ^ src[i];
+}
+
+ResultModel::ResultModel(ResultStore *store, QObject *parent)
+    : QAbstractTableModel(parent)
+    , store(store)
+    , decoder()
+    , multiGroup(false)
+    , previewStride(1)
+    , mHighlightField(-1)
+    , deltaMode(false)
+    , baseGroup(0)
+    , windowBegin(0)
+    , windowEnd(LLONG_MAX)
+    , timeShown(false)
+    , rowIndex()
+    , pageGroups(1)
+{
+    pageCache.setMaxCost(kCacheValues);
+}
+
+void ResultModel::setDescLayout(const DescLayout &layout)
+{
+    beginResetModel();
+    decoder.setLayout(layout);
+    mHighlightField = -1;
+    pageGroups = qMax(1, kPageValues / qMax(1, layout.fieldCount()));
+    windowBegin = 0;
+    windowEnd = LLONG_MAX;
+    resetRows();
+    endResetModel();
+}
+
+void ResultModel::setMultiGroup(bool multi)
+{
+    if (multiGroup == multi)
+        return;
+    beginResetModel();
+    multiGroup = multi;
+    // 重新按当前模式建立行映射
+    resetRows();
+    endResetModel();
+}
+
+void ResultModel::setPreviewStride(int stride)
+{
+    beginResetModel();
+    previewStride = qMax(1, stride);
+    resetRows();
+    endResetModel();
+}
+
+void ResultModel::reset()
+{
+    beginResetModel();
+    windowBegin = 0;
+    windowEnd = LLONG_MAX;
+    resetRows();
+    endResetModel();
+}
+
+void ResultModel::setGroupWindow(qint64 begin, qint64 end)
+{
+    beginResetModel();
+    windowBegin = qMax<qint64>(0, begin);
+    windowEnd = qMax(windowBegin, end);
+    resetRows();
+    endResetModel();
+}
+
+void ResultModel::setDeltaMode(bool delta)
+{
+    if (deltaMode == delta)
+        return;
+    beginResetModel();
+    deltaMode = delta;
+    resetRows();
+    endResetModel();
+}
+
+void ResultModel::resetRows()
+{
+    pageCache.clear();
+    baseGroup = qMax(store->firstGroup(), windowBegin);
+    timeShown = store->timeIndex().isActive();
+    // 差异视图各组行数不同，使用前缀和映射，变化的字段在解析页面时才计算
+    rowIndex.reset(isDeltaMode() ? 0 : fieldCount());
+}
+
+void ResultModel::syncGroups()
+{
+    // 跟踪文件时收到第一个时间戳后才增加时间列
+    if (!timeShown && store->timeIndex().isActive()) {
+        int column = baseColumnCount();
+        bool visible = (column > 3);
+        if (visible)
+            beginInsertColumns(QModelIndex(), column, column);
+        timeShown = true;
+        if (visible)
+            endInsertColumns();
+    }
+
+    // 旧数据已被丢弃，先删除对应的行
+    qint64 dropped = qMin(store->firstGroup() - baseGroup, rowIndex.groupCount());
+    if (multiGroup && (dropped > 0)) {
+        qint64 lastRow = qMin<qint64>(rowIndex.firstRowOf(dropped), INT_MAX) - 1;
+        if (lastRow >= 0)
+            beginRemoveRows(QModelIndex(), 0, static_cast<int>(lastRow));
+        baseGroup = store->firstGroup();
+        rowIndex.dropFront(dropped);
+        if (lastRow >= 0)
+            endRemoveRows();
+    } else if (multiGroup && (store->firstGroup() > baseGroup)) {
+        baseGroup = store->firstGroup();
+    }
+
+    qint64 groups = availableGroups();
+    qint64 added = groups - rowIndex.groupCount();
+    if (added <= 0)
+        return;
+
+    if (isDeltaMode()) {
+        // 只保存各组的行数，分批统计，每批的行数不超过 int
+        while (added > 0) {
+            int count = static_cast<int>(qMin<qint64>(added, kDeltaBatchGroups));
+            QVector<int> rows = countDeltaRows(baseGroup + rowIndex.groupCount(), count);
+            qint64 total = 0;
+            for (int n : rows)
+                total += n;
+
+            qint64 firstRow = rowIndex.rowCount();
+            qint64 lastRow = qMin<qint64>(firstRow + total, INT_MAX) - 1;
+            bool notify = (lastRow >= firstRow);
+            if (notify)
+                beginInsertRows(QModelIndex(), static_cast<int>(firstRow), static_cast<int>(lastRow));
+            for (int n : rows)
+                rowIndex.appendGroup(n);
+            if (notify)
+                endInsertRows();
+            added -= count;
+        }
+        return;
+    }
+
+    qint64 firstRow = rowIndex.rowCount();
+    qint64 lastRow = qMin<qint64>(firstRow + added * fieldCount(), INT_MAX) - 1;
+    if (lastRow < firstRow) {
+        rowIndex.appendGroups(added);
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), static_cast<int>(firstRow), static_cast<int>(lastRow));
+    rowIndex.appendGroups(added);
+    endInsertRows();
+}
+
+qint64 ResultModel::availableGroups() const
+{
+    if (decoder.layout().isEmpty())
+        return 0;
+    qint64 groups = qMax<qint64>(0, qMin(store->endGroup(), windowEnd) - baseGroup);
+    return multiGroup ? groups : qMin<qint64>(groups, 1);
+}
+
+QVector<int> ResultModel::countDeltaRows(qint64 firstAbs, int count) const
+{
+    struct Task { qint64 start; int count; int offset; };
+
+    QVector<int> rows(count);
+    QVector<Task> tasks;
+    for (int i = 0; i < count; i += kDeltaChunkGroups)
+        tasks.push_back({firstAbs + i, qMin(kDeltaChunkGroups, count - i), i});
+
+    int *out = rows.data();
+    QtConcurrent::blockingMap(tasks, [this, out](const Task &task) {
+        int dwPerGroup = store->dwordsPerGroup();
+        QVector<uint32_t> raw((task.count + 1) * dwPerGroup);
+        QVector<uint32_t> diff(task.count * dwPerGroup);
+
+        // raw 中第一组是前一组，之后是本批各组
+        bool hasPrev = store->readGroup(task.start - 1, raw.data());
+        for (int i = 0; i < task.count; i++)
+            store->readGroup(task.start + i, raw.data() + (i + 1) * dwPerGroup);
+        xorAdjacentGroups(raw.constData(), diff.data(), task.count * dwPerGroup, dwPerGroup);
+
+        for (int i = 0; i < task.count; i++) {
+            // 没有前一组时显示全部字段
+            if ((i == 0) && !hasPrev) {
+                out[task.offset] = decoder.layout().rawFieldCount();
+                continue;
+            }
+            // 派生字段不参与差异比较
+            const uint32_t *groupDiff = diff.constData() + i * dwPerGroup;
+            int shown = 0;
+            for (int f = 0; f < decoder.layout().rawFieldCount(); f++) {
+                const DescFieldSpec &spec = decoder.layout().fields.at(f);
+                if ((groupDiff[spec.dwIdx] >> spec.lsb) & decoder.widthMask(f))
+                    shown++;
+            }
+            out[task.offset + i] = shown;
+        }
+    });
+    return rows;
+}
+
+void ResultModel::changedFields(const uint32_t *dwords, const uint32_t *prev, int rows, QVector<int> &fields) const
+{
+    // 统计行数后前一组可能已被丢弃，按统计的行数显示前几个字段
+    if (prev == nullptr) {
+        for (int f = 0; f < qMin(rows, decoder.layout().rawFieldCount()); f++)
+            fields.push_back(f);
+        return;
+    }
+    for (int f = 0; f < decoder.layout().rawFieldCount(); f++) {
+        const DescFieldSpec &spec = decoder.layout().fields.at(f);
+        if (((dwords[spec.dwIdx] ^ prev[spec.dwIdx]) >> spec.lsb) & decoder.widthMask(f))
+            fields.push_back(f);
+    }
+}
+
+bool ResultModel::locateRow(int row, qint64 *group, int *field) const
+{
+    qint64 g = rowIndex.groupOfRow(row);
+    if (g < 0)
+        return false;
+    if (group)
+        *group = g;
+    if (field) {
+        int offset = static_cast<int>(row - rowIndex.firstRowOf(g));
+        if (isDeltaMode()) {
+            const DecodedPage *page = decodedPage((baseGroup + g) / pageGroups);
+            int i = page->deltaStarts.at(static_cast<int>(baseGroup + g - page->first)) + offset;
+            if (i >= page->deltaFields.size())
+                return false;
+            offset = page->deltaFields.at(i);
+        }
+        *field = offset;
+    }
+    return true;
+}
+
+int ResultModel::rowOfGroup(qint64 group) const
+{
+    if ((group < 0) || (group >= rowIndex.groupCount()))
+        return -1;
+    qint64 row = rowIndex.firstRowOf(group);
+    return (row < INT_MAX) ? static_cast<int>(row) : -1;
+}
+
+int ResultModel::rowOfField(qint64 group, int field) const
+{
+    if ((group < 0) || (group >= rowIndex.groupCount()) || (field < 0) || (field >= fieldCount()))
+        return -1;
+
+    qint64 row = rowIndex.firstRowOf(group);
+    if (isDeltaMode()) {
+        // 差异视图中该组只包含变化的字段，组内行数很少，顺序查找
+        const DecodedPage *page = decodedPage((baseGroup + group) / pageGroups);
+        int local = static_cast<int>(baseGroup + group - page->first);
+        int begin = page->deltaStarts.at(local);
+        int end = page->deltaStarts.at(local + 1);
+        int i = begin;
+        while ((i < end) && (page->deltaFields.at(i) != field))
+            i++;
+        if (i == end)
+            return -1;
+        row += i - begin;
+    } else {
+        row += field;
+    }
+    return (row < INT_MAX) ? static_cast<int>(row) : -1;
+}
+
+qint64 ResultModel::groupOfSource(qint64 sourceGroup) const
+{
+    if (sourceGroup % previewStride != 0)
+        return -1;
+    qint64 group = sourceGroup / previewStride - baseGroup;
+    return ((group >= 0) && (group < rowIndex.groupCount())) ? group : -1;
+}
+
+int ResultModel::fieldAt(int dwIdx, int lsb) const
+{
+    for (int i = 0; i < decoder.layout().fields.size(); i++) {
+        const DescFieldSpec &spec = decoder.layout().fields.at(i);
+        if ((spec.dwIdx == dwIdx) && (spec.lsb <= lsb) && (lsb <= spec.msb))
+            return i;
+    }
+    return -1;
+}
+
+void ResultModel::setHighlightField(int field)
+{
+    if (field == mHighlightField)
+        return;
+    mHighlightField = field;
+    // 背景色在 data() 中按字段序号计算，只需通知视图重绘
+    if (rowCount() > 0)
+        emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1), {Qt::BackgroundRole});
+}
+
+const ResultModel::DecodedPage *ResultModel::decodedPage(qint64 page) const
+{
+    // 页按绝对组号划分，丢弃旧数据后已缓存的页仍然有效
+    qint64 first = qMax(page * pageGroups, baseGroup);
+    qint64 end = qMin((page + 1) * pageGroups, baseGroup + rowIndex.groupCount());
+    qint64 groups = end - first;
+
+    // 页面解析后又追加或丢弃了组，需要重新解析
+    DecodedPage *cached = pageCache.object(page);
+    if (cached && (cached->first == first) && (cached->groups == groups))
+        return cached;
+
+    DecodedPage *decoded = new DecodedPage;
+    decoded->first = first;
+    decoded->groups = groups;
+    decoded->offsets.resize(static_cast<int>(groups));
+
+    QVector<uint32_t> dwords(store->dwordsPerGroup());
+    QVector<uint32_t> prev(store->dwordsPerGroup());
+    // 差异视图只为缓存中的页计算变化的字段
+    bool delta = isDeltaMode();
+    bool hasPrev = delta && store->readGroup(first - 1, prev.data());
+    if (delta)
+        decoded->deltaStarts.resize(static_cast<int>(groups) + 1);
+    for (qint64 g = first; g < end; g++) {
+        int local = static_cast<int>(g - first);
+        // 数据源已丢弃但视图尚未同步的组显示为 0
+        if (!store->readGroup(g, dwords.data()))
+            dwords.fill(0);
+        if (delta) {
+            decoded->deltaStarts[local] = decoded->deltaFields.size();
+            changedFields(dwords.constData(), hasPrev ? prev.constData() : nullptr,
+                          rowIndex.rowsOf(g - baseGroup), decoded->deltaFields);
+            hasPrev = true;
+        }
+        // 与前一组完全相同（如空闲的环形描述符），指向前一组的解析值
+        if ((g > first) && (dwords == prev)) {
+            decoded->offsets[local] = decoded->offsets.at(local - 1);
+            continue;
+        }
+        decoded->offsets[local] = decoded->values.size();
+        for (int f = 0; f < decoder.layout().rawFieldCount(); f++) {
+            const DescFieldSpec &spec = decoder.layout().fields.at(f);
+            decoded->values.push_back(DescObj::extractSubfield(dwords.at(spec.dwIdx), spec.lsb, spec.msb));
+        }
+        dwords.swap(prev);
+    }
+    decoded->values.squeeze();
+    if (delta)
+        decoded->deltaStarts[static_cast<int>(groups)] = decoded->deltaFields.size();
+    decoded->rows = (decoder.layout().rawFieldCount() > 0) ? (decoded->values.size() / decoder.layout().rawFieldCount())
+                                                  : static_cast<int>(qMin<qint64>(groups, 1));
+    computeDerived(decoded);
+
+    int cost = decoded->values.size() + decoded->offsets.size() + decoded->derivedValues.size() * 2
+            + decoded->deltaStarts.size() + decoded->deltaFields.size();
+    pageCache.insert(page, decoded, cost);
+    return decoded;
+}
+
+void ResultModel::computeDerived(DecodedPage *decoded) const
+{
+    const DescLayout &layout = decoder.layout();
+    int rawCount = layout.rawFieldCount();
+    int rows = decoded->rows;
+    decoded->derivedValues.resize(decoder.derivedCount() * rows);
+    if ((decoder.derivedCount() == 0) || (rows == 0))
+        return;
+
+    // 整页按列计算，引用到的位字段先转成 64 位列
+    QVector<QVector<quint64>> rawColumns(rawCount);
+    QVector<const quint64 *> columns(layout.fieldCount(), nullptr);
+    for (int field : decoder.derivedInputs()) {
+        QVector<quint64> &column = rawColumns[field];
+        column.resize(rows);
+        const uint32_t *src = decoded->values.constData() + field;
+        for (int r = 0; r < rows; r++)
+            column[r] = src[r * rawCount];
+        columns[field] = column.constData();
+    }
+    QVector<quint64 *> out(decoder.derivedCount());
+    for (int d = 0; d < out.size(); d++)
+        out[d] = decoded->derivedValues.data() + d * rows;
+    decoder.evaluateDerived(columns, rows, out);
+}
+
+quint64 ResultModel::fieldValue(qint64 group, int field) const
+{
+    return absFieldValue(baseGroup + group, field);
+}
+
+QString ResultModel::cellText(qint64 group, int field, int column, quint64 value) const
+{
+    const DescFieldSpec &spec = decoder.layout().fields.at(field);
+    if (column == timeColumn())
+        return TimeIndex::formatTime(store->timeIndex().groupTime(storeGroup(group)));
+    switch (column) {
+    case 0:
+        return spec.name;
+    case 1:
+        return decoder.formatter(field).format(value);
+    case 2:
+        return QString::asprintf("0x%llx", value);
+    case 3:
+        return QString::asprintf("Group %lld", sourceGroup(group));
+    case kBitsColumn:
+        // 字段值的二进制形式，变化的位由委托高亮
+        return QString::number(value, 2).rightJustified(spec.msb - spec.lsb + 1, '0');
+    default:
+        return QString();
+    }
+}
+
+void ResultModel::decodeGroupValues(qint64 absGroup, QVector<uint32_t> &dwords, QVector<quint64> &values) const
+{
+    if (!store->readGroup(absGroup, dwords.data()))
+        dwords.fill(0);
+    decoder.decodeGroup(dwords.constData(), values);
+}
+
+QString ResultModel::copyText(int firstRow, int lastRow, int firstCol, int lastCol,
+                              std::atomic<int> *progress, const std::atomic<bool> *cancel, bool *tooLarge) const
+{
+    // 按每个单元格约 12 个字符预先分配，按 64 位计算，分配量不超过文本长度上限
+    if (tooLarge)
+        *tooLarge = false;
+    QString text;
+    qint64 estimate = qint64(lastRow - firstRow + 1) * (lastCol - firstCol + 1) * 12;
+    text.reserve(static_cast<int>(qMin<qint64>(estimate, TableView::kMaxCopyChars)));
+
+    QVector<uint32_t> dwords(store->dwordsPerGroup());
+    QVector<uint32_t> prev(store->dwordsPerGroup());
+    QVector<quint64> values(fieldCount());
+    // 差异视图中当前组变化的字段，不经过页缓存计算
+    QVector<int> delta;
+    qint64 decodedGroup = -1;
+    for (int row = firstRow; row <= lastRow; row++) {
+        if (cancel && ((row & 0xfff) == 0) && *cancel)
+            return QString();
+
+        qint64 group = rowIndex.groupOfRow(row);
+        if (group < 0)
+            break;
+        // 同一组的各行只解析一次
+        if (group != decodedGroup) {
+            decodeGroupValues(baseGroup + group, dwords, values);
+            if (isDeltaMode()) {
+                delta.clear();
+                bool hasPrev = store->readGroup(baseGroup + group - 1, prev.data());
+                changedFields(dwords.constData(), hasPrev ? prev.constData() : nullptr, rowIndex.rowsOf(group), delta);
+            }
+            decodedGroup = group;
+        }
+        int field = static_cast<int>(row - rowIndex.firstRowOf(group));
+        if (isDeltaMode()) {
+            if (field >= delta.size())
+                break;
+            field = delta.at(field);
+        }
+
+        for (int col = firstCol; col <= lastCol; col++) {
+            text += cellText(group, field, col, values.at(field));
+            if (col < lastCol)
+                text += '\t';
+        }
+        if (row < lastRow)
+            text += '\n';
+        if (text.size() > TableView::kMaxCopyChars) {
+            qWarning("%s[%d]: rows %d-%d exceed %d characters", __func__, __LINE__, firstRow, lastRow, TableView::kMaxCopyChars);
+            if (tooLarge)
+                *tooLarge = true;
+            return QString();
+        }
+        if (progress)
+            *progress = row - firstRow + 1;
+    }
+    return text;
+}
+
+QString ResultModel::displayValue(qint64 group, int field) const
+{
+    return decoder.formatter(field).format(fieldValue(group, field));
+}
+
+quint64 ResultModel::absFieldValue(qint64 absGroup, int field) const
+{
+    const DecodedPage *page = decodedPage(absGroup / pageGroups);
+    int localGroup = static_cast<int>(absGroup - page->first);
+    int rawCount = decoder.layout().rawFieldCount();
+    if (field < rawCount)
+        return page->values.at(page->offsets.at(localGroup) + field);
+    int row = page->offsets.at(localGroup) / qMax(1, rawCount);
+    return page->derivedValues.at((field - rawCount) * page->rows + row);
+}
+
+uint32_t ResultModel::changedMask(qint64 group, int field) const
+{
+    qint64 absGroup = baseGroup + group;
+    uint32_t value = static_cast<uint32_t>(absFieldValue(absGroup, field));
+    if (group > 0)
+        return value ^ static_cast<uint32_t>(absFieldValue(absGroup - 1, field));
+
+    // 前一组已不在模型中，直接从数据源读取
+    const DescFieldSpec &spec = decoder.layout().fields.at(field);
+    QVector<uint32_t> dwords(store->dwordsPerGroup());
+    if (!store->readGroup(absGroup - 1, dwords.data()))
+        return decoder.widthMask(field);
+    return value ^ DescObj::extractSubfield(dwords.at(spec.dwIdx), spec.lsb, spec.msb);
+}
+
+int ResultModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return static_cast<int>(qMin<qint64>(rowIndex.rowCount(), INT_MAX));
+}
+
+int ResultModel::baseColumnCount() const
+{
+    if (isDeltaMode())
+        return kBitsColumn + 1;
+    return multiGroup ? 4 : 3;
+}
+
+int ResultModel::timeColumn() const
+{
+    // 只在显示组号列时显示时间列
+    int columns = baseColumnCount();
+    return (timeShown && (columns > 3)) ? columns : -1;
+}
+
+int ResultModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return (timeColumn() >= 0) ? baseColumnCount() + 1 : baseColumnCount();
+}
+
+QVariant ResultModel::data(const QModelIndex &index, int role) const
+{
+    qint64 group;
+    int field;
+    if (!index.isValid() || !locateRow(index.row(), &group, &field))
+        return QVariant();
+
+    const DescFieldSpec &spec = decoder.layout().fields.at(field);
+
+    switch (role) {
+    case GroupRole:
+        return sourceGroup(group);
+    case FieldRole:
+        return field;
+    case DWordRole:
+        return spec.isDerived() ? QVariant() : spec.dwIdx;
+    case LsbRole:
+        return spec.isDerived() ? QVariant() : spec.lsb;
+    case MsbRole:
+        return spec.isDerived() ? QVariant() : spec.msb;
+    case ChangedMaskRole:
+        if (isDeltaMode() && (index.column() == kBitsColumn))
+            return changedMask(group, field);
+        return QVariant();
+    default:
+        break;
+    }
+
+    if ((role == Qt::EditRole) && ((index.column() == 1) || (index.column() == 2)) && !spec.isDerived()) {
+        quint64 value = fieldValue(group, field);
+        return (index.column() == 1) ? QString::number(value) : QString::asprintf("0x%llx", value);
+    } else if (role == Qt::DisplayRole) {
+        if ((index.column() == 1) && decoder.formatter(field).isPlain())
+            return fieldValue(group, field);
+        return cellText(group, field, index.column(), (index.column() == 0) ? 0 : fieldValue(group, field));
+    } else if ((role == Qt::BackgroundRole) && (index.column() == 3)) {
+        // 组号列按组交替显示颜色
+        return QBrush(((baseGroup + group) % 2 == 0) ? Qt::white : Qt::lightGray);
+    } else if ((role == Qt::BackgroundRole) && (field == mHighlightField)) {
+        // 结构视图中选中的字段
+        return QBrush(QColor(255, 236, 160));
+    } else if ((role == Qt::FontRole) && isPreview()) {
+        // 预览数据以斜体显示
+        QFont font;
+        font.setItalic(true);
+        return font;
+    }
+
+    return QVariant();
+}
+
+bool ResultModel::isEditable() const
+{
+    // 差异视图中修改会改变显示的行，预览数据不完整，都不允许编辑
+    return store->isWritable() && !isPreview() && !isDeltaMode();
+}
+
+bool ResultModel::parseFieldValue(int field, const QString &text, uint32_t *value, int base) const
+{
+    if ((field < 0) || (field >= fieldCount()) || decoder.layout().fields.at(field).isDerived())
+        return false;
+
+    QString t = text.trimmed();
+    bool ok;
+    qulonglong v = t.startsWith("0x", Qt::CaseInsensitive) ? t.mid(2).toULongLong(&ok, 16) : t.toULongLong(&ok, base);
+    if (!ok || (v > decoder.widthMask(field)))
+        return false;
+    *value = static_cast<uint32_t>(v);
+    return true;
+}
+
+void ResultModel::valuesChanged()
+{
+    pageCache.clear();
+    if (rowCount() > 0)
+        emit dataChanged(index(0, 1), index(rowCount() - 1, columnCount() - 1));
+}
+
+bool ResultModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    qint64 group;
+    int field;
+    if ((role != Qt::EditRole) || !isEditable() || !locateRow(index.row(), &group, &field))
+        return false;
+
+    uint32_t newValue;
+    if (!parseFieldValue(field, value.toString(), &newValue, columnBase(index.column()))) {
+        qWarning("%s[%d]: invalid value \"%s\" for field %d", __func__, __LINE__, qPrintable(value.toString()), field);
+        return false;
+    }
+
+    // 按模板把字段值编码回所在的 DWORD
+    const DescFieldSpec &spec = decoder.layout().fields.at(field);
+    qint64 absGroup = baseGroup + group;
+    qint64 dwIdx = store->groupDwordIndex(absGroup) + spec.dwIdx;
+    // 流式模式下该组可能已按保留策略丢弃，行号还未同步
+    uint32_t dw;
+    if (!store->readDwords(dwIdx, 1, &dw)) {
+        qWarning("%s[%d]: group %lld is no longer available", __func__, __LINE__, absGroup);
+        return false;
+    }
+    dw = DescObj::insertSubfield(dw, spec.lsb, spec.msb, newValue);
+    if (!store->writeDwords(dwIdx, 1, &dw))
+        return false;
+
+    pageCache.remove(absGroup / pageGroups);
+    // 同一 DWORD 中的其它位字段不受影响，只刷新本行和由位字段计算的派生字段
+    emit dataChanged(index.sibling(index.row(), 1), index.sibling(index.row(), 2));
+    int firstRow = rowOfGroup(group);
+    if ((decoder.derivedCount() > 0) && (firstRow >= 0)) {
+        int firstDerived = firstRow + decoder.layout().rawFieldCount();
+        emit dataChanged(this->index(firstDerived, 1), this->index(firstRow + fieldCount() - 1, 2));
+    }
+    return true;
+}
+
+Qt::ItemFlags ResultModel::flags(const QModelIndex &index) const
+{
+    Qt::ItemFlags f = QAbstractTableModel::flags(index);
+    int field;
+    if (index.isValid() && ((index.column() == 1) || (index.column() == 2)) && isEditable()
+        && locateRow(index.row(), nullptr, &field) && !decoder.layout().fields.at(field).isDerived())
+        f |= Qt::ItemIsEditable;
+    return f;
+}
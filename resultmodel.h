@@ -0,0 +1,157 @@
+#ifndef RESULTMODEL_H
+#define RESULTMODEL_H
+
+#include <QAbstractTableModel>
+#include <atomic>
+#include <climits>
+#include <QCache>
+#include "descobj.h"
+#include "resultstore.h"
+#include "grouprowindex.h"
+#include "layoutdecoder.h"
+
+// 解析结果模型
+// 模型只知道组数和模板布局，视图请求 data() 时才按页解析对应的组，
+// 解析结果放在 LRU 缓存中，内存占用由缓存大小决定。
+class ResultModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    // 自定义数据角色，视图和其它窗口通过角色获取行对应的组和字段，不依赖显示文本
+    enum Roles {
+        GroupRole = Qt::UserRole + 1,   // 绝对组号
+        FieldRole,                      // 字段在模板中的序号
+        DWordRole,                      // 字段所在 DW
+        LsbRole,
+        MsbRole,
+        ChangedMaskRole,                // 差异视图中与前一组相比变化的位（字段内）
+    };
+
+    explicit ResultModel(ResultStore *store, QObject *parent = nullptr);
+
+    void setDescLayout(const DescLayout &layout);
+    const DescLayout &descLayout() const { return decoder.layout(); }
+    void setMultiGroup(bool multi);
+    // 预览模式下数据源中只有每隔 stride 组抽取的一组
+    void setPreviewStride(int stride);
+    bool isPreview() const { return previewStride > 1; }
+    int stride() const { return previewStride; }
+    // 模型中的组序号对应的原始绝对组号
+    qint64 sourceGroup(qint64 group) const { return (baseGroup + group) * previewStride; }
+    // 模型中的组序号对应的数据源组号，预览时与原始组号不同
+    qint64 storeGroup(qint64 group) const { return baseGroup + group; }
+
+    // 只显示数据源组号在 [begin, end) 内的组，用于按时间段筛选
+    void setGroupWindow(qint64 begin, qint64 end);
+    void clearGroupWindow() { setGroupWindow(0, LLONG_MAX); }
+    bool hasGroupWindow() const { return (windowBegin > 0) || (windowEnd < LLONG_MAX); }
+    // 视图行号为 int，行数超过 INT_MAX 时只能显示前 INT_MAX 行，需要用组筛选分段查看
+    bool isRowLimited() const { return rowIndex.rowCount() > INT_MAX; }
+    // 每段最多可以显示的组数，差异视图按每组全部字段估计
+    qint64 maxWindowGroups() const { return INT_MAX / qMax(1, fieldCount()); }
+
+    // 数据源整体变化后重置模型，同时取消组筛选
+    void reset();
+    // 数据源追加了新组或丢弃了旧组后通知视图
+    void syncGroups();
+
+    int fieldCount() const { return decoder.layout().fieldCount(); }
+    qint64 shownGroups() const { return rowIndex.groupCount(); }
+    // 行号到组序号和字段序号，O(log n)
+    bool locateRow(int row, qint64 *group, int *field) const;
+    // 派生字段按 64 位计算，位字段不超过 32 位
+    quint64 fieldValue(qint64 group, int field) const;
+    // 按模板指定的显示格式格式化的字段值
+    QString displayValue(qint64 group, int field) const;
+    // 生成 [firstRow, lastRow] 行、[firstCol, lastCol] 列的制表符分隔文本，与表格显示一致
+    // 直接从数据源解析，不经过页缓存，可以在后台线程调用（期间数据源和行映射不能变化）
+    // 文本超过 TableView::kMaxCopyChars 时停止并返回空字符串，tooLarge 置为 true
+    QString copyText(int firstRow, int lastRow, int firstCol, int lastCol, std::atomic<int> *progress = nullptr,
+                     const std::atomic<bool> *cancel = nullptr, bool *tooLarge = nullptr) const;
+    // 组序号和字段序号到行号，找不到返回 -1
+    int rowOfGroup(qint64 group) const;
+    int rowOfField(qint64 group, int field) const;
+    // 绝对组号到模型中的组序号，组不在模型中时返回 -1
+    qint64 groupOfSource(qint64 sourceGroup) const;
+    // 按 DW 和 LSB 查找字段序号，找不到返回 -1
+    int fieldAt(int dwIdx, int lsb) const;
+
+    // 差异视图：每组只显示与前一组相比发生变化的字段
+    // 预览数据是抽样的组，相邻组之间没有意义，预览时不生效，全部解析完成后恢复
+    void setDeltaMode(bool delta);
+    bool isDeltaMode() const { return deltaMode && !isPreview(); }
+    static const int kBitsColumn = 4;
+    // 数据带有时间戳时在组号列之后显示组的时间，没有时返回 -1
+    int timeColumn() const;
+
+    // 高亮所有组中的同一字段，-1 取消高亮
+    void setHighlightField(int field);
+    int highlightField() const { return mHighlightField; }
+
+    // 数值和十六进制列可以编辑，修改后重新编码写回数据源中的 DWORD
+    bool isEditable() const;
+    // 解析输入的字段值，0x 开头的按十六进制，否则按 base 进制（十六进制列中输入时为 16），
+    // 超出字段位宽时返回 false
+    bool parseFieldValue(int field, const QString &text, uint32_t *value, int base = 10) const;
+    // 该列编辑时输入的默认进制
+    static int columnBase(int column) { return (column == 2) ? 16 : 10; }
+    // 数据源被批量修改后丢弃已解析的值并刷新视图
+    void valuesChanged();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+private:
+    struct DecodedPage
+    {
+        qint64 first;
+        qint64 groups;
+        // 各组解析值在 values 中的起始位置，连续重复的组共用同一份解析值
+        QVector<int> offsets;
+        QVector<uint32_t> values;
+        // 派生字段按列保存：第 d 个派生字段的第 r 份解析值位于 [d * rows + r]
+        int rows;
+        QVector<quint64> derivedValues;
+        // 差异视图中各组变化的字段序号，第 i 组位于 [deltaStarts[i], deltaStarts[i + 1])
+        QVector<int> deltaStarts;
+        QVector<int> deltaFields;
+    };
+
+    qint64 availableGroups() const;
+    int baseColumnCount() const;
+    void resetRows();
+    // 统计 [firstAbs, firstAbs + count) 各组与前一组相比变化的字段数，多线程
+    QVector<int> countDeltaRows(qint64 firstAbs, int count) const;
+    // 与前一组相比变化的位字段；没有前一组时取前 rows 个字段，与统计行数时一致
+    void changedFields(const uint32_t *dwords, const uint32_t *prev, int rows, QVector<int> &fields) const;
+    const DecodedPage *decodedPage(qint64 page) const;
+    void computeDerived(DecodedPage *decoded) const;
+    QString cellText(qint64 group, int field, int column, quint64 value) const;
+    // 解析一组的全部字段值（含派生字段），不使用缓存
+    void decodeGroupValues(qint64 absGroup, QVector<uint32_t> &dwords, QVector<quint64> &values) const;
+    quint64 absFieldValue(qint64 absGroup, int field) const;
+    uint32_t changedMask(qint64 group, int field) const;
+
+    ResultStore *store;
+    // 布局及设置布局时编译的显示格式、派生字段表达式
+    LayoutDecoder decoder;
+    bool multiGroup;
+    int previewStride;
+    int mHighlightField;
+    bool deltaMode;
+    // 模型第一组对应的数据源绝对组号
+    qint64 baseGroup;
+    // 组筛选区间
+    qint64 windowBegin;
+    qint64 windowEnd;
+    bool timeShown;
+    GroupRowIndex rowIndex;
+    int pageGroups;
+    mutable QCache<qint64, DecodedPage> pageCache;
+};
+
+#endif // RESULTMODEL_H
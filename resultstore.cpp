@@ -0,0 +1,346 @@
+#include <algorithm>
+#include <QtEndian>
+#include <QDebug>
+#include "resultstore.h"
+
+// 每个数据块容纳的 DWORD 个数
+static const int kBlockDwords = 64 * 1024;
+// 空闲列表最多保留的块数，多余的释放
+static const int kMaxFreeBlocks = 64;
+// 批量修改时一次处理的组数
+static const int kTileGroups = 256;
+
+// dst[i] = (dst[i] & keep[i]) | set[i]
+// 保持简单的连续循环，便于编译器自动向量化
+static void applyMask(uint32_t *__restrict dst, const uint32_t *__restrict keep, const uint32_t *__restrict set, int count)
+{
+    for (int i = 0; i < count; i++)
+        dst[i] = (dst[i] & keep[i]) | set[i];
+}
+
+ResultStore::ResultStore()
+    : blockBase(0)
+    , origin(0)
+    , firstDword(0)
+    , endDword(0)
+    , file(nullptr)
+    , mapped(nullptr)
+    , mappedDwords(0)
+    , dwPerGroup(0)
+{
+}
+
+ResultStore::~ResultStore()
+{
+    unmapFile();
+    releaseBlocks();
+    for (uint32_t *block : freeBlocks)
+        delete[] block;
+}
+
+void ResultStore::clear()
+{
+    unmapFile();
+    releaseBlocks();
+    mTimes.clear();
+}
+
+void ResultStore::releaseBlocks()
+{
+    // 数据块放回空闲列表，下次追加时复用
+    while (!blocks.isEmpty())
+        recycleBlock(blocks.takeLast());
+    blockBase = 0;
+    origin = 0;
+    firstDword = 0;
+    endDword = 0;
+}
+
+void ResultStore::recycleBlock(uint32_t *block)
+{
+    if (freeBlocks.size() < kMaxFreeBlocks)
+        freeBlocks.append(block);
+    else
+        delete[] block;
+}
+
+void ResultStore::setDwordsPerGroup(int count)
+{
+    dwPerGroup = count;
+}
+
+void ResultStore::setGroupOrigin(qint64 origin)
+{
+    if (mapped || (origin == this->origin))
+        return;
+    // 时间索引按组记录，组的划分变化后从新的起点重新记录
+    // 起点可以早于保留的第一个 DWORD，之前被丢弃的组仍按原来的位置编号
+    this->origin = qBound<qint64>(0, origin, endDword);
+    mTimes.clear();
+}
+
+void ResultStore::setRetention(const Retention &policy)
+{
+    mRetention = policy;
+    enforceRetention();
+}
+
+void ResultStore::setBuffer(const QVector<uint32_t> &dwords, const TimeMarks &marks)
+{
+    clear();
+    append(dwords, marks);
+}
+
+void ResultStore::restoreTimes(qint64 firstGroup, const QVector<qint64> &groupTimes)
+{
+    mTimes.restore(firstGroup, dwPerGroup, groupTimes);
+}
+
+void ResultStore::append(const QVector<uint32_t> &dwords, const TimeMarks &marks)
+{
+    if (mapped) {
+        qWarning("%s[%d]: Cannot append to a mapped file", __func__, __LINE__);
+        return;
+    }
+
+    // 第一次收到时间戳时从当前位置开始建立时间索引，之后没有时间戳的数据沿用前一组的时间
+    if (!marks.isEmpty() && !mTimes.isActive())
+        mTimes.start(endDword - origin, dwPerGroup);
+    mTimes.append(marks, dwords.size());
+
+    const uint32_t *src = dwords.constData();
+    int left = dwords.size();
+    while (left > 0) {
+        qint64 offset = endDword - blockBase;
+        int blockIdx = static_cast<int>(offset / kBlockDwords);
+        int inBlock = static_cast<int>(offset % kBlockDwords);
+        if (blockIdx >= blocks.size()) {
+            uint32_t *block = freeBlocks.isEmpty() ? new uint32_t[kBlockDwords] : freeBlocks.takeLast();
+            blocks.append(block);
+        }
+
+        int count = qMin(left, kBlockDwords - inBlock);
+        std::copy(src, src + count, blocks.at(blockIdx) + inBlock);
+        src += count;
+        left -= count;
+        endDword += count;
+    }
+
+    enforceRetention();
+}
+
+void ResultStore::enforceRetention()
+{
+    if (!mRetention.isLimited() || (dwPerGroup <= 0) || mapped)
+        return;
+
+    // 按 DWORD 计算，origin 之前按其它模板保留的数据也计入上限
+    qint64 end = (endDword > origin) ? groupDwordIndex(endGroup()) : endDword;
+    qint64 limit = end - firstDword;
+    if (mRetention.maxGroups > 0)
+        limit = qMin(limit, mRetention.maxGroups * dwPerGroup);
+    if (mRetention.maxBytes > 0) {
+        qint64 groupBytes = static_cast<qint64>(dwPerGroup) * sizeof(uint32_t);
+        limit = qMin(limit, qMax<qint64>(1, mRetention.maxBytes / groupBytes) * dwPerGroup);
+    }
+
+    qint64 drop = (end - firstDword) - limit;
+    if (drop <= 0)
+        return;
+
+    // 当前模板的组按整组丢弃最旧的数据，完全丢弃的块回收复用
+    firstDword += drop;
+    if (firstDword > origin)
+        firstDword = groupDwordIndex((firstDword - origin + dwPerGroup - 1) / dwPerGroup);
+    mTimes.dropBefore(firstGroup());
+    while (!blocks.isEmpty() && (blockBase + kBlockDwords <= firstDword)) {
+        recycleBlock(blocks.takeFirst());
+        blockBase += kBlockDwords;
+    }
+}
+
+bool ResultStore::mapFile(const QString &path, QString *error, qint64 offset, qint64 length)
+{
+    clear();
+
+    file = new QFile(path);
+    if (!file->open(QIODevice::ReadOnly)) {
+        if (error)
+            *error = file->errorString();
+        unmapFile();
+        return false;
+    }
+
+    qint64 size = file->size() - offset;
+    if ((length >= 0) && (length > size)) {
+        if (error)
+            *error = QObject::tr("File is truncated");
+        unmapFile();
+        return false;
+    }
+    if (length >= 0)
+        size = length;
+    if (size < static_cast<qint64>(sizeof(uint32_t))) {
+        if (error)
+            *error = QObject::tr("File is too small");
+        unmapFile();
+        return false;
+    }
+
+    // 映射起始位置按 DWORD 对齐时可直接按 DWORD 访问
+    mapped = file->map(offset, size);
+    if (mapped == nullptr) {
+        if (error)
+            *error = file->errorString();
+        unmapFile();
+        return false;
+    }
+    mappedDwords = size / static_cast<qint64>(sizeof(uint32_t));
+    qDebug() << "Mapped" << path << "offset" << offset << "dwords" << mappedDwords;
+    return true;
+}
+
+void ResultStore::unmapFile()
+{
+    if (file) {
+        if (mapped)
+            file->unmap(const_cast<uchar *>(mapped));
+        file->close();
+        delete file;
+    }
+    file = nullptr;
+    mapped = nullptr;
+    mappedDwords = 0;
+}
+
+qint64 ResultStore::dwordCount() const
+{
+    return mapped ? mappedDwords : (endDword - firstDword);
+}
+
+qint64 ResultStore::firstGroup() const
+{
+    if (mapped || (dwPerGroup <= 0) || (firstDword <= origin))
+        return 0;
+    return (firstDword - origin + dwPerGroup - 1) / dwPerGroup;
+}
+
+qint64 ResultStore::endGroup() const
+{
+    if (dwPerGroup <= 0)
+        return 0;
+    // 末尾不足一组的 DWORD 不参与解析
+    if (mapped)
+        return mappedDwords / dwPerGroup;
+    return (endDword > origin) ? (endDword - origin) / dwPerGroup : 0;
+}
+
+uint32_t ResultStore::dword(qint64 idx) const
+{
+    if (mapped)
+        return qFromLittleEndian<quint32>(mapped + idx * sizeof(uint32_t));
+    qint64 offset = idx - blockBase;
+    return blocks.at(static_cast<int>(offset / kBlockDwords))[offset % kBlockDwords];
+}
+
+bool ResultStore::readGroup(qint64 group, uint32_t *out) const
+{
+    if ((group < firstGroup()) || (group >= endGroup()))
+        return false;
+    return readDwords(groupDwordIndex(group), dwPerGroup, out);
+}
+
+bool ResultStore::readDwords(qint64 idx, int count, uint32_t *out) const
+{
+    if ((idx < firstDwordIndex()) || (idx + count > firstDwordIndex() + dwordCount()))
+        return false;
+
+    if (mapped) {
+        const uchar *src = mapped + idx * sizeof(uint32_t);
+        for (int i = 0; i < count; i++)
+            out[i] = qFromLittleEndian<quint32>(src + i * sizeof(uint32_t));
+        return true;
+    }
+
+    // 读取范围可能跨越多个数据块
+    int copied = 0;
+    while (copied < count) {
+        qint64 offset = idx + copied - blockBase;
+        const uint32_t *block = blocks.at(static_cast<int>(offset / kBlockDwords));
+        int inBlock = static_cast<int>(offset % kBlockDwords);
+        int n = qMin(count - copied, kBlockDwords - inBlock);
+        std::copy(block + inBlock, block + inBlock + n, out + copied);
+        copied += n;
+    }
+    return true;
+}
+
+const uint32_t *ResultStore::constDwords(qint64 idx, int count) const
+{
+    if ((idx < firstDwordIndex()) || (idx + count > endDwordIndex()))
+        return nullptr;
+
+    if (mapped) {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        const uchar *src = mapped + idx * sizeof(uint32_t);
+        if (reinterpret_cast<quintptr>(src) % alignof(uint32_t) == 0)
+            return reinterpret_cast<const uint32_t *>(src);
+#endif
+        return nullptr;
+    }
+
+    qint64 offset = idx - blockBase;
+    int inBlock = static_cast<int>(offset % kBlockDwords);
+    if (inBlock + count > kBlockDwords)
+        return nullptr;
+    return blocks.at(static_cast<int>(offset / kBlockDwords)) + inBlock;
+}
+
+bool ResultStore::writeDwords(qint64 idx, int count, const uint32_t *in)
+{
+    if (!isWritable() || (idx < firstDword) || (idx + count > endDword))
+        return false;
+
+    int copied = 0;
+    while (copied < count) {
+        qint64 offset = idx + copied - blockBase;
+        uint32_t *block = blocks.at(static_cast<int>(offset / kBlockDwords));
+        int inBlock = static_cast<int>(offset % kBlockDwords);
+        int n = qMin(count - copied, kBlockDwords - inBlock);
+        std::copy(in + copied, in + copied + n, block + inBlock);
+        copied += n;
+    }
+    return true;
+}
+
+bool ResultStore::maskedWrite(qint64 beginGroup, qint64 endGroup, const QVector<uint32_t> &keep, const QVector<uint32_t> &set)
+{
+    beginGroup = qMax(beginGroup, firstGroup());
+    endGroup = qMin(endGroup, this->endGroup());
+    if (!isWritable() || (keep.size() != dwPerGroup) || (set.size() != dwPerGroup))
+        return false;
+    if (beginGroup >= endGroup)
+        return true;
+
+    // 掩码按组重复展开，多出一组用于从组中间开始的片段
+    QVector<uint32_t> tileKeep;
+    QVector<uint32_t> tileSet;
+    for (int g = 0; g <= kTileGroups; g++) {
+        tileKeep += keep;
+        tileSet += set;
+    }
+
+    qint64 pos = groupDwordIndex(beginGroup);
+    qint64 end = groupDwordIndex(endGroup);
+    while (pos < end) {
+        qint64 offset = pos - blockBase;
+        uint32_t *block = blocks.at(static_cast<int>(offset / kBlockDwords));
+        int inBlock = static_cast<int>(offset % kBlockDwords);
+        int phase = static_cast<int>((pos - origin) % dwPerGroup);
+        int n = static_cast<int>(qMin<qint64>(end - pos, kBlockDwords - inBlock));
+        n = qMin(n, kTileGroups * dwPerGroup);
+        applyMask(block + inBlock, tileKeep.constData() + phase, tileSet.constData() + phase, n);
+        pos += n;
+    }
+    return true;
+}
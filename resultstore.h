@@ -0,0 +1,108 @@
+#ifndef RESULTSTORE_H
+#define RESULTSTORE_H
+
+#include <QFile>
+#include <QList>
+#include <QVector>
+#include <QString>
+#include "timeindex.h"
+
+// 原始 DWORD 数据存储
+// 数据来源可以是内存缓冲区（粘贴的文本、跟踪的文件、接收的数据流），
+// 也可以是映射到内存的二进制 dump 文件。
+// 组的起始位置由组号和模板长度直接计算，不保存逐组信息。
+//
+// 内存数据保存在固定大小的块组成的环中。设置保留策略后，超出部分按整组从最旧的
+// 数据开始丢弃，空闲块回收复用，不重新分配内存。组号始终是从数据起始处计算的
+// 绝对组号，丢弃旧数据后 firstGroup() 随之增大。
+// 数据带有行时间戳时同时维护按组的时间索引，与数据一起丢弃。
+// 组默认从绝对位置 0 开始划分。数据流中途切换模板时用 setGroupOrigin() 让新模板的组
+// 从切换位置开始，之前的数据仍然保留，按之前的模板查看时再把起点设置回去。
+class ResultStore
+{
+public:
+    // 保留策略，0 表示不限制
+    struct Retention
+    {
+        qint64 maxGroups = 0;
+        qint64 maxBytes = 0;
+
+        bool isLimited() const { return (maxGroups > 0) || (maxBytes > 0); }
+    };
+
+    ResultStore();
+    ~ResultStore();
+
+    void clear();
+    void setDwordsPerGroup(int count);
+    // 组从绝对位置 origin 开始划分，origin 之前的数据不属于任何组，时间索引重新开始
+    void setGroupOrigin(qint64 origin);
+    qint64 groupOrigin() const { return origin; }
+    void setRetention(const Retention &policy);
+    const Retention &retention() const { return mRetention; }
+
+    // marks 为 dwords 中带时间戳的位置，见 TimeMark
+    void setBuffer(const QVector<uint32_t> &dwords, const TimeMarks &marks = TimeMarks());
+    // 追加数据，末尾不完整的组保留到下次追加
+    void append(const QVector<uint32_t> &dwords, const TimeMarks &marks = TimeMarks());
+    // 从会话文件恢复时间索引，groupTimes 为绝对组号 firstGroup 开始各组的时间
+    void restoreTimes(qint64 firstGroup, const QVector<qint64> &groupTimes);
+    // 映射小端序二进制 dump 文件，不读取内容
+    // offset 和 length 指定只映射文件中的一段，length 小于 0 时映射到文件末尾
+    bool mapFile(const QString &path, QString *error = nullptr, qint64 offset = 0, qint64 length = -1);
+
+    int dwordsPerGroup() const { return dwPerGroup; }
+    qint64 dwordCount() const;
+    // 保留的第一组的绝对组号
+    qint64 firstGroup() const;
+    // 最后一个完整组之后的绝对组号
+    qint64 endGroup() const;
+    qint64 groupCount() const { return endGroup() - firstGroup(); }
+    bool isMapped() const { return mapped != nullptr; }
+    const TimeIndex &timeIndex() const { return mTimes; }
+
+    // 保留的第一个 DWORD 的绝对位置
+    qint64 firstDwordIndex() const { return mapped ? 0 : firstDword; }
+    qint64 endDwordIndex() const { return firstDwordIndex() + dwordCount(); }
+    // 组的第一个 DWORD 的绝对位置
+    qint64 groupDwordIndex(qint64 group) const { return origin + group * dwPerGroup; }
+    uint32_t dword(qint64 idx) const;
+    // 从绝对位置 idx 开始连续读取 count 个 DWORD，范围超出保留的数据时返回 false
+    bool readDwords(qint64 idx, int count, uint32_t *out) const;
+    // [idx, idx + count) 在内存中连续且为本机字节序时（小端序主机上按 DWORD 对齐的映射文件，
+    // 或位于同一数据块内）直接返回其地址，不复制；否则返回空指针，需要用 readDwords() 读取
+    const uint32_t *constDwords(qint64 idx, int count) const;
+
+    // 映射的 dump 文件只读，内存数据可以修改
+    bool isWritable() const { return mapped == nullptr; }
+    bool writeDwords(qint64 idx, int count, const uint32_t *in);
+    // 对 [beginGroup, endGroup) 的每一组执行 dw[i] = (dw[i] & keep[i]) | set[i]，
+    // keep 和 set 的长度为每组 DWORD 数
+    bool maskedWrite(qint64 beginGroup, qint64 endGroup, const QVector<uint32_t> &keep, const QVector<uint32_t> &set);
+    // 按绝对组号读取一组 DWORD，out 至少能容纳 dwordsPerGroup() 个元素
+    // 该组已被丢弃或尚不完整时返回 false
+    bool readGroup(qint64 group, uint32_t *out) const;
+
+private:
+    void unmapFile();
+    void releaseBlocks();
+    void recycleBlock(uint32_t *block);
+    void enforceRetention();
+
+    // 内存数据块环，blocks[0] 的第一个元素对应绝对位置 blockBase
+    QList<uint32_t *> blocks;
+    QList<uint32_t *> freeBlocks;
+    qint64 blockBase;
+    qint64 origin;
+    qint64 firstDword;
+    qint64 endDword;
+    Retention mRetention;
+    TimeIndex mTimes;
+
+    QFile *file;
+    const uchar *mapped;
+    qint64 mappedDwords;
+    int dwPerGroup;
+};
+
+#endif // RESULTSTORE_H
@@ -0,0 +1,338 @@
+#include <climits>
+#include <QDebug>
+#include <QFile>
+#include <QObject>
+#include <QSaveFile>
+#include <QThread>
+#include <QtConcurrent>
+#include <QtEndian>
+#include "sessionfile.h"
+
+// 文件头长度
+static const int kHeaderSize = 64;
+// 压缩时每块的 DWORD 个数
+static const int kBlockDwords = 1024 * 1024;
+// 未压缩时每次写入的 DWORD 个数，也是时间索引每次读写的组数
+static const int kWriteDwords = 1024 * 1024;
+// 文件头中时间索引位置的偏移
+static const int kTimeOffsetField = 48;
+
+static qint64 alignUp(qint64 value, qint64 align)
+{
+    return (value + align - 1) & ~(align - 1);
+}
+
+static QByteArray toLittleEndianBytes(const uint32_t *src, int count)
+{
+    QByteArray bytes(count * static_cast<int>(sizeof(uint32_t)), Qt::Uninitialized);
+    for (int i = 0; i < count; i++)
+        qToLittleEndian<quint32>(src[i], bytes.data() + i * sizeof(uint32_t));
+    return bytes;
+}
+
+// 读取时间索引并恢复到数据存储，timeOffset 为 0 时没有时间索引
+static bool readTimes(QFile &file, qint64 timeOffset, qint64 groups, ResultStore *store, QString *error)
+{
+    if (timeOffset == 0)
+        return true;
+
+    QByteArray header;
+    if (file.seek(timeOffset))
+        header = file.read(16);
+    qint64 first = (header.size() == 16) ? static_cast<qint64>(qFromLittleEndian<quint64>(header.constData())) : -1;
+    qint64 count = (header.size() == 16) ? static_cast<qint64>(qFromLittleEndian<quint64>(header.constData() + 8)) : -1;
+    if ((first < 0) || (count < 0) || (first + count > groups) || (count > INT_MAX / 8)) {
+        store->clear();
+        if (error)
+            *error = QObject::tr("Corrupted time index in session file");
+        return false;
+    }
+
+    QVector<qint64> times(static_cast<int>(count));
+    for (int g = 0; g < times.size(); g += kWriteDwords) {
+        int n = qMin(kWriteDwords, times.size() - g);
+        QByteArray bytes = file.read(n * 8);
+        if (bytes.size() != n * 8) {
+            store->clear();
+            if (error)
+                *error = QObject::tr("Corrupted time index in session file");
+            return false;
+        }
+        for (int i = 0; i < n; i++)
+            times[g + i] = qFromLittleEndian<qint64>(bytes.constData() + i * 8);
+    }
+    store->restoreTimes(store->firstGroup() + first, times);
+    return true;
+}
+
+SessionFile::SessionFile()
+    : mFlags(0)
+    , cancelled(false)
+    , total(0)
+    , done(0)
+{
+}
+
+bool SessionFile::save(const QString &path, const DescObj &desc, const ResultStore *store, uint32_t flags,
+                       QString *error)
+{
+    mFlags = flags;
+    int dwPerGroup = store->dwordsPerGroup();
+    qint64 groups = store->groupCount();
+    qint64 firstIdx = store->groupDwordIndex(store->firstGroup());
+    bool compress = (flags & Compressed) != 0;
+    total = groups * dwPerGroup;
+    done = 0;
+
+    QByteArray json = desc.toBtyeArray();
+    qint64 blockCount = compress ? (total + kBlockDwords - 1) / kBlockDwords : 0;
+    qint64 tableOffset = alignUp(kHeaderSize + json.size(), 8);
+    qint64 dataOffset = alignUp(tableOffset + blockCount * 16, 64);
+
+    QByteArray header(kHeaderSize, '\0');
+    qToLittleEndian<quint32>(kMagic, header.data());
+    qToLittleEndian<quint32>(kVersion, header.data() + 4);
+    qToLittleEndian<quint32>(flags, header.data() + 8);
+    qToLittleEndian<quint32>(static_cast<quint32>(dwPerGroup), header.data() + 12);
+    qToLittleEndian<quint64>(static_cast<quint64>(groups), header.data() + 16);
+    qToLittleEndian<quint32>(static_cast<quint32>(json.size()), header.data() + 24);
+    qToLittleEndian<quint32>(static_cast<quint32>(blockCount), header.data() + 28);
+    qToLittleEndian<quint32>(compress ? kBlockDwords : 0, header.data() + 32);
+    qToLittleEndian<quint64>(static_cast<quint64>(dataOffset), header.data() + 40);
+    header += json;
+    header += QByteArray(static_cast<int>(dataOffset - header.size()), '\0');
+
+    // 写入临时文件，全部完成后才替换目标文件
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || (file.write(header) != header.size())) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    struct Task
+    {
+        int start;
+        int count;
+        QByteArray packed;
+    };
+
+    // 压缩时每次并行处理若干块
+    int batchBlocks = qMax(1, QThread::idealThreadCount());
+    qint64 step = compress ? qint64(kBlockDwords) * batchBlocks : kWriteDwords;
+    QByteArray table(static_cast<int>(blockCount * 16), '\0');
+    int block = 0;
+    qint64 offset = dataOffset;
+    QVector<uint32_t> dwords;
+    for (qint64 pos = 0; pos < total; pos += step) {
+        if (cancelled) {
+            file.cancelWriting();
+            if (error)
+                *error = QObject::tr("Save cancelled");
+            return false;
+        }
+
+        int count = static_cast<int>(qMin(step, total - pos));
+        dwords.resize(count);
+        if (!store->readDwords(firstIdx + pos, count, dwords.data())) {
+            file.cancelWriting();
+            if (error)
+                *error = QObject::tr("Data is no longer available");
+            return false;
+        }
+
+        QVector<Task> tasks;
+        if (compress) {
+            for (int start = 0; start < count; start += kBlockDwords)
+                tasks.push_back({start, qMin(kBlockDwords, count - start), QByteArray()});
+            QtConcurrent::blockingMap(tasks, [&dwords](Task &task) {
+                task.packed = qCompress(toLittleEndianBytes(dwords.constData() + task.start, task.count));
+            });
+        } else {
+            tasks.push_back({0, count, toLittleEndianBytes(dwords.constData(), count)});
+        }
+
+        for (const Task &task : tasks) {
+            if (compress) {
+                qToLittleEndian<quint64>(static_cast<quint64>(offset), table.data() + block * 16);
+                qToLittleEndian<quint32>(static_cast<quint32>(task.packed.size()), table.data() + block * 16 + 8);
+                block++;
+            }
+            if (file.write(task.packed) != task.packed.size()) {
+                if (error)
+                    *error = file.errorString();
+                file.cancelWriting();
+                return false;
+            }
+            offset += task.packed.size();
+        }
+        done = pos + count;
+    }
+
+    // 时间索引写在数据之后，覆盖保存的组中有时间的部分
+    const TimeIndex &times = store->timeIndex();
+    qint64 timeFirst = qMax(times.firstGroup(), store->firstGroup());
+    qint64 timeEnd = qMin(times.endGroup(), store->endGroup());
+    qint64 timeOffset = 0;
+    if (times.isActive() && (timeEnd > timeFirst)) {
+        timeOffset = alignUp(offset, 8);
+        QByteArray bytes(static_cast<int>(timeOffset - offset) + 16, '\0');
+        qToLittleEndian<quint64>(static_cast<quint64>(timeFirst - store->firstGroup()), bytes.data() + bytes.size() - 16);
+        qToLittleEndian<quint64>(static_cast<quint64>(timeEnd - timeFirst), bytes.data() + bytes.size() - 8);
+        bool ok = (file.write(bytes) == bytes.size());
+        for (qint64 g = timeFirst; ok && (g < timeEnd); g += kWriteDwords) {
+            int count = static_cast<int>(qMin<qint64>(kWriteDwords, timeEnd - g));
+            bytes.resize(count * 8);
+            for (int i = 0; i < count; i++)
+                qToLittleEndian<qint64>(times.groupTime(g + i), bytes.data() + i * 8);
+            ok = (file.write(bytes) == bytes.size());
+        }
+        QByteArray field(8, '\0');
+        qToLittleEndian<quint64>(static_cast<quint64>(timeOffset), field.data());
+        if (!ok || !file.seek(kTimeOffsetField) || (file.write(field) != field.size())) {
+            if (error)
+                *error = file.errorString();
+            file.cancelWriting();
+            return false;
+        }
+    }
+
+    if (compress && (!file.seek(tableOffset) || (file.write(table) != table.size()))) {
+        if (error)
+            *error = file.errorString();
+        file.cancelWriting();
+        return false;
+    }
+    if (!file.commit()) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    qDebug("%s[%d]: saved %lld groups to %s", __func__, __LINE__, groups, qPrintable(path));
+    return true;
+}
+
+bool SessionFile::open(const QString &path, DescObj *desc, ResultStore *store, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    QByteArray header = file.read(kHeaderSize);
+    if ((header.size() != kHeaderSize) || (qFromLittleEndian<quint32>(header.constData()) != kMagic)) {
+        if (error)
+            *error = QObject::tr("Not a session file");
+        return false;
+    }
+    quint32 version = qFromLittleEndian<quint32>(header.constData() + 4);
+    if ((version < 1) || (version > kVersion)) {
+        if (error)
+            *error = QObject::tr("Unsupported session version %1").arg(version);
+        return false;
+    }
+
+    mFlags = qFromLittleEndian<quint32>(header.constData() + 8);
+    int dwPerGroup = static_cast<int>(qFromLittleEndian<quint32>(header.constData() + 12));
+    qint64 groups = static_cast<qint64>(qFromLittleEndian<quint64>(header.constData() + 16));
+    int templateSize = static_cast<int>(qFromLittleEndian<quint32>(header.constData() + 24));
+    qint64 blockCount = qFromLittleEndian<quint32>(header.constData() + 28);
+    int blockDwords = static_cast<int>(qFromLittleEndian<quint32>(header.constData() + 32));
+    qint64 dataOffset = static_cast<qint64>(qFromLittleEndian<quint64>(header.constData() + 40));
+    qint64 timeOffset = (version >= 2) ? static_cast<qint64>(qFromLittleEndian<quint64>(header.constData() + kTimeOffsetField)) : 0;
+
+    bool ok = false;
+    DescObj loaded = DescObj::fromJson(file.read(templateSize), &ok);
+    if (!ok || loaded.empty() || (loaded.size() != dwPerGroup) || (groups < 0)) {
+        if (error)
+            *error = QObject::tr("Invalid template in session file");
+        return false;
+    }
+
+    total = groups * dwPerGroup;
+    done = 0;
+    store->clear();
+    store->setDwordsPerGroup(dwPerGroup);
+    store->setRetention(ResultStore::Retention());
+
+    if (!(mFlags & Compressed)) {
+        // 数据段直接映射，不读取内容
+        if (!store->mapFile(path, error, dataOffset, total * static_cast<qint64>(sizeof(uint32_t))))
+            return false;
+        if (!readTimes(file, timeOffset, groups, store, error))
+            return false;
+        done = total;
+        *desc = loaded;
+        return true;
+    }
+
+    if ((blockDwords <= 0) || (blockCount != (total + blockDwords - 1) / blockDwords)) {
+        if (error)
+            *error = QObject::tr("Corrupted session file");
+        return false;
+    }
+    QByteArray table;
+    if (file.seek(alignUp(kHeaderSize + templateSize, 8)))
+        table = file.read(blockCount * 16);
+    if (table.size() != blockCount * 16) {
+        if (error)
+            *error = QObject::tr("Corrupted session file");
+        return false;
+    }
+
+    struct Task
+    {
+        int count;
+        QByteArray packed;
+        QVector<uint32_t> dwords;
+    };
+
+    // 每次读入若干块并行解压，按顺序追加到数据存储
+    int batchBlocks = qMax(1, QThread::idealThreadCount());
+    for (qint64 first = 0; first < blockCount; first += batchBlocks) {
+        if (cancelled) {
+            store->clear();
+            if (error)
+                *error = QObject::tr("Open cancelled");
+            return false;
+        }
+
+        QVector<Task> tasks;
+        for (qint64 b = first; b < qMin(first + batchBlocks, blockCount); b++) {
+            qint64 offset = static_cast<qint64>(qFromLittleEndian<quint64>(table.constData() + b * 16));
+            int size = static_cast<int>(qFromLittleEndian<quint32>(table.constData() + b * 16 + 8));
+            Task task;
+            task.count = static_cast<int>(qMin<qint64>(blockDwords, total - b * blockDwords));
+            if (file.seek(offset))
+                task.packed = file.read(size);
+            tasks.push_back(task);
+        }
+        QtConcurrent::blockingMap(tasks, [](Task &task) {
+            QByteArray bytes = qUncompress(task.packed);
+            if (bytes.size() != task.count * static_cast<int>(sizeof(uint32_t)))
+                return;
+            task.dwords.resize(task.count);
+            for (int i = 0; i < task.count; i++)
+                task.dwords[i] = qFromLittleEndian<quint32>(bytes.constData() + i * sizeof(uint32_t));
+        });
+
+        for (const Task &task : tasks) {
+            if (task.dwords.size() != task.count) {
+                store->clear();
+                if (error)
+                    *error = QObject::tr("Corrupted session file");
+                return false;
+            }
+            store->append(task.dwords);
+            done += task.count;
+        }
+    }
+    if (!readTimes(file, timeOffset, groups, store, error))
+        return false;
+
+    *desc = loaded;
+    qDebug("%s[%d]: loaded %lld groups from %s", __func__, __LINE__, groups, qPrintable(path));
+    return true;
+}
@@ -0,0 +1,58 @@
+#ifndef SESSIONFILE_H
+#define SESSIONFILE_H
+
+#include <atomic>
+#include <QString>
+#include "descobj.h"
+#include "resultstore.h"
+
+// 会话文件（.sps）：保存模板快照和原始 DWORD 数据，重新打开时不再解析文本。
+// save() 和 open() 在调用线程中执行，界面通过 QtConcurrent 在后台线程调用，
+// 期间可以查询进度或取消。
+//
+// 文件格式，均为小端序：
+//   文件头     64 字节：uint32 magic "SPSS"，uint32 version，uint32 flags，uint32 dwPerGroup，
+//             uint64 groupCount，uint32 templateSize，uint32 blockCount，uint32 blockDwords，
+//             uint32 reserved，uint64 dataOffset，uint64 timeOffset（版本 2），其余补 0
+//   模板       templateSize 字节的模板 JSON
+//   块索引     仅压缩时存在，8 字节对齐，每块 uint64 offset，uint32 size，uint32 reserved
+//   数据       从 dataOffset 开始，按 64 字节对齐。未压缩时为 groupCount * dwPerGroup 个
+//             连续的 DWORD，打开时直接映射；压缩时每块 blockDwords 个 DWORD 分别 qCompress
+//   时间索引   timeOffset 不为 0 时存在，8 字节对齐：uint64 firstGroup（相对于文件中的第一组），
+//             uint64 count，count 个 int64 组时间（纳秒）
+// 版本 1 的文件没有时间索引，仍可打开。
+//
+// 解析结果只在显示时按页计算，打开会话时映射原始数据即可立即显示，文件中不保存解析后的列。
+class SessionFile
+{
+public:
+    static const uint32_t kMagic = 0x53535053;  // "SPSS"
+    static const uint32_t kVersion = 2;
+
+    enum Flag {
+        Compressed = 0x1,
+        MultiGroup = 0x2,
+    };
+
+    SessionFile();
+
+    // 保存 store 中保留的所有完整组
+    bool save(const QString &path, const DescObj &desc, const ResultStore *store, uint32_t flags,
+              QString *error = nullptr);
+    // 读取模板并载入数据，未压缩的数据段直接映射
+    bool open(const QString &path, DescObj *desc, ResultStore *store, QString *error = nullptr);
+    uint32_t flags() const { return mFlags; }
+
+    void cancel() { cancelled = true; }
+    bool isCancelled() const { return cancelled; }
+    qint64 totalDwords() const { return total; }
+    qint64 processedDwords() const { return done; }
+
+private:
+    uint32_t mFlags;
+    std::atomic<bool> cancelled;
+    std::atomic<qint64> total;
+    std::atomic<qint64> done;
+};
+
+#endif // SESSIONFILE_H
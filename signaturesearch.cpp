@@ -0,0 +1,203 @@
+#include <climits>
+#include <QRegularExpression>
+#include <QtAlgorithms>
+#include <QtConcurrent>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "signaturesearch.h"
+
+// 每个并行任务扫描的 DWORD 个数
+static const int kChunkDwords = 4 * 1024 * 1024;
+
+bool SignatureSearch::parse(const QString &text, SignaturePattern *pattern, QString *error)
+{
+    pattern->masks.clear();
+    pattern->values.clear();
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    const QStringList tokens = text.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+#else
+    const QStringList tokens = text.split(QRegularExpression("\\s+"), QString::SkipEmptyParts);
+#endif
+    for (const QString &token : tokens) {
+        QString t = token.toLower().remove('_');
+        uint32_t mask = 0;
+        uint32_t value = 0;
+        bool ok = true;
+
+        if (t == "*") {
+            // 任意值
+        } else if (t.contains('/')) {
+            value = t.section('/', 0, 0).toUInt(&ok, 16);
+            if (ok)
+                mask = t.section('/', 1, 1).toUInt(&ok, 16);
+        } else {
+            if (t.startsWith("0x"))
+                t.remove(0, 2);
+            ok = (t.size() == 8);
+            for (int i = 0; ok && (i < t.size()); i++) {
+                QChar c = t.at(i);
+                mask <<= 4;
+                value <<= 4;
+                if (c == 'x')
+                    continue;
+                int digit = QString(c).toInt(&ok, 16);
+                mask |= 0xf;
+                value |= static_cast<uint32_t>(digit);
+            }
+        }
+
+        if (!ok) {
+            if (error)
+                *error = QObject::tr("Invalid DWORD pattern: %1").arg(token);
+            return false;
+        }
+        pattern->masks.push_back(mask);
+        pattern->values.push_back(value & mask);
+    }
+
+    bool anyMask = false;
+    for (uint32_t mask : pattern->masks)
+        anyMask = anyMask || (mask != 0);
+    if (!anyMask) {
+        if (error)
+            *error = QObject::tr("Pattern does not constrain any bit");
+        return false;
+    }
+    return true;
+}
+
+static inline bool matchAt(const uint32_t *dw, const SignaturePattern &pattern)
+{
+    for (int i = 0; i < pattern.length(); i++) {
+        if ((dw[i] & pattern.masks.at(i)) != pattern.values.at(i))
+            return false;
+    }
+    return true;
+}
+
+// 扫描 buffer 中 [0, limit) 的起始位置，匹配位置加上 base 后追加到 out，out 达到 maxOut 个时停止
+static void scanBuffer(const uint32_t *buffer, int limit, const SignaturePattern &pattern, int anchor,
+                       qint64 base, int maxOut, QVector<qint64> &out)
+{
+    const uint32_t anchorMask = pattern.masks.at(anchor);
+    const uint32_t anchorValue = pattern.values.at(anchor);
+    const uint32_t *column = buffer + anchor;
+    int p = 0;
+
+#ifdef __SSE2__
+    const __m128i vmask = _mm_set1_epi32(static_cast<int>(anchorMask));
+    const __m128i vvalue = _mm_set1_epi32(static_cast<int>(anchorValue));
+    for (; p + 4 <= limit; p += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(column + p));
+        int hits = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(x, vmask), vvalue)));
+        if (hits == 0)
+            continue;
+        for (int k = 0; k < 4; k++) {
+            if (((hits >> k) & 1) && matchAt(buffer + p + k, pattern)) {
+                out.push_back(base + p + k);
+                if (out.size() >= maxOut)
+                    return;
+            }
+        }
+    }
+#endif
+
+    for (; p < limit; p++) {
+        if (((column[p] & anchorMask) == anchorValue) && matchAt(buffer + p, pattern)) {
+            out.push_back(base + p);
+            if (out.size() >= maxOut)
+                return;
+        }
+    }
+}
+
+QVector<qint64> SignatureSearch::search(const ResultStore &store, const SignaturePattern &pattern, int maxMatches,
+                                        bool *truncated)
+{
+    struct Task
+    {
+        qint64 begin;
+        qint64 end;
+        QVector<qint64> matches;
+    };
+
+    if (truncated)
+        *truncated = false;
+    maxMatches = qBound(0, maxMatches, kMaxMatches);
+    int length = pattern.length();
+    qint64 first = store.firstDwordIndex();
+    // 最后一个能容纳完整特征的起始位置之后
+    qint64 last = first + store.dwordCount() - length + 1;
+    if ((length == 0) || (last <= first) || (maxMatches == 0))
+        return QVector<qint64>();
+
+    // 锚点取掩码位最多的 DWORD，过滤效果最好
+    int anchor = 0;
+    for (int i = 1; i < length; i++) {
+        if (qPopulationCount(pattern.masks.at(i)) > qPopulationCount(pattern.masks.at(anchor)))
+            anchor = i;
+    }
+
+    QVector<Task> tasks;
+    for (qint64 s = first; s < last; s += kChunkDwords)
+        tasks.push_back({s, qMin(s + kChunkDwords, last), QVector<qint64>()});
+
+    // 每批与线程数相同的段，按位置顺序合并，达到上限后不再扫描后面的段；
+    // 每段最多保留还需要的个数加一个，用于判断是否还有更多匹配
+    QVector<qint64> matches;
+    int batch = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    for (int t = 0; t < tasks.size(); t += batch) {
+        int need = maxMatches - matches.size() + 1;
+        auto scan = [&store, &pattern, anchor, length, need](Task &task) {
+            int limit = static_cast<int>(task.end - task.begin);
+            int size = limit + length - 1;
+            // 映射的文件直接在原位置扫描，跨越数据块等无法直接访问时才复制
+            const uint32_t *data = store.constDwords(task.begin, size);
+            QVector<uint32_t> buffer;
+            if (data == nullptr) {
+                buffer.resize(size);
+                store.readDwords(task.begin, size, buffer.data());
+                data = buffer.constData();
+            }
+            scanBuffer(data, limit, pattern, anchor, task.begin, need, task.matches);
+        };
+        auto end = tasks.begin() + qMin(t + batch, tasks.size());
+        QtConcurrent::blockingMap(tasks.begin() + t, end, scan);
+
+        for (auto it = tasks.begin() + t; it != end; ++it) {
+            int room = maxMatches - matches.size();
+            if (it->matches.size() > room) {
+                matches += it->matches.mid(0, room);
+                if (truncated)
+                    *truncated = true;
+                return matches;
+            }
+            matches += it->matches;
+            it->matches = QVector<qint64>();
+        }
+    }
+    return matches;
+}
+
+QVector<uint32_t> SignatureSearch::gather(const ResultStore &store, const QVector<qint64> &offsets, int dwCount)
+{
+    // Qt5 的 QVector 数据不能超过 2 GB（含头部）
+    static const qint64 kMaxDwords = (INT_MAX - 64) / sizeof(uint32_t);
+    QVector<uint32_t> dwords;
+    if (dwCount <= 0)
+        return dwords;
+    int count = offsets.size();
+    if (qint64(count) * dwCount > kMaxDwords) {
+        count = static_cast<int>(kMaxDwords / dwCount);
+        qWarning("%s[%d]: only the first %d of %d matches gathered", __func__, __LINE__, count, offsets.size());
+    }
+    dwords.reserve(count * dwCount);
+    QVector<uint32_t> group(dwCount);
+    for (int i = 0; i < count; i++) {
+        if (store.readDwords(offsets.at(i), dwCount, group.data()))
+            dwords += group;
+    }
+    return dwords;
+}
@@ -0,0 +1,39 @@
+#ifndef SIGNATURESEARCH_H
+#define SIGNATURESEARCH_H
+
+#include <QString>
+#include <QVector>
+#include "resultstore.h"
+
+// 多 DWORD 带掩码的特征：第 i 个 DWORD 满足 (dw & masks[i]) == values[i]
+struct SignaturePattern
+{
+    QVector<uint32_t> masks;
+    QVector<uint32_t> values;
+
+    int length() const { return masks.size(); }
+};
+
+// 在原始 DWORD 数据中查找特征出现的位置
+// 选掩码位最多的 DWORD 作为锚点，用 SIMD 一次比较 4 个位置，命中后再检查其余 DWORD。
+// 数据分段多线程扫描，相邻段重叠特征长度减一个 DWORD。
+class SignatureSearch
+{
+public:
+    // 以空白分隔的各 DWORD 条件：
+    //   A5xx_xx0F       8 位十六进制，x 为任意半字节，可带 0x 前缀和下划线
+    //   80000000/80000000  值/掩码
+    //   *               任意值
+    static bool parse(const QString &text, SignaturePattern *pattern, QString *error = nullptr);
+    // 匹配个数的上限，防止过于宽泛的特征占满内存
+    static const int kMaxMatches = 1 << 24;
+
+    // 返回前 maxMatches 个匹配的绝对 DWORD 位置，按升序排列；还有更多匹配时 truncated 为 true
+    static QVector<qint64> search(const ResultStore &store, const SignaturePattern &pattern, int maxMatches,
+                                  bool *truncated = nullptr);
+    // 取出各匹配位置开始的 dwCount 个 DWORD，拼接为连续的组，超出数据末尾的匹配忽略
+    // 结果超过 QVector 的容量时只取前面的匹配
+    static QVector<uint32_t> gather(const ResultStore &store, const QVector<qint64> &offsets, int dwCount);
+};
+
+#endif // SIGNATURESEARCH_H
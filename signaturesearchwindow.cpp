@@ -0,0 +1,93 @@
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMessageBox>
+#include "backgroundtask.h"
+#include "signaturesearchwindow.h"
+
+void MatchListModel::setMatches(const QVector<qint64> &matches)
+{
+    beginResetModel();
+    mMatches = matches;
+    endResetModel();
+}
+
+int MatchListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : mMatches.size();
+}
+
+int MatchListModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 2;
+}
+
+QVariant MatchListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (index.row() >= mMatches.size()))
+        return QVariant();
+
+    qint64 offset = mMatches.at(index.row());
+    if (role == Qt::DisplayRole) {
+        if (index.column() == 0)
+            return QString::asprintf("DW %lld", offset);
+        return QString::asprintf("0x%llx", offset * 4);
+    } else if (role == Qt::TextAlignmentRole) {
+        return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    return QVariant();
+}
+
+QVariant MatchListModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if ((orientation != Qt::Horizontal) || (role != Qt::DisplayRole))
+        return QVariant();
+    return (section == 0) ? tr("DWORD Offset") : tr("Byte Offset");
+}
+
+SignatureSearchWin::SignatureSearchWin(QWidget *parent, const ResultStore *store, bool canDecode, qint64 maxMatches)
+    : QDialog(parent)
+    , ui(new Ui::SignatureSearchWin)
+    , store(store)
+    , canDecode(canDecode)
+    , maxMatches(static_cast<int>(qBound<qint64>(1, maxMatches, SignatureSearch::kMaxMatches)))
+{
+    ui->setupUi(this);
+    model = new MatchListModel(this);
+    ui->matchTable->setModel(model);
+    connect(ui->searchButton, &QPushButton::clicked, this, &SignatureSearchWin::searchButton_clicked_handler);
+    connect(ui->patternEdit, &QLineEdit::returnPressed, this, &SignatureSearchWin::searchButton_clicked_handler);
+    connect(ui->decodeButton, &QPushButton::clicked, this, &QDialog::accept);
+}
+
+SignatureSearchWin::~SignatureSearchWin()
+{
+    delete ui;
+}
+
+void SignatureSearchWin::searchButton_clicked_handler()
+{
+    SignaturePattern pattern;
+    QString error;
+    if (!SignatureSearch::parse(ui->patternEdit->text(), &pattern, &error)) {
+        QMessageBox::warning(this, tr("Error"), error);
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    bool truncated = false;
+    BackgroundTask::run(this, tr("Searching..."),
+        [&]() { mMatches = SignatureSearch::search(*store, pattern, maxMatches, &truncated); }, nullptr, nullptr, 0);
+
+    qint64 elapsed = qMax<qint64>(1, timer.elapsed());
+    qDebug("%s[%d]: %lld dwords, %d matches%s, %lld ms", __func__, __LINE__,
+           store->dwordCount(), mMatches.size(), truncated ? " (truncated)" : "", elapsed);
+    // 达到上限时只保留前面的匹配，显示为 "N+"
+    QString count = truncated ? QString("%1+").arg(mMatches.size()) : QString::number(mMatches.size());
+    ui->summaryLabel->setText(tr("%1 matches in %2 DWORDs (%3 MB/s)")
+                              .arg(count).arg(store->dwordCount())
+                              .arg(store->dwordCount() * 4 / 1024 * 1000 / 1024 / elapsed));
+    model->setMatches(mMatches);
+    ui->matchTable->resizeColumnsToContents();
+    ui->decodeButton->setEnabled(canDecode && !mMatches.isEmpty());
+}
@@ -0,0 +1,112 @@
+#ifndef SIGNATURESEARCHWINDOW_H
+#define SIGNATURESEARCHWINDOW_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <QAbstractTableModel>
+#include "signaturesearch.h"
+#include "tableview.h"
+
+QT_BEGIN_NAMESPACE
+
+class UiSignatureSearchWin
+{
+public:
+    QVBoxLayout *contentLayout;
+    QHBoxLayout *patternLayout;
+    QLineEdit *patternEdit;
+    QPushButton *searchButton;
+    QPushButton *decodeButton;
+    QLabel *summaryLabel;
+    TableView *matchTable;
+
+    void setupUi(QDialog *dialog)
+    {
+        dialog->setWindowTitle(QObject::tr("Signature Search"));
+        dialog->resize(600, 500);
+
+        contentLayout = new QVBoxLayout(dialog);
+        patternLayout = new QHBoxLayout();
+
+        patternEdit = new QLineEdit(dialog);
+        patternEdit->setObjectName(QString::fromUtf8("patternEdit"));
+        patternEdit->setPlaceholderText(QObject::tr("e.g. A5xx_xx0F * 80000000/80000000"));
+        patternLayout->addWidget(patternEdit);
+
+        searchButton = new QPushButton(QObject::tr("Search"), dialog);
+        searchButton->setObjectName(QString::fromUtf8("searchButton"));
+        searchButton->setDefault(true);
+        patternLayout->addWidget(searchButton);
+
+        decodeButton = new QPushButton(QObject::tr("Decode Matches"), dialog);
+        decodeButton->setObjectName(QString::fromUtf8("decodeButton"));
+        decodeButton->setEnabled(false);
+        patternLayout->addWidget(decodeButton);
+        contentLayout->addLayout(patternLayout);
+
+        summaryLabel = new QLabel(dialog);
+        summaryLabel->setObjectName(QString::fromUtf8("summaryLabel"));
+        contentLayout->addWidget(summaryLabel);
+
+        matchTable = new TableView(dialog);
+        matchTable->setObjectName(QString::fromUtf8("matchTable"));
+        matchTable->verticalHeader()->setVisible(false);
+        // 设置内容不可编辑
+        matchTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        contentLayout->addWidget(matchTable);
+    }
+};
+
+namespace Ui {
+    class SignatureSearchWin: public UiSignatureSearchWin {};
+} // namespace Ui
+
+QT_END_NAMESPACE
+
+// 匹配位置列表
+class MatchListModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit MatchListModel(QObject *parent = nullptr) : QAbstractTableModel(parent) {}
+
+    void setMatches(const QVector<qint64> &matches);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    QVector<qint64> mMatches;
+};
+
+// 特征搜索窗口，点击 Decode Matches 后关闭窗口，由调用者按模板解析各匹配位置
+class SignatureSearchWin : public QDialog
+{
+    Q_OBJECT
+public:
+    // maxMatches 为最多保留的匹配个数，解析时每个匹配为一组
+    SignatureSearchWin(QWidget *parent, const ResultStore *store, bool canDecode, qint64 maxMatches);
+    ~SignatureSearchWin();
+
+    const QVector<qint64> &matches() const { return mMatches; }
+
+private slots:
+    void searchButton_clicked_handler();
+
+private:
+    Ui::SignatureSearchWin *ui;
+    const ResultStore *store;
+    bool canDecode;
+    int maxMatches;
+    QVector<qint64> mMatches;
+    MatchListModel *model;
+};
+
+#endif // SIGNATURESEARCHWINDOW_H
@@ -0,0 +1,101 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <QVector>
+
+// 单生产者单消费者无锁环形缓冲区
+// 生产者和消费者各自只写自己的位置计数，读写位置是累计值，不会回绕。
+template <typename T>
+class SpscRing
+{
+public:
+    // 构造时不分配空间，开始使用前调用 reset()
+    SpscRing()
+        : buffer(nullptr)
+        , mask(0)
+        , head(0)
+        , tail(0)
+    {
+    }
+
+    // 容量向上取整为 2 的幂，读写位置清零
+    // 只能在生产者和消费者都不访问时调用
+    void reset(int capacity)
+    {
+        int size = 1;
+        while (size < capacity)
+            size <<= 1;
+        slots.fill(T(), size);
+        buffer = slots.data();
+        mask = static_cast<quint64>(size - 1);
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+    // 释放空间，之后在下次 reset() 前不能使用
+    void release()
+    {
+        slots = QVector<T>();
+        buffer = nullptr;
+        mask = 0;
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+    int capacity() const { return slots.size(); }
+
+    // 生产者调用，返回实际写入的个数
+    int push(const T *data, int count)
+    {
+        quint64 h = head.load(std::memory_order_relaxed);
+        quint64 t = tail.load(std::memory_order_acquire);
+        int space = capacity() - static_cast<int>(h - t);
+        int n = qMin(count, space);
+        for (int i = 0; i < n; i++)
+            buffer[(h + i) & mask] = data[i];
+        head.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+    // 消费者调用，返回实际读出的个数
+    int pop(T *data, int count)
+    {
+        quint64 t = tail.load(std::memory_order_relaxed);
+        quint64 h = head.load(std::memory_order_acquire);
+        int n = qMin(count, static_cast<int>(h - t));
+        for (int i = 0; i < n; i++)
+            data[i] = buffer[(t + i) & mask];
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+    // 消费者调用，查看下一个元素但不取出
+    bool peek(T *data) const
+    {
+        quint64 t = tail.load(std::memory_order_relaxed);
+        quint64 h = head.load(std::memory_order_acquire);
+        if (h == t)
+            return false;
+        *data = buffer[t & mask];
+        return true;
+    }
+
+    int available() const
+    {
+        return static_cast<int>(head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed));
+    }
+
+    quint64 writePosition() const { return head.load(std::memory_order_acquire); }
+    quint64 readPosition() const { return tail.load(std::memory_order_acquire); }
+
+private:
+    QVector<T> slots;
+    T *buffer;
+    quint64 mask;
+    // 分开放在不同缓存行，避免伪共享
+    alignas(64) std::atomic<quint64> head;
+    alignas(64) std::atomic<quint64> tail;
+};
+
+#endif // SPSCRING_H
@@ -56,6 +56,14 @@ StructViewWin::StructViewWin(QWidget *parent)
     ui->displayTable->viewport()->installEventFilter(this);
     // 启用视口的鼠标追踪
     ui->displayTable->viewport()->setMouseTracking(true);
+
+    // 点击字段时通知主窗口定位结果表中的所有对应行
+    connect(ui->displayTable, &TableView::clicked, this, [this](const QModelIndex &index) {
+        // 合并单元格点击时返回左上角索引，即字段的 LSB
+        if (model->item(index.row(), index.column()) == nullptr)
+            return;
+        emit fieldClicked(index.row(), index.column());
+    });
 }
 
 StructViewWin::~StructViewWin()
@@ -64,6 +64,10 @@ public:
     ~StructViewWin();
     void fieldSelected_handler(int dw, int lsb);
 
+signals:
+    // 用户点击了结构视图中的字段
+    void fieldClicked(int dw, int lsb);
+
 public slots:
     void tempMgmt_tempSelected_handler(const DescObj &rootObj);
 
@@ -6,6 +6,7 @@
 #include <QMessageBox>
 #include <QKeySequence>
 #include <QLabel>
+#include <QMetaMethod>
 #include "tableview.h"
 
 TableView::TableView(QWidget *parent)
@@ -56,46 +57,64 @@ void TableView::itemSelected_handler(int row, int col)
     }
 }
 
+void TableView::addMenuAction(QAction *action)
+{
+    if (menu->actions().size() == 1)
+        menu->addSeparator();
+    menu->addAction(action);
+}
+
 void TableView::copyAction_triggered_handler()
 {
-    // 获取选中的范围
-    const QModelIndexList &selectedIndexes = selectionModel()->selectedIndexes();
-    if (selectedIndexes.isEmpty()) {
+    // 按选择区间计算边界，不展开每个选中的单元格
+    const QItemSelection selection = selectionModel()->selection();
+    if (selection.isEmpty()) {
         return; // 如果没有选中任何内容，直接返回
     }
 
-    // 确定选中范围的行列边界
-    int minRow = selectedIndexes.first().row();
-    int maxRow = selectedIndexes.first().row();
-    int minCol = selectedIndexes.first().column();
-    int maxCol = selectedIndexes.first().column();
-
-    for (const QModelIndex &index : selectedIndexes) {
-        minRow = qMin(minRow, index.row());
-        maxRow = qMax(maxRow, index.row());
-        minCol = qMin(minCol, index.column());
-        maxCol = qMax(maxCol, index.column());
+    int minRow = selection.first().top();
+    int maxRow = selection.first().bottom();
+    int minCol = selection.first().left();
+    int maxCol = selection.first().right();
+    for (const QItemSelectionRange &range : selection) {
+        minRow = qMin(minRow, range.top());
+        maxRow = qMax(maxRow, range.bottom());
+        minCol = qMin(minCol, range.left());
+        maxCol = qMax(maxCol, range.right());
+    }
+
+    // 大量行交给数据提供者异步生成
+    static const QMetaMethod largeCopySignal = QMetaMethod::fromSignal(&TableView::largeCopyRequested);
+    if ((maxRow - minRow + 1 > kLargeCopyRows) && isSignalConnected(largeCopySignal)) {
+        emit largeCopyRequested(minRow, maxRow, minCol, maxCol);
+        return;
     }
 
-    // 将选中的内容格式化为文本
+    // 将选中的内容格式化为文本，按每个单元格约 12 个字符预先分配缓冲区，
+    // 按 64 位计算，超过上限时拒绝复制
+    qint64 estimate = qint64(maxRow - minRow + 1) * (maxCol - minCol + 1) * 12;
+    if (estimate > kMaxCopyChars) {
+        QMessageBox::warning(this, tr("Error"), tr("The selection is too large to copy"));
+        return;
+    }
     QString text;
+    text.reserve(static_cast<int>(estimate));
     for (int row = minRow; row <= maxRow; ++row) {
         for (int col = minCol; col <= maxCol; ++col) {
-            QModelIndex index = model()->index(row, col);
-            text += index.data().toString();
+            text += model()->index(row, col).data().toString();
 
             if (col < maxCol) {
-                text += "\t"; // 列之间用制表符分隔
+                text += '\t'; // 列之间用制表符分隔
             }
         }
         if (row < maxRow) {
-            text += "\n"; // 行之间用换行符分隔
+            text += '\n'; // 行之间用换行符分隔
         }
     }
 
     // 将文本复制到剪贴板
     QApplication::clipboard()->setText(text);
-    qDebug() << "Copied to clipboard:\n" << text;
+    qDebug("%s[%d]: copied %d rows, %d chars", __func__, __LINE__, maxRow - minRow + 1, text.size());
 }
 
 void TableView::findAndSelectCell(const QString &keyword, bool searchForward,
@@ -17,6 +17,17 @@ class TableView : public QTableView
 public:
     TableView(QWidget *parent = nullptr);
     void itemSelected_handler(int row, int col);
+    // 在右键菜单中追加动作
+    void addMenuAction(QAction *action);
+
+    // 复制超过该行数时，如果连接了 largeCopyRequested，交给连接方处理
+    static const int kLargeCopyRows = 20000;
+    // 复制的文本长度上限（字符数），留足 QString 的 2^30 字符上限的余量
+    static const int kMaxCopyChars = 1 << 29;
+
+signals:
+    // 复制大量行：选中区域的行列边界
+    void largeCopyRequested(int firstRow, int lastRow, int firstCol, int lastCol);
 
 private slots:
     void copyAction_triggered_handler();
@@ -0,0 +1,456 @@
+#include <algorithm>
+#include <climits>
+#include <QBrush>
+#include <QDebug>
+#include <QRegularExpression>
+#include "templateeditmodel.h"
+
+TemplateEditModel::TemplateEditModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+void TemplateEditModel::setDesc(const DescObj &desc)
+{
+    beginResetModel();
+    rows.clear();
+    names.clear();
+    for (int i = 0; i < desc.size(); i++) {
+        const DescDWordObj &dword = desc.at(i);
+        for (int j = 0; j < dword.size(); j++) {
+            const DescFieldObj &fieldObj = dword.at(j);
+            Row row;
+            row.dw = i;
+            row.name = fieldObj["field"].toString();
+            row.lsb = fieldObj["LSB"].toInt(-1);
+            row.msb = fieldObj["MSB"].toInt(-1);
+            row.obj = fieldObj;
+            rows.push_back(row);
+            addName(row.name);
+        }
+    }
+    // 引用定位到它之后的第一行
+    includes.clear();
+    int anchor = 0;
+    for (const DescInclude &include : desc.includes()) {
+        while ((anchor < rows.size()) && (rows.at(anchor).dw < include.dwIdx))
+            anchor++;
+        int dwDelta = (anchor < rows.size()) ? (rows.at(anchor).dw - include.dwIdx) : 0;
+        includes.push_back({include, anchor, dwDelta});
+    }
+    for (int r = 0; r < rows.size(); r++)
+        r = validateDw(r);
+    endResetModel();
+    qDebug("%s[%d]: %d fields", __func__, __LINE__, rows.size());
+}
+
+DescObj TemplateEditModel::toDesc() const
+{
+    DescObj desc;
+    for (const Row &row : rows) {
+        if (row.isEmpty() || (row.dw < 0))
+            continue;
+        while (desc.size() <= row.dw)
+            desc.push_back(DescDWordObj());
+        DescFieldObj fieldObj(row.obj);
+        fieldObj["field"] = row.name;
+        fieldObj["LSB"] = row.lsb;
+        fieldObj["MSB"] = row.msb;
+        desc[row.dw].push_back(fieldObj);
+    }
+
+    QVector<DescInclude> descIncludes;
+    for (const IncludeAnchor &anchor : includes) {
+        DescInclude include = anchor.include;
+        include.dwIdx = (anchor.row < rows.size()) ? (rows.at(anchor.row).dw - anchor.dwDelta) : desc.size();
+        include.dwIdx = qBound(0, include.dwIdx, desc.size());
+        descIncludes.push_back(include);
+    }
+    // 修改 DW 编号后行的顺序可能与 DW 不一致
+    std::stable_sort(descIncludes.begin(), descIncludes.end(), [](const DescInclude &a, const DescInclude &b) {
+        return a.dwIdx < b.dwIdx;
+    });
+    desc.setIncludes(descIncludes);
+    return desc;
+}
+
+int TemplateEditModel::errorRows() const
+{
+    int count = 0;
+    for (const Row &row : rows) {
+        if (!row.isEmpty() && ((row.errors & ~kWarnings) || nameError(row)))
+            count++;
+    }
+    return count;
+}
+
+int TemplateEditModel::pasteRows(int row, const QString &text)
+{
+    row = qBound(0, row, rows.size());
+    int dw = (row > 0) ? rows.at(row - 1).dw : 0;
+
+    QVector<Row> pasted;
+    int skipped = 0;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    const QStringList lines = text.split('\n', Qt::SkipEmptyParts);
+#else
+    const QStringList lines = text.split('\n', QString::SkipEmptyParts);
+#endif
+    for (const QString &line : lines) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        QStringList parts = line.split(QRegularExpression("[\\s,;]+"), Qt::SkipEmptyParts);
+#else
+        QStringList parts = line.split(QRegularExpression("[\\s,;]+"), QString::SkipEmptyParts);
+#endif
+        bool dwOk = true;
+        bool lsbOk = false;
+        bool msbOk = false;
+        Row cur;
+        if (parts.size() == 4)
+            dw = parts.takeFirst().toInt(&dwOk);
+        if ((parts.size() == 3) && dwOk) {
+            cur.dw = dw;
+            cur.name = parts.at(0);
+            cur.lsb = parts.at(1).toInt(&lsbOk);
+            cur.msb = parts.at(2).toInt(&msbOk);
+        }
+        if (!lsbOk || !msbOk) {
+            skipped++;
+            continue;
+        }
+        pasted.push_back(cur);
+    }
+    if (skipped > 0)
+        qWarning("%s[%d]: %d lines skipped", __func__, __LINE__, skipped);
+    if (pasted.isEmpty())
+        return 0;
+
+    beginInsertRows(QModelIndex(), row, row + pasted.size() - 1);
+    rows.insert(row, pasted.size(), Row());
+    shiftIncludes(row, pasted.size());
+    for (int i = 0; i < pasted.size(); i++) {
+        rows[row + i] = pasted.at(i);
+        addName(pasted.at(i).name);
+    }
+    endInsertRows();
+    validateAround(row, row + pasted.size() - 1);
+    emit dataChanged(index(0, FieldColumn), index(rows.size() - 1, FieldColumn));
+    return pasted.size();
+}
+
+void TemplateEditModel::shiftBits(int first, int last, int offset)
+{
+    first = qMax(0, first);
+    last = qMin(last, rows.size() - 1);
+    if ((first > last) || (offset == 0))
+        return;
+    for (int r = first; r <= last; r++) {
+        Row &row = rows[r];
+        if (row.lsb >= 0)
+            row.lsb += offset;
+        if (row.msb >= 0)
+            row.msb += offset;
+    }
+    validateAround(first, last);
+}
+
+void TemplateEditModel::renumberDws()
+{
+    int next = -1;
+    int prevDw = INT_MIN;
+    for (Row &row : rows) {
+        // 空行沿用上一行的编号
+        if (row.isEmpty()) {
+            row.dw = qMax(next, 0);
+            continue;
+        }
+        if (row.dw != prevDw) {
+            prevDw = row.dw;
+            next++;
+        }
+        row.dw = next;
+    }
+    validateAround(0, rows.size() - 1);
+}
+
+int TemplateEditModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : rows.size();
+}
+
+int TemplateEditModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant TemplateEditModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (index.row() >= rows.size()))
+        return QVariant();
+
+    const Row &row = rows.at(index.row());
+    if ((role == Qt::DisplayRole) || (role == Qt::EditRole)) {
+        switch (index.column()) {
+        case DwColumn:
+            return row.dw;
+        case FieldColumn:
+            return row.name;
+        case LsbColumn:
+            return (row.lsb < 0) ? QVariant(QString()) : QVariant(row.lsb);
+        case MsbColumn:
+            return (row.msb < 0) ? QVariant(QString()) : QVariant(row.msb);
+        default:
+            break;
+        }
+    } else if ((role == Qt::ForegroundRole) && !row.isEmpty()) {
+        switch (index.column()) {
+        case DwColumn:
+            if (row.errors & BadDw)
+                return QBrush(Qt::red);
+            if (row.errors & DwGap)
+                return QBrush(Qt::darkYellow);
+            break;
+        case FieldColumn:
+            if (nameError(row))
+                return QBrush(Qt::red);
+            if (nameWarning(row))
+                return QBrush(Qt::darkYellow);
+            break;
+        case LsbColumn:
+        case MsbColumn:
+            if (row.errors & (BadRange | Overlap))
+                return QBrush(Qt::red);
+            if (row.errors & BitOrder)
+                return QBrush(Qt::darkYellow);
+            break;
+        default:
+            break;
+        }
+    } else if (role == Qt::ToolTipRole) {
+        QString text = errorText(row);
+        if (!text.isEmpty())
+            return text;
+    }
+    return QVariant();
+}
+
+QVariant TemplateEditModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole)
+        return QVariant();
+    if (orientation == Qt::Vertical)
+        return section + 1;
+    switch (section) {
+    case DwColumn:
+        return tr("DW");
+    case FieldColumn:
+        return tr("Field");
+    case LsbColumn:
+        return tr("LSB");
+    case MsbColumn:
+        return tr("MSB");
+    default:
+        return QVariant();
+    }
+}
+
+bool TemplateEditModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid() || (index.row() >= rows.size()) || (role != Qt::EditRole))
+        return false;
+
+    Row &row = rows[index.row()];
+    QString text = value.toString().trimmed();
+    bool ok = true;
+    int number = text.isEmpty() ? -1 : text.toInt(&ok);
+    switch (index.column()) {
+    case DwColumn:
+        if (!ok || (number < 0))
+            return false;
+        row.dw = number;
+        break;
+    case FieldColumn:
+        removeName(row.name);
+        row.name = text;
+        addName(row.name);
+        // 重名标记可能涉及其它行
+        emit dataChanged(this->index(0, FieldColumn), this->index(rows.size() - 1, FieldColumn));
+        break;
+    case LsbColumn:
+        if (!ok)
+            return false;
+        row.lsb = number;
+        break;
+    case MsbColumn:
+        if (!ok)
+            return false;
+        row.msb = number;
+        break;
+    default:
+        return false;
+    }
+    validateAround(index.row(), index.row());
+    return true;
+}
+
+Qt::ItemFlags TemplateEditModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return Qt::NoItemFlags;
+    return QAbstractTableModel::flags(index) | Qt::ItemIsEditable;
+}
+
+bool TemplateEditModel::insertRows(int row, int count, const QModelIndex &parent)
+{
+    if (parent.isValid() || (row < 0) || (row > rows.size()) || (count <= 0))
+        return false;
+
+    // 新行属于上一行所在的 DW
+    Row blank;
+    blank.dw = (row > 0) ? rows.at(row - 1).dw : 0;
+    beginInsertRows(parent, row, row + count - 1);
+    rows.insert(row, count, blank);
+    shiftIncludes(row, count);
+    endInsertRows();
+    validateAround(row, row + count - 1);
+    return true;
+}
+
+bool TemplateEditModel::removeRows(int row, int count, const QModelIndex &parent)
+{
+    if (parent.isValid() || (row < 0) || (count <= 0) || (row + count > rows.size()))
+        return false;
+
+    for (int r = row; r < row + count; r++)
+        removeName(rows.at(r).name);
+    beginRemoveRows(parent, row, row + count - 1);
+    rows.remove(row, count);
+    shiftIncludes(row, -count);
+    endRemoveRows();
+    validateAround(row, row - 1);
+    emit dataChanged(index(0, FieldColumn), index(rows.size() - 1, FieldColumn));
+    return true;
+}
+
+void TemplateEditModel::shiftIncludes(int row, int count)
+{
+    // 插入到引用所在行之前的行属于上一个 DW，引用随原来的行后移；
+    // 删除引用所在的行时引用移到删除处之后的第一行
+    for (IncludeAnchor &anchor : includes) {
+        if (anchor.row < row)
+            continue;
+        if (count > 0) {
+            anchor.row += count;
+        } else if (anchor.row < row - count) {
+            anchor.row = row;
+            anchor.dwDelta = 0;
+        } else {
+            anchor.row += count;
+        }
+    }
+}
+
+void TemplateEditModel::validateAround(int first, int last)
+{
+    if (rows.isEmpty())
+        return;
+
+    int begin = qBound(0, first - 1, rows.size() - 1);
+    int end = qBound(0, last + 1, rows.size() - 1);
+    while ((begin > 0) && (rows.at(begin - 1).dw == rows.at(begin).dw))
+        begin--;
+
+    int r = begin;
+    int changedLast = begin;
+    while (r <= end) {
+        changedLast = validateDw(r);
+        r = changedLast + 1;
+    }
+    // 后一个 DW 的编号是否连续取决于前一个
+    if (r < rows.size())
+        changedLast = validateDw(r);
+    emit dataChanged(index(begin, 0), index(changedLast, ColumnCount - 1));
+}
+
+int TemplateEditModel::validateDw(int row)
+{
+    int dw = rows.at(row).dw;
+    int first = row;
+    while ((first > 0) && (rows.at(first - 1).dw == dw))
+        first--;
+    int last = row;
+    while ((last + 1 < rows.size()) && (rows.at(last + 1).dw == dw))
+        last++;
+
+    // DW 按行递增；跳过的 DW 保存为没有字段的 DW，与 checkValid 一致只是警告
+    int prevDw = (first == 0) ? -1 : rows.at(first - 1).dw;
+    int dwErrors = (dw <= prevDw) ? BadDw : ((dw != prevDw + 1) ? DwGap : 0);
+    uint32_t used = 0;
+    int prevLsb = -1;
+    for (int r = first; r <= last; r++) {
+        Row &cur = rows[r];
+        cur.errors = dwErrors;
+        if (cur.isEmpty())
+            continue;
+        if ((cur.lsb < 0) || (cur.msb > 31) || (cur.lsb > cur.msb)) {
+            cur.errors |= BadRange;
+            continue;
+        }
+        uint32_t mask = DescObj::subfieldMask(cur.lsb, cur.msb);
+        if (used & mask)
+            cur.errors |= Overlap;
+        if (cur.lsb < prevLsb)
+            cur.errors |= BitOrder;
+        prevLsb = cur.lsb;
+        used |= mask;
+    }
+    return last;
+}
+
+void TemplateEditModel::addName(const QString &name)
+{
+    if (!name.isEmpty())
+        names[name]++;
+}
+
+void TemplateEditModel::removeName(const QString &name)
+{
+    if (name.isEmpty())
+        return;
+    auto it = names.find(name);
+    if ((it != names.end()) && (--it.value() <= 0))
+        names.erase(it);
+}
+
+bool TemplateEditModel::nameError(const Row &row) const
+{
+    return !row.isEmpty() && row.name.isEmpty();
+}
+
+bool TemplateEditModel::nameWarning(const Row &row) const
+{
+    return !row.isEmpty() && !row.name.isEmpty() && (names.value(row.name) > 1);
+}
+
+QString TemplateEditModel::errorText(const Row &row) const
+{
+    if (row.isEmpty())
+        return QString();
+
+    QStringList messages;
+    if (row.name.isEmpty())
+        messages.push_back(tr("Field has no name"));
+    else if (names.value(row.name) > 1)
+        messages.push_back(tr("Duplicate field name"));
+    if (row.errors & BadDw)
+        messages.push_back(tr("DW must be greater than the DW above"));
+    if (row.errors & DwGap)
+        messages.push_back(tr("DWs without fields are skipped before this DW"));
+    if (row.errors & BadRange)
+        messages.push_back(tr("Bits must satisfy 0 <= LSB <= MSB <= 31"));
+    if (row.errors & Overlap)
+        messages.push_back(tr("Bits overlap with a field above"));
+    if (row.errors & BitOrder)
+        messages.push_back(tr("Not in ascending bit order"));
+    return messages.join('\n');
+}
@@ -0,0 +1,98 @@
+#ifndef TEMPLATEEDITMODEL_H
+#define TEMPLATEEDITMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QJsonObject>
+#include <QVector>
+#include "descobj.h"
+
+// 模板编辑表格的数据模型，每行一个位字段，派生字段不在表格中编辑
+// 修改某行后只重新检查该行所在 DW 及相邻 DW 的位占用掩码，字段名重复用计数表判断，
+// 载入或批量修改时不会逐个单元格触发检查。
+// 空行（无名称、无位号）只是占位，检查和保存时忽略。
+// 子模板引用不在表格中显示，但跟随它之后的第一行移动，插入、删除、粘贴和重新编号后 DW 位置仍然对应。
+class TemplateEditModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    enum Column { DwColumn, FieldColumn, LsbColumn, MsbColumn, ColumnCount };
+
+    explicit TemplateEditModel(QObject *parent = nullptr);
+
+    void setDesc(const DescObj &desc);
+    // 按行顺序组成模板，保留原字段对象中表格没有的属性（如 format）和子模板引用，不含派生字段
+    DescObj toDesc() const;
+    // 有错误的行数，只在保存时调用
+    int errorRows() const;
+
+    // 解析 "DW<Tab>名称<Tab>LSB<Tab>MSB" 或 "名称 LSB MSB" 格式的多行文本，插入到 row 之前
+    // 省略 DW 时使用 row 上一行的 DW，返回插入的行数
+    int pasteRows(int row, const QString &text);
+    // [first, last] 行的 LSB 和 MSB 加上 offset
+    void shiftBits(int first, int last, int offset);
+    // 按行顺序把 DW 重新编号为从 0 开始的连续值，原 DW 改变处加一
+    void renumberDws();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    bool insertRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
+    bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
+
+private:
+    enum RowError {
+        BadRange = 1,   // 位号越界或 LSB 大于 MSB
+        Overlap = 2,    // 与同一 DW 中前面的字段重叠
+        BadDw = 4,      // DW 比上一段小
+        BitOrder = 8,   // 未按 LSB 升序排列，只是警告
+        DwGap = 16,     // DW 不从 0 开始或与上一段不连续，中间为没有字段的 DW，只是警告
+    };
+    // 与 DescObj::checkValid 一致，只是警告的问题不影响保存
+    static const int kWarnings = BitOrder | DwGap;
+
+    struct Row
+    {
+        int dw = 0;
+        QString name;
+        int lsb = -1;
+        int msb = -1;
+        // 原字段对象
+        QJsonObject obj;
+        int errors = 0;
+
+        bool isEmpty() const { return name.isEmpty() && (lsb < 0) && (msb < 0); }
+    };
+
+    // 子模板引用位于 row 行之前，row 为行数时位于末尾；
+    // 引用之前有没有字段的 DW 时 dwDelta 为它们的个数
+    struct IncludeAnchor
+    {
+        DescInclude include;
+        int row;
+        int dwDelta;
+    };
+
+    // 在 row 之前插入或删除 count 行后调整引用所在的行
+    void shiftIncludes(int row, int count);
+    // 重新检查 [first, last] 行以及与之相邻的行所在的 DW
+    void validateAround(int first, int last);
+    // 检查 row 所在的连续同 DW 行，返回最后一行
+    int validateDw(int row);
+    void addName(const QString &name);
+    void removeName(const QString &name);
+    // 没有名称为错误，重名为警告
+    bool nameError(const Row &row) const;
+    bool nameWarning(const Row &row) const;
+    QString errorText(const Row &row) const;
+
+    QVector<Row> rows;
+    QVector<IncludeAnchor> includes;
+    // 各字段名出现的次数
+    QHash<QString, int> names;
+};
+
+#endif // TEMPLATEEDITMODEL_H
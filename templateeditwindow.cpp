@@ -1,4 +1,8 @@
 #include "templateeditwindow.h"
+#include <algorithm>
+#include <QApplication>
+#include <QClipboard>
+#include <QInputDialog>
 #include <QMessageBox>
 
 TmpEditWin::TmpEditWin(QWidget *parent, DescObj &obj)
@@ -12,31 +16,33 @@ TmpEditWin::TmpEditWin(QWidget *parent, DescObj &obj)
     ui->setupUi(this);
     qDebug() << "hello, TmpEditWin";
 
-    showTemplate();
-
-    // 获取默认前景色
-    QPalette palette = ui->editTable->palette();
-    QColor defaultColor = palette.color(QPalette::Text);
-    defaultBrush = QBrush(defaultColor);
+    // 表格只编辑位字段，整个模板一次载入模型
+    model = new TemplateEditModel(this);
+    model->setDesc(mDescObj);
+    ui->editTable->setModel(model);
+    ui->editTable->horizontalHeader()->setSectionResizeMode(TemplateEditModel::FieldColumn, QHeaderView::Stretch);
 
     insertBelowAction = new QAction(tr("Insert a row below"), this);
     insertAboveAction = new QAction(tr("Insert a row above"), this);
-    deleteRowAction = new QAction(tr("Delete this row"), this);
+    deleteRowAction = new QAction(tr("Delete selected rows"), this);
+    pasteRowsAction = new QAction(tr("Paste rows"), this);
+    shiftBitsAction = new QAction(tr("Shift bits of selected rows..."), this);
+    renumberAction = new QAction(tr("Renumber DWs"), this);
 
     connect(insertBelowAction, &QAction::triggered, this, &TmpEditWin::insertBelowAction_triggered_handler);
     connect(insertAboveAction, &QAction::triggered, this, &TmpEditWin::insertAboveAction_triggered_handler);
     connect(deleteRowAction, &QAction::triggered, this, &TmpEditWin::deleteRowAction_triggered_handler);
+    connect(pasteRowsAction, &QAction::triggered, this, &TmpEditWin::pasteRowsAction_triggered_handler);
+    connect(shiftBitsAction, &QAction::triggered, this, &TmpEditWin::shiftBitsAction_triggered_handler);
+    connect(renumberAction, &QAction::triggered, this, &TmpEditWin::renumberAction_triggered_handler);
 
-    ui->contextMenu->addAction(insertAboveAction);
-    ui->contextMenu->addAction(insertBelowAction);
-    ui->contextMenu->addAction(deleteRowAction);
-
-    ui->editTable->setContextMenuPolicy(Qt::CustomContextMenu);
-    connect(ui->editTable, &QTableWidget::customContextMenuRequested, this, [this](const QPoint &pos) {
-        this->ui->contextMenu->exec(this->ui->editTable->mapToGlobal(pos));
-    });
+    ui->editTable->addMenuAction(insertAboveAction);
+    ui->editTable->addMenuAction(insertBelowAction);
+    ui->editTable->addMenuAction(deleteRowAction);
+    ui->editTable->addMenuAction(pasteRowsAction);
+    ui->editTable->addMenuAction(shiftBitsAction);
+    ui->editTable->addMenuAction(renumberAction);
 
-    connect(ui->editTable, &QTableWidget::cellChanged, this, &TmpEditWin::checkCellValid);
     connect(ui->okButton, &QPushButton::clicked, this, &TmpEditWin::saveAndExit);
     connect(ui->cancelButton, &QPushButton::clicked, this, &TmpEditWin::close);
 
@@ -49,71 +55,6 @@ TmpEditWin::~TmpEditWin()
     delete ui;
 }
 
-int TmpEditWin::rowCount()
-{
-    return ui->editTable->rowCount();
-}
-
-void TmpEditWin::convertRow(int row, DescFieldObj &fieldObj, int &dwIdx)
-{
-    auto item = ui->editTable->item(row, 0);
-    if (item) {
-        dwIdx = item->text().toInt();
-    }
-    item = ui->editTable->item(row, 1);
-    if (item) {
-        fieldObj["field"] = QJsonValue(item->text());
-    }
-    item = ui->editTable->item(row, 2);
-    if (item) {
-        fieldObj["LSB"] = QJsonValue(item->text().toInt());
-    }
-    item = ui->editTable->item(row, 3);
-    if (item) {
-        fieldObj["MSB"] = QJsonValue(item->text().toInt());
-    }
-    qDebug() << "Convert row" << row << "to DW" << dwIdx;
-}
-
-void TmpEditWin::showTemplate()
-{
-    ui->editTable->setRowCount(0); // 删除所有行
-    int row = 0;
-    for (int i = 0; i < mDescObj.size(); i++) {
-        DescDWordObj dword = mDescObj.at(i);
-        for (int j = 0; j < dword.size(); j++) {
-            DescFieldObj field = dword.at(j);
-            ui->editTable->insertRow(row);
-            ui->editTable->setItem(row, 0, new QTableWidgetItem(QString::number(i)));
-            ui->editTable->setItem(row, 1, new QTableWidgetItem(field["field"].toString()));
-            ui->editTable->setItem(row, 2, new QTableWidgetItem(QString::number(field["LSB"].toInt())));
-            ui->editTable->setItem(row, 3, new QTableWidgetItem(QString::number(field["MSB"].toInt())));
-
-            ++row;
-        }
-    }
-}
-
-void TmpEditWin::addRow()
-{
-    ui->editTable->insertRow(rowCount());
-}
-
-void TmpEditWin::insertRowBelow(int row)
-{
-    ui->editTable->insertRow(row + 1);
-}
-
-void TmpEditWin::insertRowAt(int row)
-{
-    ui->editTable->insertRow(row);
-}
-
-void TmpEditWin::deleteRowAt(int row)
-{
-    ui->editTable->removeRow(row);
-}
-
 DescObj &TmpEditWin::getEditedDesc(QWidget *parent, DescObj &inputDesc, bool *changed)
 {
     TmpEditWin editWin(parent, inputDesc);
@@ -123,211 +64,96 @@ DescObj &TmpEditWin::getEditedDesc(QWidget *parent, DescObj &inputDesc, bool *ch
     return inputDesc;
 }
 
+QVector<QPair<int, int>> TmpEditWin::selectedRowRanges() const
+{
+    QVector<QPair<int, int>> ranges;
+    for (const QItemSelectionRange &range : ui->editTable->selectionModel()->selection())
+        ranges.push_back(qMakePair(range.top(), range.bottom()));
+    std::sort(ranges.begin(), ranges.end());
+
+    QVector<QPair<int, int>> merged;
+    for (const QPair<int, int> &range : ranges) {
+        if (!merged.isEmpty() && (range.first <= merged.last().second + 1))
+            merged.last().second = qMax(merged.last().second, range.second);
+        else
+            merged.push_back(range);
+    }
+    return merged;
+}
+
 void TmpEditWin::insertBelowAction_triggered_handler()
 {
-    auto currentRow = ui->editTable->currentRow();
+    auto currentRow = ui->editTable->currentIndex().row();
     qDebug() << "insert row below" << currentRow;
-    if (currentRow < 0) {
-        addRow();
-    } else {
-        insertRowBelow(currentRow);
-    }
+    model->insertRow((currentRow < 0) ? model->rowCount() : (currentRow + 1));
 }
 
 void TmpEditWin::insertAboveAction_triggered_handler()
 {
-    auto currentRow = ui->editTable->currentRow();
+    auto currentRow = ui->editTable->currentIndex().row();
     qDebug() << "insert row at" << currentRow;
-    if (currentRow < 0) {
-        addRow();
-    } else {
-        insertRowAt(currentRow);
-    }
+    model->insertRow((currentRow < 0) ? model->rowCount() : currentRow);
 }
 
 void TmpEditWin::deleteRowAction_triggered_handler()
 {
-    auto currentRow = ui->editTable->currentRow();
-    qDebug() << "delete row at" << currentRow;
-    if (currentRow >= 0) {
-        deleteRowAt(currentRow);
-    }
+    // 从后往前删除，前面区间的行号不变
+    QVector<QPair<int, int>> ranges = selectedRowRanges();
+    for (int i = ranges.size() - 1; i >= 0; i--)
+        model->removeRows(ranges.at(i).first, ranges.at(i).second - ranges.at(i).first + 1);
 }
 
-void TmpEditWin::saveAndExit()
+void TmpEditWin::pasteRowsAction_triggered_handler()
 {
-    DescObj desc;
-    int preDWIdx = 0;
-    DescDWordObj dwObj;
-    for (int row = 0; row < ui->editTable->rowCount(); ++row) {
-        DescFieldObj fieldObj;
-        int curDWIdx = -1;
-        convertRow(row, fieldObj, curDWIdx);
-        if (curDWIdx == preDWIdx) {
-            dwObj.push_back(fieldObj);
-        } else if (curDWIdx == (preDWIdx + 1)) {
-            desc.push_back(dwObj);
-            dwObj.clear();
-            dwObj.push_back(fieldObj);
-        } else {
-            // error
-            QMessageBox::warning(this, tr("Error"), tr("The template format is invalid"));
-            return;
-        }
-        preDWIdx = curDWIdx;
+    // 粘贴到当前行之前，没有当前行时追加到末尾
+    int currentRow = ui->editTable->currentIndex().row();
+    int row = (currentRow < 0) ? model->rowCount() : currentRow;
+    int count = model->pasteRows(row, QApplication::clipboard()->text());
+    if (count == 0) {
+        QMessageBox::warning(this, tr("Error"), tr("No rows to paste, expected \"DW Field LSB MSB\" or \"Field LSB MSB\" per line"));
+        return;
     }
-    if (!dwObj.empty())
-        desc.push_back(dwObj);
-    mDescObj = desc;
-    mChanged = true;
-    close();
+    ui->editTable->selectRow(row);
 }
 
-void TmpEditWin::checkDWCellValid(int row)
+void TmpEditWin::shiftBitsAction_triggered_handler()
 {
-    auto curItem = ui->editTable->item(row, 0);
-    if (nullptr == curItem)
+    QVector<QPair<int, int>> ranges = selectedRowRanges();
+    if (ranges.isEmpty())
         return;
 
-    // 相邻的 DW 必须相等或递增
-    do {
-        bool ok;
-        int curDW = curItem->text().toInt(&ok);
-        if (!ok || (curDW < 0)) {
-            qDebug() << "Invalid DW index" << curItem->text();
-            break;
-        }
-
-        auto preItem = ui->editTable->item(row - 1, 0);
-        if (nullptr != preItem) {
-            int preDW = preItem->text().toInt();
-            if (preDW > curDW) {
-                qDebug() << "Previous DW" << preDW << "> current" << curDW;
-                break;
-            }
-        }
-
-        auto nxtItem = ui->editTable->item(row + 1, 0);
-        if (nullptr != nxtItem) {
-            int nxtDW = nxtItem->text().toInt();
-            if (nxtDW < curDW) {
-                qDebug() << "Next DW" << nxtDW << "< current" << curDW;
-                break;
-            }
-        }
-
-        curItem->setForeground(defaultBrush);
+    bool ok = false;
+    int offset = QInputDialog::getInt(this, tr("Shift Bits"), tr("Bits to add to LSB and MSB:"), 0, -31, 31, 1, &ok);
+    if (!ok || (offset == 0))
         return;
-    } while(0);
-
-    curItem->setForeground(QBrush(Qt::red));
+    for (const QPair<int, int> &range : ranges)
+        model->shiftBits(range.first, range.second, offset);
 }
 
-void TmpEditWin::checkLSBCellValid(int row)
+void TmpEditWin::renumberAction_triggered_handler()
 {
-    auto curItem = ui->editTable->item(row, 2);
-    if (nullptr == curItem)
-        return;
-
-    // LSB 数值大于等于 0，小于等于 31
-    // LSB 数值必须小于等于同行 MSB
-    // LSB 数值非 0，则必须大于前一行 MSB
-    do {
-        bool ok;
-        int curLSB = curItem->text().toInt(&ok);
-        if (!ok || (curLSB < 0) || (curLSB > 31)) {
-            qDebug() << "Invalid LSB" << curItem->text();
-            break;
-        }
-
-        auto nxtMSBTtem = ui->editTable->item(row, 3);
-        if (nullptr != nxtMSBTtem) {
-            int nxtMSB = nxtMSBTtem->text().toInt();
-            if (nxtMSB < curLSB) {
-                qDebug() << "Next MSB" << nxtMSB << "< current LSB" << curLSB;
-                break;
-            }
-        }
-
-        if (0 != curLSB) {
-            auto preMSBItem = ui->editTable->item(row - 1, 3);
-            if (nullptr != preMSBItem) {
-                int preMSB = preMSBItem->text().toInt();
-                if (preMSB >= curLSB) {
-                    qDebug() << "Previous MSB" << preMSB << ">= current LSB" << curLSB;
-                    break;
-                }
-            }
-        }
-
-        curItem->setForeground(defaultBrush);
-        return;
-    } while (0);
-
-    curItem->setForeground(QBrush(Qt::red));
+    model->renumberDws();
 }
 
-void TmpEditWin::checkMSBCellValid(int row)
+void TmpEditWin::saveAndExit()
 {
-    auto curItem = ui->editTable->item(row, 3);
-    if (nullptr == curItem)
+    int errors = model->errorRows();
+    if (errors > 0) {
+        QMessageBox::warning(this, tr("Error"), tr("%1 rows are invalid, see the highlighted cells").arg(errors));
         return;
+    }
 
-    // MSB 数值大于等于 0，小于等于 31
-    // MSB 数值必须大于等于同行 LSB
-    // MSB 数值不是 31，则必须小于后一行 LSB
-    do {
-        bool ok;
-        int curMSB = curItem->text().toInt(&ok);
-        if (!ok || (curMSB < 0) || (curMSB > 31)) {
-            qDebug() << "Invalid MSB" << curItem->text();
-            break;
-        }
-
-        auto preLSBTtem = ui->editTable->item(row, 2);
-        if (nullptr != preLSBTtem) {
-            int preLSB = preLSBTtem->text().toInt();
-            if (preLSB > curMSB) {
-                qDebug() << "Previous LSB" << preLSB << "> current MSB" << curMSB;
-                break;
-            }
-        }
-
-        if (31 != curMSB) {
-            auto nxtLSBItem = ui->editTable->item(row + 1, 3);
-            if (nullptr != nxtLSBItem) {
-                int nxtLSB = nxtLSBItem->text().toInt();
-                if (nxtLSB <= curMSB) {
-                    qDebug() << "Next LSB" << nxtLSB << "<= current MSB" << curMSB;
-                    break;
-                }
-            }
-        }
+    DescObj desc = model->toDesc();
+    // 表格只编辑位字段，派生字段原样保留，子模板引用由模型跟随行的修改
+    desc.setDerivedFields(mDescObj.derivedFields());
 
-        curItem->setForeground(defaultBrush);
+    // 整个模板检查一遍，有错误时不保存，未覆盖的位等警告不影响保存
+    QVector<DescIssue> issues;
+    if (!desc.checkValid(&issues)) {
+        QMessageBox::warning(this, tr("Error"), tr("The template is invalid:\n%1").arg(DescIssue::listText(issues, DescIssue::Error)));
         return;
-    } while (0);
-
-    curItem->setForeground(QBrush(Qt::red));
-}
-
-void TmpEditWin::checkCellValid(int row, int column)
-{
-    qDebug() << "("<< row << "," << column << ") changed";
-    switch (column) {
-    case 0:
-        checkDWCellValid(row);
-        break;
-    case 1:
-        // do nothing
-        break;
-    case 2:
-        checkLSBCellValid(row);
-        break;
-    case 3:
-        checkMSBCellValid(row);
-        break;
-    default:
-        break;
     }
+    mDescObj = desc;
+    mChanged = true;
+    close();
 }
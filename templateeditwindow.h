@@ -2,11 +2,13 @@
 #define TMPEDITWIN_H
 
 #include <QDialog>
-#include <QTableWidget>
+#include <QHeaderView>
 #include <QVBoxLayout>
 #include <QPushButton>
 #include <QMenu>
 #include "descobj.h"
+#include "tableview.h"
+#include "templateeditmodel.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -14,22 +16,20 @@ class UiTmpEditWin
 {
 public:
     QVBoxLayout *rootLayout;
-    QTableWidget *editTable;
+    TableView *editTable;
     QHBoxLayout *btnLaylout;
     QPushButton *addButton;
     QPushButton *okButton;
     QPushButton *cancelButton;
 
-    QMenu *contextMenu;
-
     void setupUi(QWidget *parent)
     {
         rootLayout = new QVBoxLayout(parent);
 
-        editTable = new QTableWidget(parent);
+        editTable = new TableView(parent);
         editTable->setObjectName(QString::fromUtf8("editTable"));
-        editTable->setColumnCount(4);
-        editTable->setHorizontalHeaderLabels({"DW", "Field", "LSB", "MSB"});
+        editTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+        editTable->verticalHeader()->setDefaultSectionSize(20);
         rootLayout->addWidget(editTable);
 
         btnLaylout = new QHBoxLayout();
@@ -44,8 +44,6 @@ public:
         cancelButton = new QPushButton(QObject::tr("Cancel"), parent);
         cancelButton->setFixedSize(75, 23);
         btnLaylout->addWidget(cancelButton);
-
-        contextMenu = new QMenu(parent);
     }
 };
 
@@ -62,17 +60,6 @@ public:
     TmpEditWin(QWidget *parent, DescObj &obj);
     ~TmpEditWin();
 
-    int rowCount();
-
-    void convertRow(int row, DescFieldObj &fieldObj, int &dwIdx);
-    void showTemplate();
-    void saveTemplate();
-
-    void addRow();
-    void insertRowBelow(int row);
-    void insertRowAt(int row);
-    void deleteRowAt(int row);
-
     bool changed() { return mChanged; }
     static DescObj &getEditedDesc(QWidget *parent, DescObj &inputDesc, bool *ok);
 
@@ -80,22 +67,26 @@ private slots:
     void insertBelowAction_triggered_handler();
     void insertAboveAction_triggered_handler();
     void deleteRowAction_triggered_handler();
+    void pasteRowsAction_triggered_handler();
+    void shiftBitsAction_triggered_handler();
+    void renumberAction_triggered_handler();
 
     void saveAndExit();
 
 private:
-    void checkDWCellValid(int row);
-    void checkLSBCellValid(int row);
-    void checkMSBCellValid(int row);
-    void checkCellValid(int row, int column);
+    // 选中的行，合并为升序排列、互不重叠的区间 [first, last]
+    QVector<QPair<int, int>> selectedRowRanges() const;
 
     Ui::TmpEditWin *ui;
     DescObj &mDescObj;
     bool mChanged;
-    QBrush defaultBrush;
+    TemplateEditModel *model;
     QAction *insertBelowAction;
     QAction *insertAboveAction;
     QAction *deleteRowAction;
+    QAction *pasteRowsAction;
+    QAction *shiftBitsAction;
+    QAction *renumberAction;
 };
 
 #endif // TMPEDITWIN_H
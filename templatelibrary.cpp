@@ -0,0 +1,236 @@
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QObject>
+#include "templatelibrary.h"
+
+// 展开后的 DW 数上限，防止错误的 count 占用过多内存
+static const int kMaxDwords = 1 << 16;
+
+TemplateLibrary::TemplateLibrary(const QString &rootPath)
+    : root(rootPath)
+{
+}
+
+bool TemplateLibrary::load(const QString &relativePath, DescObj *desc, QString *error, DescLayout *layout)
+{
+    QStringList stack;
+    Entry entry;
+    if (!loadEntry(relativePath, stack, &entry, error))
+        return false;
+
+    if (!entry.valid) {
+        if (error) {
+            *error = QObject::tr("Not a valid template");
+            if (!entry.issues.isEmpty())
+                *error += "\n" + DescIssue::listText(entry.issues, DescIssue::Error);
+        }
+        return false;
+    }
+    if (desc)
+        *desc = entry.flat;
+    if (layout)
+        *layout = entry.layout;
+    return true;
+}
+
+bool TemplateLibrary::resolve(const DescObj &desc, DescObj *flat, QString *error)
+{
+    if (!desc.hasIncludes()) {
+        *flat = desc;
+        return true;
+    }
+    QStringList stack;
+    Entry entry;
+    if (!resolveInto(desc, stack, &entry, error))
+        return false;
+    for (const DescIssue &issue : entry.issues)
+        qWarning("%s[%d]: %s", __func__, __LINE__, qPrintable(issue.toString()));
+    *flat = entry.flat;
+    return true;
+}
+
+void TemplateLibrary::clearCache()
+{
+    QMutexLocker locker(&mutex);
+    cache.clear();
+}
+
+bool TemplateLibrary::loadEntry(const QString &relativePath, QStringList &stack, Entry *entry, QString *error)
+{
+    QString path = absolutePath(relativePath);
+    if (path.isEmpty()) {
+        if (error)
+            *error = QObject::tr("%1 is outside the template directory").arg(relativePath);
+        return false;
+    }
+    if (stack.contains(path)) {
+        if (error) {
+            QStringList chain;
+            for (const QString &file : stack)
+                chain.push_back(QDir(root).relativeFilePath(file));
+            chain.push_back(QDir(root).relativeFilePath(path));
+            *error = QObject::tr("Circular include: %1").arg(chain.join(" -> "));
+        }
+        return false;
+    }
+
+    {
+        QMutexLocker locker(&mutex);
+        auto it = cache.constFind(path);
+        if ((it != cache.constEnd()) && isCurrent(it.value())) {
+            *entry = it.value();
+            return true;
+        }
+    }
+
+    // 读取和展开不持有锁，多个线程可以同时读取不同的模板
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (error)
+            *error = QObject::tr("Cannot open %1").arg(relativePath);
+        return false;
+    }
+    bool ok = false;
+    DescObj desc = DescObj::fromJson(file.readAll(), &ok);
+    if (!ok) {
+        if (error)
+            *error = QObject::tr("%1 is not valid JSON").arg(relativePath);
+        return false;
+    }
+
+    Entry loaded;
+    loaded.files.push_back(qMakePair(path, QFileInfo(path).lastModified()));
+    stack.push_back(path);
+    bool resolved = resolveInto(desc, stack, &loaded, error);
+    stack.pop_back();
+    if (!resolved)
+        return false;
+
+    // 编译和检查只在读取文件时进行一次，问题（包括展开时丢弃的派生字段）也只记录一次
+    loaded.layout = loaded.flat.compile();
+    loaded.valid = loaded.flat.checkFormat() && loaded.flat.checkValid(&loaded.issues);
+    for (const DescIssue &issue : loaded.issues)
+        qWarning("%s[%d]: %s: %s", __func__, __LINE__, qPrintable(relativePath), qPrintable(issue.toString()));
+
+    {
+        QMutexLocker locker(&mutex);
+        cache.insert(path, loaded);
+    }
+    *entry = loaded;
+    return true;
+}
+
+bool TemplateLibrary::resolveInto(const DescObj &desc, QStringList &stack, Entry *entry, QString *error)
+{
+    DescObj &flat = entry->flat;
+    QJsonArray derived;
+    auto expand = [&](const DescInclude &include) -> bool {
+        if (include.count < 1) {
+            if (error)
+                *error = QObject::tr("Invalid count %1 for %2").arg(include.count).arg(include.path);
+            return false;
+        }
+        Entry sub;
+        if (!loadEntry(include.path, stack, &sub, error))
+            return false;
+        if (flat.size() + qint64(sub.flat.size()) * include.count > kMaxDwords) {
+            if (error)
+                *error = QObject::tr("%1 x %2 is too large").arg(include.path).arg(include.count);
+            return false;
+        }
+        entry->files += sub.files;
+
+        // 没有前缀的单个引用保持原字段名，子模板的派生字段也一起带入；
+        // 加了前缀后派生字段的表达式不再对应，不带入，记为警告
+        bool keepNames = include.name.isEmpty() && (include.count == 1);
+        if (keepNames) {
+            flat.append(sub.flat);
+            for (const QJsonValue &value : sub.flat.derivedFields())
+                derived.push_back(value);
+            return true;
+        }
+
+        QString name = include.name.isEmpty() ? QFileInfo(include.path).baseName() : include.name;
+        if (!sub.flat.derivedFields().isEmpty()) {
+            entry->issues.push_back({DescIssue::Warning, -1, name,
+                                     QObject::tr("%1 derived fields of %2 dropped, they cannot be renamed with a prefix")
+                                         .arg(sub.flat.derivedFields().size()).arg(include.path)});
+        }
+        for (int k = 0; k < include.count; k++) {
+            QString prefix = (include.count == 1) ? (name + '_') : QString("%1%2_").arg(name).arg(k);
+            for (const DescDWordObj &dword : sub.flat) {
+                DescDWordObj renamed;
+                for (const DescFieldObj &fieldObj : dword) {
+                    DescFieldObj field(fieldObj);
+                    if (!field.isEmpty())
+                        field["field"] = prefix + fieldObj["field"].toString();
+                    renamed.push_back(field);
+                }
+                flat.push_back(renamed);
+            }
+        }
+        return true;
+    };
+
+    const QVector<DescInclude> &includes = desc.includes();
+    int next = 0;
+    for (int i = 0; i < desc.size(); i++) {
+        while ((next < includes.size()) && (includes.at(next).dwIdx <= i)) {
+            if (!expand(includes.at(next++)))
+                return false;
+        }
+        flat.push_back(desc.at(i));
+    }
+    while (next < includes.size()) {
+        if (!expand(includes.at(next++)))
+            return false;
+    }
+
+    for (const QJsonValue &value : desc.derivedFields())
+        derived.push_back(value);
+    flat.setDerivedFields(derived);
+    if (!includes.isEmpty())
+        qDebug("%s[%d]: %d includes expanded to %d DWs", __func__, __LINE__, includes.size(), flat.size());
+    return true;
+}
+
+bool TemplateLibrary::isCurrent(const Entry &entry) const
+{
+    for (const QPair<QString, QDateTime> &file : entry.files) {
+        QFileInfo info(file.first);
+        if (!info.exists() || (info.lastModified() != file.second))
+            return false;
+    }
+    return true;
+}
+
+bool TemplateLibrary::contains(const QString &relativePath) const
+{
+    return !absolutePath(relativePath).isEmpty();
+}
+
+QString TemplateLibrary::absolutePath(const QString &relativePath) const
+{
+    // 模板 ID 可能来自数据流，不接受绝对路径
+    if (relativePath.isEmpty() || QDir::isAbsolutePath(relativePath))
+        return QString();
+
+    // 与模板管理窗口一致，可以省略 .json
+    QString path = QDir::cleanPath(QDir(root).absoluteFilePath(relativePath));
+    if (!path.endsWith(".json") && !QFileInfo::exists(path))
+        path += ".json";
+
+    // 去掉 .. 和符号链接后必须仍在模板目录内
+    QString canonical = QFileInfo(path).canonicalFilePath();
+    QString rootPath = canonical.isEmpty() ? QDir::cleanPath(QDir(root).absolutePath()) : QDir(root).canonicalPath();
+    if (canonical.isEmpty())
+        canonical = path;
+    if (rootPath.isEmpty() || !canonical.startsWith(rootPath + '/')) {
+        qWarning("%s[%d]: %s is outside the template directory", __func__, __LINE__, qPrintable(relativePath));
+        return QString();
+    }
+    return path;
+}
@@ -0,0 +1,50 @@
+#ifndef TEMPLATELIBRARY_H
+#define TEMPLATELIBRARY_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "descobj.h"
+
+// 模板库：按模板目录下的相对路径读取模板，并把引用的子模板（见 DescInclude）展开为普通模板
+// 展开后的模板连同编译结果和检查结果按路径缓存，记录展开时用到的所有文件的修改时间，任何一个变化后重新读取，
+// 所以多个模板引用同一子结构时只读取、展开一次，重复加载同一模板时不再编译和检查。可以在多个线程中同时使用。
+class TemplateLibrary
+{
+public:
+    explicit TemplateLibrary(const QString &rootPath);
+
+    // 读取并展开模板，检查格式和有效性，layout 不为空时同时返回编译结果
+    bool load(const QString &relativePath, DescObj *desc, QString *error = nullptr, DescLayout *layout = nullptr);
+    // 展开 desc 中的引用，没有引用时原样复制
+    bool resolve(const DescObj &desc, DescObj *flat, QString *error = nullptr);
+    void clearCache();
+    // 相对路径是否位于模板目录内，不检查文件是否存在
+    bool contains(const QString &relativePath) const;
+
+private:
+    // 展开结果、编译和检查结果，以及用到的文件及其修改时间
+    struct Entry
+    {
+        DescObj flat;
+        DescLayout layout;
+        bool valid = false;
+        QVector<DescIssue> issues;
+        QVector<QPair<QString, QDateTime>> files;
+    };
+
+    bool loadEntry(const QString &relativePath, QStringList &stack, Entry *entry, QString *error);
+    bool resolveInto(const DescObj &desc, QStringList &stack, Entry *entry, QString *error);
+    bool isCurrent(const Entry &entry) const;
+    QString absolutePath(const QString &relativePath) const;
+
+    QString root;
+    QMutex mutex;
+    QHash<QString, Entry> cache;
+};
+
+#endif // TEMPLATELIBRARY_H
@@ -1,10 +1,45 @@
 #include "templatemanagewindow.h"
+#include <atomic>
 #include <QCoreApplication>
+#include <QDirIterator>
+#include <QFileDialog>
 #include <QInputDialog>
 #include <QMessageBox>
+#include <QtConcurrent>
 #include <QDebug>
+#include "backgroundtask.h"
+#include "ipxactimporter.h"
 #include "templateeditwindow.h"
 
+// 批量检查中一个模板文件的结果
+struct TemplateCheckResult
+{
+    QString path;
+    bool parsed;
+    QString error;
+    QVector<DescIssue> issues;
+};
+
+static TemplateCheckResult checkTemplateFile(TemplateLibrary *library, const QString &path)
+{
+    TemplateCheckResult result;
+    result.path = path;
+    result.parsed = false;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return result;
+    DescObj rootObj = DescObj::fromJson(file.readAll(), &result.parsed);
+    // 引用的子模板展开后再检查，子模板的问题也会显示在引用它的模板中
+    if (result.parsed && !library->resolve(rootObj, &rootObj, &result.error))
+        result.parsed = false;
+    if (result.parsed && !rootObj.checkFormat())
+        result.parsed = false;
+    if (result.parsed)
+        rootObj.checkValid(&result.issues);
+    return result;
+}
+
 TmpMgmtWin::TmpMgmtWin(QWidget *parent, QString rootPath)
     : QDockWidget(parent)
     , ui(new Ui::TmpMgmtWin)
@@ -19,6 +54,7 @@ TmpMgmtWin::TmpMgmtWin(QWidget *parent, QString rootPath)
     // 规范化模板目录名
     tempPath = QDir::cleanPath(rootPath + "/descriptortemplates");
     qDebug() << "模板目录： " << tempPath;
+    library = new TemplateLibrary(tempPath);
 
     // 检查子目录是否存在
     QDir dir(tempPath);
@@ -51,6 +87,8 @@ TmpMgmtWin::TmpMgmtWin(QWidget *parent, QString rootPath)
     deleteFolderAction = new QAction(tr("Delete Group"), this);
     deleteTemplateAction = new QAction(tr("Delete Template"), this);
     editAction = new QAction(tr("Edit"), this);
+    importIpxactAction = new QAction(tr("Import IP-XACT..."), this);
+    checkTemplatesAction = new QAction(tr("Check Templates"), this);
 
     // 连接动作到槽函数
     connect(addNewFolderAction, &QAction::triggered, this, &TmpMgmtWin::addNewFolderAction_triggered_handler);
@@ -58,6 +96,8 @@ TmpMgmtWin::TmpMgmtWin(QWidget *parent, QString rootPath)
     connect(deleteFolderAction, &QAction::triggered, this, &TmpMgmtWin::deleteFolderAction_triggered_handler);
     connect(deleteTemplateAction, &QAction::triggered, this, &TmpMgmtWin::deleteTemplateAction_triggered_handler);
     connect(editAction, &QAction::triggered, this, &TmpMgmtWin::editAction_triggered_handler);
+    connect(importIpxactAction, &QAction::triggered, this, &TmpMgmtWin::importIpxactAction_triggered_handler);
+    connect(checkTemplatesAction, &QAction::triggered, this, &TmpMgmtWin::checkTemplatesAction_triggered_handler);
 
     // 将动作添加到右键菜单
     ui->contextMenu->addAction(addNewFolderAction);
@@ -65,6 +105,8 @@ TmpMgmtWin::TmpMgmtWin(QWidget *parent, QString rootPath)
     ui->contextMenu->addAction(deleteFolderAction);
     ui->contextMenu->addAction(editAction);
     ui->contextMenu->addAction(deleteTemplateAction);
+    ui->contextMenu->addAction(importIpxactAction);
+    ui->contextMenu->addAction(checkTemplatesAction);
 
     // 连接模板管理视图的自定义右键菜单请求信号到槽函数
     ui->tempDirView->setContextMenuPolicy(Qt::CustomContextMenu);
@@ -76,9 +118,25 @@ TmpMgmtWin::TmpMgmtWin(QWidget *parent, QString rootPath)
 
 TmpMgmtWin::~TmpMgmtWin()
 {
+    delete library;
     delete ui;
 }
 
+bool TmpMgmtWin::loadTemplate(const QString &relativePath, DescObj *desc, DescLayout *layout) const
+{
+    // 模板 ID 可能来自数据流，拒绝模板目录以外的路径
+    if (!library->contains(relativePath)) {
+        qWarning("%s[%d]: %s: outside the template directory", __func__, __LINE__, qPrintable(relativePath));
+        return false;
+    }
+    QString error;
+    if (!library->load(relativePath, desc, &error, layout)) {
+        qWarning("%s[%d]: %s: %s", __func__, __LINE__, qPrintable(relativePath), qPrintable(error));
+        return false;
+    }
+    return true;
+}
+
 void TmpMgmtWin::editTemplate(QString &filePath)
 {
     QFile file(filePath);
@@ -104,6 +162,8 @@ void TmpMgmtWin::editTemplate(QString &filePath)
         }
         file.write(rootObj.toBtyeArray());
         file.close();
+        // 修改时间的精度可能不足以区分连续的保存
+        library->clearCache();
     }
 }
 
@@ -119,12 +179,16 @@ void TmpMgmtWin::tempDirView_customContextMenuRequested_handler(const QPoint &po
         deleteFolderAction->setVisible(false);
         editAction->setVisible(true);
         deleteTemplateAction->setVisible(true);
+        importIpxactAction->setVisible(false);
+        checkTemplatesAction->setVisible(false);
     } else {
         addNewFolderAction->setVisible(true);
         addNewTemplateAction->setVisible(true);
         deleteFolderAction->setVisible(true);
         deleteTemplateAction->setVisible(false);
         editAction->setVisible(false);
+        importIpxactAction->setVisible(true);
+        checkTemplatesAction->setVisible(true);
     }
 
     // 选中条目
@@ -140,18 +204,13 @@ void TmpMgmtWin::tempDirView_tempSelected_handler(const QModelIndex &index)
         return;
     }
 
+    // 引用的子模板在这里展开，其它窗口只使用展开后的模板
     QString filePath = mModel->fileInfo(index).absoluteFilePath();
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning("Couldn't open the file.");
-        return;
-    }
-    QByteArray fileData = file.readAll();
-    bool ok = false;
-    DescObj rootObj = DescObj::fromJson(fileData, &ok);
-
-    if (!ok || !rootObj.checkFormat()) {
-        qWarning("%s[%d]: Not a valid template", __func__, __LINE__);
+    DescObj rootObj;
+    QString error;
+    if (!library->load(QDir(tempPath).relativeFilePath(filePath), &rootObj, &error)) {
+        qWarning("%s[%d]: %s", __func__, __LINE__, qPrintable(error));
+        QMessageBox::warning(this, tr("Error"), tr("Cannot load the template: %1").arg(error));
         // 确保发送空的描述符模板
         rootObj.clear();
     }
@@ -297,6 +356,111 @@ void TmpMgmtWin::editAction_triggered_handler()
     editTemplate(filePath);
 }
 
+void TmpMgmtWin::importIpxactAction_triggered_handler()
+{
+    QModelIndex currentIndex = ui->tempDirView->currentIndex();
+    QString dirPath = mModel->fileInfo(currentIndex).absoluteFilePath();
+    if (!QDir(dirPath).exists())
+        return;
+
+    QString xmlPath = QFileDialog::getOpenFileName(this, tr("Import IP-XACT"), QString(),
+                                                   tr("IP-XACT files (*.xml);;All files (*)"));
+    if (xmlPath.isEmpty())
+        return;
+    qDebug() << "Import" << xmlPath << "to" << dirPath;
+
+    // 导入在工作线程中进行，寄存器很多时需要较长时间
+    IpxactImporter importer;
+    bool ok = false;
+    QString error;
+    BackgroundTask::run(this, tr("Importing %1...").arg(QFileInfo(xmlPath).fileName()),
+        [&]() { ok = importer.import(xmlPath, tempPath, dirPath, &error); },
+        [&]() { return static_cast<int>(importer.readBytes() * 1000 / qMax<qint64>(1, importer.totalBytes())); },
+        [&]() { importer.cancel(); });
+
+    if (!ok) {
+        if (!importer.isCancelled())
+            QMessageBox::warning(this, tr("Error"), tr("Cannot import %1: %2").arg(xmlPath, error));
+        return;
+    }
+    QString message = tr("Imported %1 registers from %2 address blocks.").arg(importer.registerCount()).arg(importer.blockCount());
+    if (importer.skippedFields() > 0)
+        message += "\n" + tr("%1 fields without a fixed bit range were skipped.").arg(importer.skippedFields());
+    if (importer.renamedBlocks() > 0)
+        message += "\n" + tr("%1 address blocks with duplicate names were renamed by base address.").arg(importer.renamedBlocks());
+    QMessageBox::information(this, tr("Import IP-XACT"), message);
+}
+
+void TmpMgmtWin::checkTemplatesAction_triggered_handler()
+{
+    QModelIndex currentIndex = ui->tempDirView->currentIndex();
+    QString dirPath = mModel->fileInfo(currentIndex).absoluteFilePath();
+    QDir dir(dirPath);
+    if (!dir.exists())
+        return;
+
+    QStringList files;
+    QDirIterator it(dirPath, QStringList() << "*.json", QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+        files.push_back(it.next());
+    if (files.isEmpty()) {
+        QMessageBox::warning(this, tr("Error"), tr("No templates in %1").arg(dirPath));
+        return;
+    }
+
+    // 各模板文件在线程池中并行检查
+    QVector<TemplateCheckResult> results(files.size());
+    for (int i = 0; i < files.size(); i++)
+        results[i].path = files.at(i);
+    std::atomic<int> checked(0);
+    std::atomic<bool> cancelled(false);
+    bool finished = BackgroundTask::run(this, tr("Checking %1 templates...").arg(files.size()),
+        [&]() {
+            QtConcurrent::blockingMap(results, [&](TemplateCheckResult &result) {
+                if (cancelled)
+                    return;
+                result = checkTemplateFile(library, result.path);
+                checked++;
+            });
+        },
+        [&]() { return checked * 1000 / files.size(); },
+        [&]() { cancelled = true; });
+    if (!finished)
+        return;
+
+    int errorFiles = 0;
+    int warningFiles = 0;
+    QStringList details;
+    for (const TemplateCheckResult &result : results) {
+        QString name = dir.relativeFilePath(result.path);
+        if (!result.parsed) {
+            errorFiles++;
+            details.push_back(name + ": " + (result.error.isEmpty() ? tr("Not a valid template") : result.error));
+            continue;
+        }
+        if (result.issues.isEmpty())
+            continue;
+        bool hasError = false;
+        for (const DescIssue &issue : result.issues) {
+            hasError |= (issue.level == DescIssue::Error);
+            details.push_back(name + ": " + issue.toString());
+        }
+        if (hasError)
+            errorFiles++;
+        else
+            warningFiles++;
+    }
+    qDebug("%s[%d]: %d templates, %d with errors, %d with warnings", __func__, __LINE__,
+           files.size(), errorFiles, warningFiles);
+
+    QMessageBox box((errorFiles > 0) ? QMessageBox::Warning : QMessageBox::Information, tr("Check Templates"),
+                    tr("Checked %1 templates: %2 with errors, %3 with warnings only.")
+                    .arg(files.size()).arg(errorFiles).arg(warningFiles), QMessageBox::Ok, this);
+    if (!details.isEmpty())
+        box.setDetailedText(details.join('\n'));
+    box.exec();
+}
+
 QModelIndex TmpMgmtWin::getIndexUnderMouse(const QPoint &pos)
 {
     QModelIndex index = ui->tempDirView->indexAt(pos);
@@ -9,6 +9,7 @@
 #include <QTreeView>
 #include <QMenu>
 #include "descobj.h"
+#include "templatelibrary.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -60,6 +61,9 @@ public:
     TmpMgmtWin(QWidget *parent = nullptr, QString rootPath = "");
     ~TmpMgmtWin();
 
+    // 按模板目录下的相对路径加载模板，desc 和 layout 为空时不返回对应的结果
+    bool loadTemplate(const QString &relativePath, DescObj *desc, DescLayout *layout = nullptr) const;
+
 signals:
     void tempSelected(const DescObj &rootObj);
 
@@ -67,12 +71,16 @@ private:
     void editTemplate(QString &filePath);
 
     QString             tempPath;
+    // 读取模板时展开引用的子模板
+    TemplateLibrary     *library;
     QFileSystemModel    *mModel;
     QAction             *addNewFolderAction;
     QAction             *addNewTemplateAction;
     QAction             *editAction;
     QAction             *deleteFolderAction;
     QAction             *deleteTemplateAction;
+    QAction             *importIpxactAction;
+    QAction             *checkTemplatesAction;
 
     Ui::TmpMgmtWin *ui;
 
@@ -84,6 +92,8 @@ private slots:
     void deleteFolderAction_triggered_handler();
     void deleteTemplateAction_triggered_handler();
     void editAction_triggered_handler();
+    void importIpxactAction_triggered_handler();
+    void checkTemplatesAction_triggered_handler();
 
 private:
     QModelIndex getIndexUnderMouse(const QPoint &pos);
@@ -182,6 +182,24 @@ QStringList DataInputEdit::stripLines(bool *ok)
     return processedLines;
 }
 
+bool DataInputEdit::parseDword(const QString &line, uint32_t *value) const
+{
+    QRegularExpressionMatchIterator matchIterator = hexDwordRegex.globalMatch(line);
+    QStringRef lastMatch;
+    while (matchIterator.hasNext()) {
+        lastMatch = matchIterator.next().capturedRef(0);
+    }
+
+    if (lastMatch.isEmpty())
+        return false;
+
+    bool ok = false;
+    uint32_t dword = lastMatch.toUInt(&ok, 16);
+    if (ok && value)
+        *value = dword;
+    return ok;
+}
+
 bool DataInputEdit::reverseLines()
 {
     QString inputText = this->toPlainText();
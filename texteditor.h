@@ -53,6 +53,8 @@ public:
     DataInputEdit(QWidget *parent = nullptr);
 
     QStringList stripLines(bool *ok);
+    // 提取单行中最后一个十六进制 DWORD
+    bool parseDword(const QString &line, uint32_t *value) const;
 
     bool reverseLines();
 
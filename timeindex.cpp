@@ -0,0 +1,208 @@
+#include <algorithm>
+#include "timeindex.h"
+
+const qint64 TimeIndex::kNoTime;
+
+TimeIndex::TimeIndex()
+{
+    clear();
+}
+
+void TimeIndex::clear()
+{
+    times.clear();
+    head = 0;
+    baseGroup = 0;
+    dwPerGroup = 0;
+    pendingDwords = 0;
+    pendingTime = kNoTime;
+    lastTime = kNoTime;
+    monotonic = true;
+    active = false;
+    sorted.clear();
+    sortedValid = false;
+}
+
+void TimeIndex::start(qint64 startDword, int dwPerGroup)
+{
+    clear();
+    if (dwPerGroup <= 0)
+        return;
+    this->dwPerGroup = dwPerGroup;
+    baseGroup = startDword / dwPerGroup;
+    pendingDwords = static_cast<int>(startDword % dwPerGroup);
+    active = true;
+}
+
+void TimeIndex::append(const TimeMarks &marks, int count)
+{
+    if (!active)
+        return;
+
+    // 按组推进，每组只查看落在组内的标记
+    int m = 0;
+    int pos = 0;
+    while (pos < count) {
+        int take = qMin(count - pos, dwPerGroup - pendingDwords);
+        for (; (m < marks.size()) && (marks.at(m).dword < pos + take); m++) {
+            if ((pendingTime == kNoTime) && (marks.at(m).dword >= pos))
+                pendingTime = marks.at(m).time;
+        }
+        pos += take;
+        pendingDwords += take;
+        if (pendingDwords < dwPerGroup)
+            break;
+
+        qint64 t = (pendingTime != kNoTime) ? pendingTime : lastTime;
+        if (t < lastTime)
+            monotonic = false;
+        times.push_back(t);
+        lastTime = t;
+        pendingDwords = 0;
+        pendingTime = kNoTime;
+    }
+    sortedValid = false;
+}
+
+void TimeIndex::restore(qint64 firstGroup, int dwPerGroup, const QVector<qint64> &groupTimes)
+{
+    clear();
+    if (dwPerGroup <= 0)
+        return;
+    this->dwPerGroup = dwPerGroup;
+    baseGroup = firstGroup;
+    times = groupTimes;
+    for (qint64 t : times) {
+        if (t < lastTime)
+            monotonic = false;
+        lastTime = t;
+    }
+    active = true;
+}
+
+void TimeIndex::dropBefore(qint64 group)
+{
+    qint64 drop = qMin(group - baseGroup, endGroup() - baseGroup);
+    if (drop <= 0)
+        return;
+
+    head += static_cast<int>(drop);
+    baseGroup += drop;
+    // 丢弃的部分超过一半时再整体前移
+    if (head >= times.size() / 2) {
+        times.remove(0, head);
+        head = 0;
+    }
+    sortedValid = false;
+}
+
+qint64 TimeIndex::groupTime(qint64 group) const
+{
+    if ((group < baseGroup) || (group >= endGroup()))
+        return kNoTime;
+    return times.at(head + static_cast<int>(group - baseGroup));
+}
+
+const QVector<QPair<qint64, qint64>> &TimeIndex::sortedIndex() const
+{
+    if (!sortedValid) {
+        sorted.clear();
+        sorted.reserve(times.size() - head);
+        for (int i = head; i < times.size(); i++) {
+            if (times.at(i) != kNoTime)
+                sorted.push_back(qMakePair(times.at(i), baseGroup + i - head));
+        }
+        std::sort(sorted.begin(), sorted.end());
+        sortedValid = true;
+    }
+    return sorted;
+}
+
+qint64 TimeIndex::findGroup(qint64 t) const
+{
+    if (monotonic) {
+        auto it = std::lower_bound(times.constBegin() + head, times.constEnd(), t);
+        return (it == times.constEnd()) ? -1 : baseGroup + (it - (times.constBegin() + head));
+    }
+
+    // 乱序时返回时间最接近且不早于 t 的组
+    const QVector<QPair<qint64, qint64>> &index = sortedIndex();
+    auto it = std::lower_bound(index.constBegin(), index.constEnd(), qMakePair(t, LLONG_MIN));
+    return (it == index.constEnd()) ? -1 : it->second;
+}
+
+QPair<qint64, qint64> TimeIndex::groupSpan(qint64 begin, qint64 end) const
+{
+    if (monotonic) {
+        auto first = times.constBegin() + head;
+        auto lo = std::lower_bound(first, times.constEnd(), begin);
+        auto hi = std::upper_bound(lo, times.constEnd(), end);
+        return qMakePair(baseGroup + (lo - first), baseGroup + (hi - first));
+    }
+
+    const QVector<QPair<qint64, qint64>> &index = sortedIndex();
+    auto lo = std::lower_bound(index.constBegin(), index.constEnd(), qMakePair(begin, LLONG_MIN));
+    auto hi = std::upper_bound(lo, index.constEnd(), qMakePair(end, LLONG_MAX));
+    if (lo == hi)
+        return qMakePair(0LL, 0LL);
+    qint64 minGroup = LLONG_MAX;
+    qint64 maxGroup = LLONG_MIN;
+    for (auto it = lo; it != hi; ++it) {
+        minGroup = qMin(minGroup, it->second);
+        maxGroup = qMax(maxGroup, it->second);
+    }
+    return qMakePair(minGroup, maxGroup + 1);
+}
+
+bool TimeIndex::parseSeconds(const char *begin, const char *end, qint64 *ns, const char **stop)
+{
+    const char *p = begin;
+    qint64 seconds = 0;
+    int digits = 0;
+    while ((p < end) && (*p >= '0') && (*p <= '9') && (digits < 10)) {
+        seconds = seconds * 10 + (*p - '0');
+        digits++;
+        p++;
+    }
+    if (digits == 0)
+        return false;
+
+    // 小数部分补齐到 9 位，多余的位忽略
+    qint64 fraction = 0;
+    int fractionDigits = 0;
+    if ((p < end) && (*p == '.')) {
+        p++;
+        while ((p < end) && (*p >= '0') && (*p <= '9')) {
+            if (fractionDigits < 9) {
+                fraction = fraction * 10 + (*p - '0');
+                fractionDigits++;
+            }
+            p++;
+        }
+    }
+    for (; fractionDigits < 9; fractionDigits++)
+        fraction *= 10;
+
+    if (ns)
+        *ns = seconds * 1000000000LL + fraction;
+    if (stop)
+        *stop = p;
+    return true;
+}
+
+void TimeIndex::addMark(TimeMarks &marks, qint64 dword, qint64 time, int dwPerGroup, int phase)
+{
+    if (time == kNoTime)
+        return;
+    if ((dwPerGroup > 0) && !marks.isEmpty()
+            && ((marks.last().dword + phase) / dwPerGroup == (dword + phase) / dwPerGroup))
+        return;
+    marks.push_back({dword, time});
+}
+
+QString TimeIndex::formatTime(qint64 ns)
+{
+    if (ns == kNoTime)
+        return QString();
+    return QString::asprintf("%lld.%06lld", ns / 1000000000LL, (ns % 1000000000LL) / 1000);
+}
@@ -0,0 +1,75 @@
+#ifndef TIMEINDEX_H
+#define TIMEINDEX_H
+
+#include <climits>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+// 时间戳标记：一段数据中第 dword 个 DWORD 所在行的时间戳（纳秒）
+// 只记录带时间戳的行，按 dword 递增排列；按组记录时每组最多一个，即组内第一个带时间戳的 DWORD
+struct TimeMark
+{
+    qint64 dword;
+    qint64 time;
+};
+typedef QVector<TimeMark> TimeMarks;
+
+// 组时间戳索引
+// 每组记录组内第一个带时间戳的行的时间（纳秒），组内没有时间戳时沿用前一组的时间。
+// 时间戳通常单调递增，此时直接在时间数组上二分查找；出现乱序时另外生成按时间排序的
+// (时间, 组号) 索引，数据变化后重新生成。组号与 ResultStore 的绝对组号一致。
+class TimeIndex
+{
+public:
+    static const qint64 kNoTime = LLONG_MIN;
+
+    TimeIndex();
+
+    void clear();
+    // 从绝对位置 startDword 开始记录时间戳，之前的组没有时间
+    void start(qint64 startDword, int dwPerGroup);
+    bool isActive() const { return active; }
+    // 追加 count 个 DWORD，marks 为其中带时间戳的位置，为空时都视为没有时间戳
+    void append(const TimeMarks &marks, int count);
+    // 从文件恢复：绝对组号 firstGroup 开始各组的时间
+    void restore(qint64 firstGroup, int dwPerGroup, const QVector<qint64> &groupTimes);
+    // 丢弃 group 之前的组
+    void dropBefore(qint64 group);
+
+    qint64 firstGroup() const { return baseGroup; }
+    qint64 endGroup() const { return baseGroup + times.size() - head; }
+    qint64 groupTime(qint64 group) const;
+    bool isMonotonic() const { return monotonic; }
+
+    // 按时间顺序第一个时间不早于 t 的组，找不到返回 -1
+    qint64 findGroup(qint64 t) const;
+    // 时间在 [begin, end] 内的所有组所在的最小组区间 [first, second)，没有时返回空区间
+    QPair<qint64, qint64> groupSpan(qint64 begin, qint64 end) const;
+
+    // 秒.小数 格式，小数最多取 9 位；stop 返回解析结束的位置
+    static bool parseSeconds(const char *begin, const char *end, qint64 *ns, const char **stop = nullptr);
+    // 按组追加标记：time 有效且 dword 所在组还没有标记时追加
+    // 每组 dwPerGroup 个 DWORD，0 表示不分组；这段数据的第 0 个 DWORD 位于组内第 phase 个
+    static void addMark(TimeMarks &marks, qint64 dword, qint64 time, int dwPerGroup, int phase = 0);
+    static QString formatTime(qint64 ns);
+
+private:
+    const QVector<QPair<qint64, qint64>> &sortedIndex() const;
+
+    // times[head] 对应绝对组号 baseGroup
+    QVector<qint64> times;
+    int head;
+    qint64 baseGroup;
+    int dwPerGroup;
+    // 当前不完整的组已收到的 DWORD 个数和第一个时间戳
+    int pendingDwords;
+    qint64 pendingTime;
+    qint64 lastTime;
+    bool monotonic;
+    bool active;
+    mutable QVector<QPair<qint64, qint64>> sorted;
+    mutable bool sortedValid;
+};
+
+#endif // TIMEINDEX_H
@@ -0,0 +1,27 @@
+QT       = core concurrent
+
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TARGET = descgen
+
+equals(QT_MAJOR_VERSION, 5): lessThan(QT_MINOR_VERSION, 14): QMAKE_CXXFLAGS += -Wno-deprecated-copy
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../descobj.cpp \
+    ../../fieldexpr.cpp \
+    ../../fieldformatter.cpp \
+    ../../ipxactimporter.cpp \
+    ../../templatelibrary.cpp \
+    descgenerator.cpp \
+    main.cpp
+
+HEADERS += \
+    ../../descobj.h \
+    ../../fieldexpr.h \
+    ../../fieldformatter.h \
+    ../../ipxactimporter.h \
+    ../../templatelibrary.h \
+    descgenerator.h
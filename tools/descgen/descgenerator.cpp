@@ -0,0 +1,165 @@
+#include <QtConcurrent>
+#include <QtEndian>
+#include "descgenerator.h"
+
+// 每个并行任务生成的组数
+static const int kTaskGroups = 16 * 1024;
+
+static bool parseNumber(const QString &text, quint64 *value)
+{
+    bool ok;
+    *value = text.startsWith("0x", Qt::CaseInsensitive) ? text.mid(2).toULongLong(&ok, 16) : text.toULongLong(&ok, 10);
+    return ok;
+}
+
+bool FieldDistribution::parse(const QString &text, FieldDistribution *dist)
+{
+    QStringList parts = text.split(':');
+    QString kind = parts.takeFirst().toLower();
+    FieldDistribution d;
+
+    if ((kind == "random") && parts.isEmpty()) {
+        d.kind = Random;
+    } else if ((kind == "const") && (parts.size() == 1)) {
+        d.kind = Constant;
+        if (!parseNumber(parts.at(0), &d.a))
+            return false;
+    } else if ((kind == "range") && (parts.size() == 2)) {
+        d.kind = Range;
+        if (!parseNumber(parts.at(0), &d.a) || !parseNumber(parts.at(1), &d.b) || (d.a > d.b))
+            return false;
+    } else if ((kind == "seq") && ((parts.size() == 1) || (parts.size() == 2))) {
+        d.kind = Sequence;
+        d.b = 1;
+        if (!parseNumber(parts.at(0), &d.a) || ((parts.size() == 2) && !parseNumber(parts.at(1), &d.b)))
+            return false;
+    } else {
+        return false;
+    }
+
+    *dist = d;
+    return true;
+}
+
+// splitmix64 终结函数
+static inline quint64 mix64(quint64 x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+DescGenerator::DescGenerator(const DescLayout &layout)
+    : mLayout(layout)
+    , dists(layout.fieldCount())
+    , mSeed(0)
+    , mFormat(Text)
+{
+    for (const DescFieldSpec &spec : mLayout.fields)
+        widthMasks.push_back(DescObj::subfieldMask(spec.lsb, spec.msb) >> spec.lsb);
+}
+
+bool DescGenerator::setDistribution(const QString &fieldName, const FieldDistribution &dist)
+{
+    bool found = false;
+    for (int i = 0; i < mLayout.fields.size(); i++) {
+        // 派生字段由其它字段计算，不能单独指定分布
+        if ((mLayout.fields.at(i).name == fieldName) && !mLayout.fields.at(i).isDerived()) {
+            dists[i] = dist;
+            found = true;
+        }
+    }
+    return found;
+}
+
+uint32_t DescGenerator::fieldValue(qint64 group, int field) const
+{
+    const FieldDistribution &dist = dists.at(field);
+    quint64 mask = widthMasks.at(field);
+
+    switch (dist.kind) {
+    case FieldDistribution::Constant:
+        return static_cast<uint32_t>(dist.a & mask);
+    case FieldDistribution::Sequence:
+        return static_cast<uint32_t>((dist.a + static_cast<quint64>(group) * dist.b) & mask);
+    default:
+        break;
+    }
+
+    quint64 r = mix64(mSeed + 0x9e3779b97f4a7c15ULL * (static_cast<quint64>(group) * mLayout.fieldCount() + field + 1));
+    if (dist.kind == FieldDistribution::Range) {
+        quint64 span = dist.b - dist.a + 1;
+        // span 为 0 表示整个 64 位范围
+        return static_cast<uint32_t>(((span == 0) ? r : (dist.a + r % span)) & mask);
+    }
+    return static_cast<uint32_t>(r & mask);
+}
+
+void DescGenerator::generate(qint64 first, int count, QByteArray &out) const
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    QVector<uint32_t> dwords(mLayout.dwCount);
+
+    int lineBytes = (mFormat == Text) ? 11 : 4;
+    int pos = out.size();
+    out.resize(pos + count * mLayout.dwCount * lineBytes);
+    char *dst = out.data() + pos;
+
+    for (qint64 g = first; g < first + count; g++) {
+        dwords.fill(0);
+        for (int f = 0; f < mLayout.rawFieldCount(); f++) {
+            const DescFieldSpec &spec = mLayout.fields.at(f);
+            dwords[spec.dwIdx] = DescObj::insertSubfield(dwords.at(spec.dwIdx), spec.lsb, spec.msb, fieldValue(g, f));
+        }
+
+        for (uint32_t dw : dwords) {
+            if (mFormat == Binary) {
+                qToLittleEndian<quint32>(dw, dst);
+                dst += 4;
+                continue;
+            }
+            // 与 DataInputEdit 接受的格式一致：0x%08x
+            *dst++ = '0';
+            *dst++ = 'x';
+            for (int shift = 28; shift >= 0; shift -= 4)
+                *dst++ = hexDigits[(dw >> shift) & 0xf];
+            *dst++ = '\n';
+        }
+    }
+}
+
+bool DescGenerator::write(QIODevice *device, qint64 groups) const
+{
+    struct Task
+    {
+        qint64 first;
+        int count;
+        QByteArray data;
+    };
+
+    // 每轮并行生成若干块，再按顺序写出，内存占用与总组数无关
+    int batch = qMax(1, QThreadPool::globalInstance()->maxThreadCount()) * 4;
+    for (qint64 g = 0; g < groups;) {
+        QVector<Task> tasks;
+        for (int i = 0; (i < batch) && (g < groups); i++) {
+            int count = static_cast<int>(qMin<qint64>(kTaskGroups, groups - g));
+            tasks.push_back({g, count, QByteArray()});
+            g += count;
+        }
+
+        QtConcurrent::blockingMap(tasks, [this](Task &task) {
+            generate(task.first, task.count, task.data);
+        });
+
+        for (const Task &task : tasks) {
+            if (device->write(task.data) != task.data.size()) {
+                qWarning("%s[%d]: %s", __func__, __LINE__, qPrintable(device->errorString()));
+                return false;
+            }
+        }
+    }
+    return true;
+}
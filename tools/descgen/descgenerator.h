@@ -0,0 +1,57 @@
+#ifndef DESCGENERATOR_H
+#define DESCGENERATOR_H
+
+#include <QIODevice>
+#include <QString>
+#include <QVector>
+#include "descobj.h"
+
+// 单个字段的取值分布
+struct FieldDistribution
+{
+    enum Kind {
+        Constant,   // 固定为 a
+        Range,      // [a, b] 内均匀分布
+        Random,     // 字段位宽内均匀分布
+        Sequence,   // 第 n 组为 a + n * b，超出位宽后回绕
+    };
+
+    Kind kind = Random;
+    quint64 a = 0;
+    quint64 b = 0;
+
+    // 格式：const:V | range:LO:HI | random | seq:START[:STEP]，数值可为十进制或 0x 十六进制
+    static bool parse(const QString &text, FieldDistribution *dist);
+};
+
+// 按模板生成描述符数据
+// 每个字段值由 (种子, 组号, 字段序号) 经计数器式哈希得到，与线程数和分块方式无关，
+// 同一种子总是生成相同的输出。
+class DescGenerator
+{
+public:
+    enum Format { Text, Binary };
+
+    explicit DescGenerator(const DescLayout &layout);
+
+    // 未设置分布的字段为 Random
+    bool setDistribution(const QString &fieldName, const FieldDistribution &dist);
+    void setSeed(quint64 seed) { mSeed = seed; }
+    void setFormat(Format format) { mFormat = format; }
+
+    // 生成第 [first, first + count) 组，追加到 out
+    void generate(qint64 first, int count, QByteArray &out) const;
+    // 多线程生成 groups 组并按顺序写入 device，出错返回 false
+    bool write(QIODevice *device, qint64 groups) const;
+
+private:
+    uint32_t fieldValue(qint64 group, int field) const;
+
+    DescLayout mLayout;
+    QVector<FieldDistribution> dists;
+    QVector<uint32_t> widthMasks;
+    quint64 mSeed;
+    Format mFormat;
+};
+
+#endif // DESCGENERATOR_H
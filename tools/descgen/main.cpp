@@ -0,0 +1,132 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QThreadPool>
+#include <climits>
+#include <cstdio>
+#include "descgenerator.h"
+#include "ipxactimporter.h"
+#include "templatelibrary.h"
+
+// 按模板生成测试用描述符数据，例如：
+//   descgen -t ring.json -n 10000000 -s 42 -d "valid=const:1" -d "addr=seq:0x1000:0x40" -o ring.log
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("descgen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generate descriptor dumps that match a SuperPaser template.");
+    parser.addHelpOption();
+    QCommandLineOption templateOption({"t", "template"}, "Template JSON file.", "file");
+    QCommandLineOption rootOption({"r", "root"},
+                                  "Template directory that include paths are relative to, "
+                                  "defaults to the directory of the template.",
+                                  "dir");
+    QCommandLineOption groupsOption({"n", "groups"}, "Number of groups to generate.", "count", "1000");
+    QCommandLineOption seedOption({"s", "seed"}, "Random seed.", "seed", "0");
+    QCommandLineOption formatOption({"f", "format"}, "Output format: text or bin.", "format", "text");
+    QCommandLineOption outputOption({"o", "output"}, "Output file.", "file");
+    QCommandLineOption fieldOption({"d", "field"},
+                                   "Field distribution NAME=const:V|range:LO:HI|random|seq:START[:STEP].",
+                                   "spec");
+    QCommandLineOption threadsOption({"j", "threads"}, "Worker threads.", "count");
+    parser.addOptions({templateOption, rootOption, groupsOption, seedOption, formatOption, outputOption, fieldOption, threadsOption});
+    parser.process(app);
+
+    if (!parser.isSet(templateOption) || !parser.isSet(outputOption)) {
+        fprintf(stderr, "Both --template and --output are required\n");
+        return 1;
+    }
+
+    QFile tempFile(parser.value(templateOption));
+    if (!tempFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        fprintf(stderr, "Cannot open %s\n", qPrintable(tempFile.fileName()));
+        return 1;
+    }
+    bool ok = false;
+    DescObj parsed = DescObj::fromJson(tempFile.readAll(), &ok);
+    if (!ok) {
+        fprintf(stderr, "Not valid JSON: %s\n", qPrintable(tempFile.fileName()));
+        return 1;
+    }
+
+    // 与界面一致，通过模板库展开引用的子模板
+    QString root = parser.isSet(rootOption) ? parser.value(rootOption) : QFileInfo(tempFile.fileName()).absolutePath();
+    TemplateLibrary library(root);
+    DescObj desc;
+    QString error;
+    if (!library.resolve(parsed, &desc, &error)) {
+        fprintf(stderr, "Cannot resolve includes of %s: %s\n", qPrintable(tempFile.fileName()), qPrintable(error));
+        return 1;
+    }
+    // 有 Error 的模板生成的数据没有意义，直接拒绝
+    DescLayout layout = desc.compileValid(&error);
+    if (layout.isEmpty()) {
+        fprintf(stderr, "%s: %s\n", qPrintable(tempFile.fileName()), qPrintable(error));
+        return 1;
+    }
+
+    DescGenerator generator(layout);
+    for (const QString &spec : parser.values(fieldOption)) {
+        FieldDistribution dist;
+        QString name = spec.section('=', 0, 0);
+        if (!FieldDistribution::parse(spec.section('=', 1), &dist)) {
+            fprintf(stderr, "Invalid distribution: %s\n", qPrintable(spec));
+            return 1;
+        }
+        if (!generator.setDistribution(name, dist)) {
+            fprintf(stderr, "No field named %s in template\n", qPrintable(name));
+            return 1;
+        }
+    }
+
+    // 数字参数都可以写成 0x 开头的十六进制
+    quint64 value;
+    if (!IpxactImporter::parseNumber(parser.value(groupsOption), &value) || (value > quint64(LLONG_MAX))) {
+        fprintf(stderr, "Invalid group count\n");
+        return 1;
+    }
+    qint64 groups = static_cast<qint64>(value);
+    quint64 seed;
+    if (!IpxactImporter::parseNumber(parser.value(seedOption), &seed)) {
+        fprintf(stderr, "Invalid seed\n");
+        return 1;
+    }
+    int threads = 0;
+    if (parser.isSet(threadsOption)) {
+        if (!IpxactImporter::parseNumber(parser.value(threadsOption), &value) || (value < 1) || (value > 1024)) {
+            fprintf(stderr, "Invalid thread count\n");
+            return 1;
+        }
+        threads = static_cast<int>(value);
+    }
+    QString format = parser.value(formatOption);
+    if ((format != "text") && (format != "bin")) {
+        fprintf(stderr, "Unknown format: %s\n", qPrintable(format));
+        return 1;
+    }
+    generator.setFormat((format == "bin") ? DescGenerator::Binary : DescGenerator::Text);
+    generator.setSeed(seed);
+    if (threads > 0)
+        QThreadPool::globalInstance()->setMaxThreadCount(threads);
+
+    QFile out(parser.value(outputOption));
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        fprintf(stderr, "Cannot write %s: %s\n", qPrintable(out.fileName()), qPrintable(out.errorString()));
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    if (!generator.write(&out, groups))
+        return 1;
+    out.close();
+
+    double seconds = qMax<qint64>(1, timer.elapsed()) / 1000.0;
+    fprintf(stderr, "%lld groups, %lld bytes in %.2f s (%.1f MB/s)\n", groups, out.size(), seconds,
+            out.size() / seconds / (1024 * 1024));
+    return 0;
+}
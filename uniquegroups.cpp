@@ -0,0 +1,78 @@
+#include <QHash>
+#include <QtConcurrent>
+#include "capturediff.h"
+#include "uniquegroups.h"
+
+// 每个并行任务处理的组数
+static const int kTaskGroups = 256 * 1024;
+
+// 在已有的描述符中查找与 group 内容相同的一个，哈希相同时再比较原始 DWORD，找不到返回 -1
+static int findSame(const ResultStore &store, const QMultiHash<quint64, int> &slots, const QVector<UniqueGroup> &groups,
+                    quint64 hash, qint64 group, uint32_t *bufA, uint32_t *bufB)
+{
+    for (auto it = slots.constFind(hash); (it != slots.constEnd()) && (it.key() == hash); ++it) {
+        if (CaptureDiff::sameGroup(store, group, store, groups.at(it.value()).first, bufA, bufB))
+            return it.value();
+    }
+    return -1;
+}
+
+QVector<UniqueGroup> UniqueGroups::collect(const ResultStore &store)
+{
+    struct Shard
+    {
+        int begin;
+        int end;
+        QMultiHash<quint64, int> slots;
+        QVector<UniqueGroup> groups;
+    };
+
+    if (store.groupCount() > kMaxGroups) {
+        qWarning("%s[%d]: Too many groups: %lld", __func__, __LINE__, store.groupCount());
+        return QVector<UniqueGroup>();
+    }
+
+    qint64 first = store.firstGroup();
+    const QVector<quint64> hashes = CaptureDiff::hashGroups(store);
+
+    QVector<Shard> shards;
+    for (int g = 0; g < hashes.size(); g += kTaskGroups)
+        shards.push_back({g, qMin(g + kTaskGroups, hashes.size()), QMultiHash<quint64, int>(), QVector<UniqueGroup>()});
+
+    QtConcurrent::blockingMap(shards, [&store, &hashes, first](Shard &shard) {
+        QVector<uint32_t> bufA(store.dwordsPerGroup());
+        QVector<uint32_t> bufB(store.dwordsPerGroup());
+        for (int g = shard.begin; g < shard.end; g++) {
+            quint64 hash = hashes.at(g);
+            int slot = findSame(store, shard.slots, shard.groups, hash, first + g, bufA.data(), bufB.data());
+            if (slot < 0) {
+                shard.slots.insert(hash, shard.groups.size());
+                shard.groups.push_back({hash, first + g, first + g, 1});
+            } else {
+                UniqueGroup &unique = shard.groups[slot];
+                unique.last = first + g;
+                unique.count++;
+            }
+        }
+    });
+
+    // 段按顺序合并，后面的段只会更新 last
+    QMultiHash<quint64, int> slots;
+    QVector<UniqueGroup> result;
+    QVector<uint32_t> bufA(store.dwordsPerGroup());
+    QVector<uint32_t> bufB(store.dwordsPerGroup());
+    for (const Shard &shard : shards) {
+        for (const UniqueGroup &unique : shard.groups) {
+            int slot = findSame(store, slots, result, unique.hash, unique.first, bufA.data(), bufB.data());
+            if (slot < 0) {
+                slots.insert(unique.hash, result.size());
+                result.push_back(unique);
+            } else {
+                UniqueGroup &merged = result[slot];
+                merged.last = unique.last;
+                merged.count += unique.count;
+            }
+        }
+    }
+    return result;
+}
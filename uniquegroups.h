@@ -0,0 +1,31 @@
+#ifndef UNIQUEGROUPS_H
+#define UNIQUEGROUPS_H
+
+#include <climits>
+#include <QVector>
+#include "resultstore.h"
+
+// 一种不同的描述符及其出现情况，组号为绝对组号
+struct UniqueGroup
+{
+    quint64 hash;
+    qint64 first;
+    qint64 last;
+    qint64 count;
+};
+
+// 按原始 DWORD 合并相同的组
+// 各组先计算哈希，再分段在各线程的局部哈希表中计数，最后按段的顺序合并，
+// 哈希相同时再比较原始 DWORD，哈希冲突的组不会被合并，
+// 结果按首次出现的顺序排列。
+class UniqueGroups
+{
+public:
+    // 结果最多与组数相同，组数需保证结果在 QVector 的 2 GB 限制内
+    static const qint64 kMaxGroups = (INT_MAX - 64) / sizeof(UniqueGroup);
+
+    // 组数超过 kMaxGroups 时返回空
+    static QVector<UniqueGroup> collect(const ResultStore &store);
+};
+
+#endif // UNIQUEGROUPS_H
@@ -0,0 +1,131 @@
+#include <climits>
+#include <QBrush>
+#include <QDebug>
+#include "backgroundtask.h"
+#include "uniquegroupswindow.h"
+
+UniqueGroupsModel::UniqueGroupsModel(const ResultStore *store, QObject *parent)
+    : QAbstractTableModel(parent)
+    , store(store)
+{
+}
+
+void UniqueGroupsModel::setGroups(const DescLayout &layout, const QVector<UniqueGroup> &groups)
+{
+    beginResetModel();
+    // 只展示位字段，派生字段在结果表中查看
+    mLayout = layout;
+    mLayout.fields.resize(layout.rawFieldCount());
+    mGroups = groups;
+    endResetModel();
+}
+
+qint64 UniqueGroupsModel::firstGroupOfRow(int row) const
+{
+    if ((row < 0) || (row >= rowCount()))
+        return -1;
+    return mGroups.at(row / mLayout.fieldCount()).first;
+}
+
+int UniqueGroupsModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return static_cast<int>(qMin<qint64>(qint64(mGroups.size()) * mLayout.fieldCount(), INT_MAX));
+}
+
+int UniqueGroupsModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 4;
+}
+
+QVariant UniqueGroupsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (index.row() >= rowCount()))
+        return QVariant();
+
+    int unique = index.row() / mLayout.fieldCount();
+    int field = index.row() % mLayout.fieldCount();
+    const UniqueGroup &group = mGroups.at(unique);
+    const DescFieldSpec &spec = mLayout.fields.at(field);
+
+    if (role == Qt::DisplayRole) {
+        uint32_t value = DescObj::extractSubfield(store->dword(store->groupDwordIndex(group.first) + spec.dwIdx),
+                                                  spec.lsb, spec.msb);
+        switch (index.column()) {
+        case 0:
+            return spec.name;
+        case 1:
+            return value;
+        case 2:
+            return QString::asprintf("0x%x", value);
+        case 3:
+            if (group.count == 1)
+                return QString::asprintf("Group %lld", group.first);
+            return QString::asprintf("x%lld  Group %lld - %lld", group.count, group.first, group.last);
+        default:
+            break;
+        }
+    } else if ((role == Qt::TextAlignmentRole) && ((index.column() == 1) || (index.column() == 2))) {
+        return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+    } else if ((role == Qt::BackgroundRole) && (index.column() == 3)) {
+        // 按描述符交替显示颜色
+        return QBrush((unique % 2 == 0) ? Qt::white : Qt::lightGray);
+    }
+    return QVariant();
+}
+
+QVariant UniqueGroupsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if ((orientation != Qt::Horizontal) || (role != Qt::DisplayRole))
+        return QVariant();
+    switch (section) {
+    case 0:
+        return tr("Field");
+    case 1:
+        return tr("Value");
+    case 2:
+        return tr("Hex");
+    case 3:
+        return tr("Occurrences");
+    default:
+        return QVariant();
+    }
+}
+
+UniqueGroupsWin::UniqueGroupsWin(QWidget *parent, const ResultStore *store, const DescLayout &layout)
+    : QDialog(parent)
+    , ui(new Ui::UniqueGroupsWin)
+    , store(store)
+    , mLayout(layout)
+    , mSelectedGroup(-1)
+{
+    ui->setupUi(this);
+    model = new UniqueGroupsModel(store, this);
+    ui->uniqueTable->setModel(model);
+    connect(ui->uniqueTable, &TableView::doubleClicked, this, &UniqueGroupsWin::uniqueTable_doubleClicked_handler);
+}
+
+UniqueGroupsWin::~UniqueGroupsWin()
+{
+    delete ui;
+}
+
+void UniqueGroupsWin::collect()
+{
+    QVector<UniqueGroup> groups;
+    BackgroundTask::run(parentWidget(), tr("Collecting unique groups..."),
+        [&]() { groups = UniqueGroups::collect(*store); }, nullptr, nullptr, 0);
+
+    qDebug("%s[%d]: %lld groups, %d unique", __func__, __LINE__, store->groupCount(), groups.size());
+    ui->summaryLabel->setText(tr("Groups: %1    Unique: %2").arg(store->groupCount()).arg(groups.size()));
+    model->setGroups(mLayout, groups);
+    ui->uniqueTable->resizeColumnsToContents();
+}
+
+void UniqueGroupsWin::uniqueTable_doubleClicked_handler(const QModelIndex &index)
+{
+    mSelectedGroup = model->firstGroupOfRow(index.row());
+    if (mSelectedGroup >= 0)
+        accept();
+}
@@ -0,0 +1,92 @@
+#ifndef UNIQUEGROUPSWINDOW_H
+#define UNIQUEGROUPSWINDOW_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <QAbstractTableModel>
+#include "descobj.h"
+#include "uniquegroups.h"
+#include "tableview.h"
+
+QT_BEGIN_NAMESPACE
+
+class UiUniqueGroupsWin
+{
+public:
+    QVBoxLayout *contentLayout;
+    QLabel *summaryLabel;
+    TableView *uniqueTable;
+
+    void setupUi(QDialog *dialog)
+    {
+        dialog->setWindowTitle(QObject::tr("Unique Groups"));
+        dialog->resize(800, 600);
+
+        contentLayout = new QVBoxLayout(dialog);
+
+        summaryLabel = new QLabel(dialog);
+        summaryLabel->setObjectName(QString::fromUtf8("summaryLabel"));
+        contentLayout->addWidget(summaryLabel);
+
+        uniqueTable = new TableView(dialog);
+        uniqueTable->setObjectName(QString::fromUtf8("uniqueTable"));
+        uniqueTable->verticalHeader()->setVisible(false);
+        // 设置内容不可编辑
+        uniqueTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        contentLayout->addWidget(uniqueTable);
+    }
+};
+
+namespace Ui {
+    class UniqueGroupsWin: public UiUniqueGroupsWin {};
+} // namespace Ui
+
+QT_END_NAMESPACE
+
+// 不同描述符的表格，每种描述符按模板字段展开，字段值按需从数据存储中读取
+class UniqueGroupsModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    UniqueGroupsModel(const ResultStore *store, QObject *parent = nullptr);
+
+    void setGroups(const DescLayout &layout, const QVector<UniqueGroup> &groups);
+    // 行号对应的描述符首次出现的绝对组号
+    qint64 firstGroupOfRow(int row) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    const ResultStore *store;
+    DescLayout mLayout;
+    QVector<UniqueGroup> mGroups;
+};
+
+// 合并重复描述符的窗口，双击某行后关闭窗口并跳转到该描述符首次出现的组
+class UniqueGroupsWin : public QDialog
+{
+    Q_OBJECT
+public:
+    UniqueGroupsWin(QWidget *parent, const ResultStore *store, const DescLayout &layout);
+    ~UniqueGroupsWin();
+
+    void collect();
+    qint64 selectedGroup() const { return mSelectedGroup; }
+
+private slots:
+    void uniqueTable_doubleClicked_handler(const QModelIndex &index);
+
+private:
+    Ui::UniqueGroupsWin *ui;
+    const ResultStore *store;
+    DescLayout mLayout;
+    UniqueGroupsModel *model;
+    qint64 mSelectedGroup;
+};
+
+#endif // UNIQUEGROUPSWINDOW_H